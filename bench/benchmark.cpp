@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Benchmarks of \p libchecksum
+ *
+ * Measures the throughput of all algorithms of \p libchecksum for different
+ * buffer sizes. The benchmarks also serve as training workload for
+ * profile-guided optimization (see the CMake option \p PGO).
+ */
+
+#include <libchecksum/checksums.h>
+#include <libchecksum/copy.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+using namespace libchecksum;
+
+namespace {
+
+/// A benchmarked algorithm
+struct Benchmark {
+  std::string Name;
+  std::function<uint64_t(const uint8_t*, std::size_t)> Run;
+};
+
+/// \brief Reduces a checksum to a value the benchmark can accumulate.
+template<typename T>
+uint64_t toSink(T value) {
+  return value;
+}
+
+template<std::size_t N>
+uint64_t toSink(const Digest<N>& digest) {
+  return digest.Bytes[0];
+}
+
+/// \brief Creates a benchmark calling an algorithm through its virtual
+/// interface.
+template<typename Algorithm>
+Benchmark makeBenchmark(const std::string& name) {
+  return {name, [](const uint8_t* data, std::size_t length) -> uint64_t {
+    static const Algorithm algorithm {};
+    const ChecksumAlgorithm<typename Algorithm::State::ResultType>& base = algorithm;
+    return toSink(base(data, length));
+  }};
+}
+
+/// \brief Creates a benchmark hashing the input as a batch of 8 equally long
+/// buffers.
+template<typename Algorithm>
+Benchmark makeBatchBenchmark(const std::string& name) {
+  return {name, [](const uint8_t* data, std::size_t length) -> uint64_t {
+    static const Algorithm algorithm {};
+    constexpr std::size_t count {8};
+    const uint8_t* inputs[count];
+    std::size_t lengths[count];
+    typename Algorithm::State::ResultType results[count];
+    for (std::size_t i = 0; i < count; ++i) {
+      inputs[i] = data + i * (length / count);
+      lengths[i] = length / count;
+    }
+    algorithm.computeBatch(inputs, lengths, count, results);
+    return toSink(results[count - 1]);
+  }};
+}
+
+/// \brief Returns a destination buffer for the copy benchmarks.
+uint8_t* copyDestination(std::size_t length) {
+  static std::vector<uint8_t> destination;
+  if (destination.size() < length) {
+    destination.resize(length);
+  }
+  return destination.data();
+}
+
+/// \brief Creates a benchmark copying the input and calculating its checksum
+/// in a single pass.
+template<typename Algorithm>
+Benchmark makeFusedCopyBenchmark(const std::string& name) {
+  return {name, [](const uint8_t* data, std::size_t length) -> uint64_t {
+    return copyWithChecksum<Algorithm>(copyDestination(length), data, length);
+  }};
+}
+
+/// \brief Creates a benchmark copying the input with memcpy and calculating
+/// its checksum afterwards, as a baseline for the fused copy.
+template<typename Algorithm>
+Benchmark makeCopyBenchmark(const std::string& name) {
+  return {name, [](const uint8_t* data, std::size_t length) -> uint64_t {
+    uint8_t* destination {copyDestination(length)};
+    std::memcpy(destination, data, length);
+    return Algorithm::compute(destination, length);
+  }};
+}
+
+/// \brief Measures the throughput of a benchmark.
+/// \param benchmark Benchmark to run
+/// \param data Input buffer
+/// \param length Length of the input buffer
+/// \param seconds Minimum duration of the measurement
+/// \return Throughput in MiB per second
+double measure(const Benchmark& benchmark, const uint8_t* data, std::size_t length,
+               double seconds) {
+  using Clock = std::chrono::steady_clock;
+  uint64_t sink {0};
+  std::size_t iterations {0};
+  std::size_t batch {1};
+  const auto start = Clock::now();
+  std::chrono::duration<double> elapsed {};
+  do {
+    for (std::size_t i = 0; i < batch; ++i) {
+      sink += benchmark.Run(data, length);
+    }
+    iterations += batch;
+    batch *= 2;
+    elapsed = Clock::now() - start;
+  } while (elapsed.count() < seconds);
+
+  // keep the compiler from dropping the calls
+  volatile uint64_t result {sink};
+  static_cast<void>(result);
+  return static_cast<double>(length) * static_cast<double>(iterations)
+         / elapsed.count() / (1024.0 * 1024.0);
+}
+
+void printUsage() {
+  std::printf(
+    "Usage: checksum_bench [OPTION]...\n"
+    "Measure the throughput of all algorithms of libchecksum.\n"
+    "\n"
+    "  --seconds S   minimum duration of each measurement (default: 0.5)\n"
+    "  --size N      buffer size in bytes, may be repeated\n"
+    "                (default: 64, 1500, 65536 and 16777216)\n"
+    "  --filter NAME only run algorithms whose name contains NAME\n");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  double seconds {0.5};
+  std::vector<std::size_t> sizes;
+  std::string filter;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument {argv[i]};
+    if (argument == "--help" || argument == "-h") {
+      printUsage();
+      return EXIT_SUCCESS;
+    }
+    if (i + 1 == argc) {
+      printUsage();
+      return EXIT_FAILURE;
+    }
+    if (argument == "--seconds") {
+      seconds = std::strtod(argv[++i], nullptr);
+    } else if (argument == "--size") {
+      sizes.push_back(std::strtoull(argv[++i], nullptr, 10));
+    } else if (argument == "--filter") {
+      filter = argv[++i];
+    } else {
+      printUsage();
+      return EXIT_FAILURE;
+    }
+  }
+  if (sizes.empty()) {
+    sizes = {64, 1500, 1 << 16, 1 << 24};
+  }
+
+  const std::vector<Benchmark> benchmarks {
+    makeBenchmark<Adler32>("Adler32"),
+    makeBenchmark<Fletcher16>("Fletcher16"),
+    makeBenchmark<Fletcher32>("Fletcher32"),
+    makeBenchmark<Sum8>("Sum8"),
+    makeBenchmark<Sum16>("Sum16"),
+    makeBenchmark<Sum32>("Sum32"),
+    {"Sum32 parallel", [](const uint8_t* data, std::size_t length) -> uint64_t {
+      static const Sum32 algorithm {0};
+      return toSink(algorithm(data, length));
+    }},
+    makeBenchmark<BSDSum>("BSDSum"),
+    makeBenchmark<XOR8>("XOR8"),
+    makeBenchmark<SYSV>("SYSV"),
+    makeBenchmark<Cksum>("Cksum"),
+    makeBenchmark<CRC32>("CRC32"),
+    makeBenchmark<CRC32C>("CRC32C"),
+    makeBenchmark<CRC32BZIP2>("CRC32BZIP2"),
+    makeBenchmark<InternetChecksum>("Internet"),
+    makeBenchmark<XXH3>("XXH3"),
+    makeBenchmark<XXH128>("XXH128"),
+    makeBenchmark<SHA256>("SHA256"),
+    makeBatchBenchmark<SHA256>("SHA256 batch"),
+    makeBenchmark<BLAKE3>("BLAKE3"),
+    {"BLAKE3 1 thread", [](const uint8_t* data, std::size_t length) -> uint64_t {
+      static const BLAKE3 algorithm {1};
+      return toSink(algorithm(data, length));
+    }},
+    makeCopyBenchmark<CRC32>("memcpy+CRC32"),
+    makeFusedCopyBenchmark<CRC32>("fused+CRC32"),
+    makeCopyBenchmark<Adler32>("memcpy+Adler"),
+    makeFusedCopyBenchmark<Adler32>("fused+Adler"),
+  };
+
+  std::size_t maxSize {0};
+  for (const auto size : sizes) {
+    maxSize = std::max(maxSize, size);
+  }
+  std::vector<uint8_t> data(maxSize);
+  uint32_t value {42};
+  for (auto& byte : data) {
+    value = value * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(value >> 16);
+  }
+
+  std::printf("%-12s %12s %14s\n", "algorithm", "bytes", "MiB/s");
+  for (const auto& benchmark : benchmarks) {
+    if (benchmark.Name.find(filter) == std::string::npos) {
+      continue;
+    }
+    for (const auto size : sizes) {
+      std::printf("%-12s %12zu %14.1f\n", benchmark.Name.c_str(), size,
+                  measure(benchmark, data.data(), size, seconds));
+      std::fflush(stdout);
+    }
+  }
+  return EXIT_SUCCESS;
+}
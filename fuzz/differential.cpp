@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Differential fuzzer of the kernels of \p libchecksum
+ *
+ * Runs every algorithm on the fuzz input with every subset of the CPU
+ * features that selects a different kernel, in one call, as stream with
+ * random chunk lengths, on several threads and in batches, and aborts if any
+ * result differs from the portable kernel of the header kernels.h.
+ *
+ * The first bytes of the input choose the alignment of the data, the chunk
+ * lengths, the number of threads and whether the data is stretched beyond
+ * the length at which the algorithms spread it over threads. Built with
+ * Clang, the fuzzer is driven by libFuzzer; otherwise the standalone driver
+ * at the end of this file runs the inputs given as files or directories and
+ * a number of random inputs:
+ * \code
+ * checksum_fuzz -runs=10000 -seed=42 corpus/
+ * \endcode
+ */
+
+#include <libchecksum/registry.h>
+
+#include "cpu.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef LIBCHECKSUM_FUZZ_STANDALONE
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+
+#include <dirent.h>
+#endif
+
+using namespace libchecksum;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size);
+
+namespace {
+
+/// Number of bytes at the beginning of the input choosing the parameters
+constexpr std::size_t ParameterLength {4};
+/// Length beyond which every parallel algorithm splits its input
+constexpr std::size_t ParallelLength {2 << 20};
+/// Number of buffers of a batch, one more than the lanes of the widest kernel
+constexpr std::size_t BatchCount {9};
+
+/// Parameters of a run, taken from the beginning of the input
+struct Parameters {
+  /// Offset of the data from a 64-byte boundary
+  std::size_t Alignment;
+  /// Maximum length of a chunk fed to a stream or of a buffer of a batch
+  std::size_t MaxChunk;
+  /// Number of threads of the parallel algorithms
+  unsigned Threads;
+  /// Whether the data is stretched to more than ParallelLength bytes
+  bool Large;
+  /// Seed of the chunk lengths
+  uint32_t Seed;
+};
+
+/// Pseudo-random chunk lengths (xorshift32)
+class ChunkLengths {
+
+public:
+  ChunkLengths(uint32_t seed, std::size_t maxChunk)
+      : State {seed | 1}, MaxChunk {maxChunk} {}
+
+  std::size_t next() {
+    State ^= State << 13;
+    State ^= State >> 17;
+    State ^= State << 5;
+    return 1 + State % MaxChunk;
+  }
+
+private:
+  uint32_t State;
+  std::size_t MaxChunk;
+};
+
+/// \brief Returns the subsets of the detected CPU features that select
+/// different kernels.
+///
+/// The subsets are built from the features detected at startup, so features
+/// reported as missing by \p LIBCHECKSUM_DISABLE_CPU_FEATURES stay disabled.
+/// \return Distinct subsets of the features, beginning with all of them
+const std::vector<detail::CpuFeatures>& featureSets() {
+  static const std::vector<detail::CpuFeatures> sets {[] {
+    const detail::CpuFeatures all {detail::cpuFeatures()};
+    std::vector<detail::CpuFeatures> candidates(6, all);
+    candidates[1].AVX512BW = false;
+    candidates[2].AVX512 = candidates[2].AVX512BW = false;
+    candidates[3].SHA = false;
+    candidates[4] = {all.AVX2, false, false, false};
+    candidates[5] = {};
+    std::vector<detail::CpuFeatures> distinct;
+    for (const auto& candidate : candidates) {
+      if (std::none_of(distinct.begin(), distinct.end(), [&](const detail::CpuFeatures& set) {
+            return set.AVX2 == candidate.AVX2 && set.AVX512 == candidate.AVX512
+                && set.AVX512BW == candidate.AVX512BW && set.SHA == candidate.SHA;
+          })) {
+        distinct.push_back(candidate);
+      }
+    }
+    return distinct;
+  }()};
+  return sets;
+}
+
+/// Compares all modes of an algorithm on one input with its portable kernel
+class DifferentialCheck {
+
+public:
+  DifferentialCheck(const AlgorithmInfo& info, const Parameters& parameters,
+                    const uint8_t* data, std::size_t length)
+      : Info {info}, Params {parameters}, Data {data}, Length {length} {}
+
+  template<typename Algorithm>
+  void operator()(const Algorithm& algorithm) const {
+    const auto expected = Algorithm::compute(Data, Length);
+    const Algorithm parallel {detail::ThreadFactory {Params.Threads}(
+        detail::AlgorithmType<Algorithm> {})};
+
+    for (const auto& features : featureSets()) {
+      detail::DetectedFeatures = features;
+      if (algorithm(Data, Length) != expected) {
+        fail("one-shot", features);
+      }
+      if (Info.Parallel && parallel(Data, Length) != expected) {
+        fail("parallel", features);
+      }
+      if (Params.Large) {
+        // streams and batches of the stretched data take too long per input
+        continue;
+      }
+      checkStream(algorithm, expected, features);
+      checkBatch(algorithm, features);
+    }
+  }
+
+private:
+  const AlgorithmInfo& Info;
+  const Parameters& Params;
+  const uint8_t* Data;
+  std::size_t Length;
+
+  template<typename Algorithm, typename T>
+  void checkStream(const Algorithm& algorithm, const T& expected,
+                   const detail::CpuFeatures& features) const {
+    auto stream = algorithm.createStream();
+    ChunkLengths chunks {Params.Seed, Params.MaxChunk};
+    for (std::size_t offset {0}; offset < Length;) {
+      const std::size_t chunk {std::min(chunks.next(), Length - offset)};
+      stream->update(Data + offset, chunk);
+      offset += chunk;
+    }
+    if (stream->finalize() != expected) {
+      fail("stream", features);
+    }
+  }
+
+  template<typename Algorithm>
+  void checkBatch(const Algorithm& algorithm, const detail::CpuFeatures& features) const {
+    const uint8_t* buffers[BatchCount];
+    std::size_t lengths[BatchCount];
+    ChunkLengths chunks {~Params.Seed, Params.MaxChunk};
+    std::size_t offset {0};
+    for (std::size_t i = 0; i < BatchCount; ++i) {
+      buffers[i] = Data + offset;
+      lengths[i] = std::min(chunks.next() - 1, Length - offset);
+      offset += lengths[i];
+    }
+    decltype(Algorithm::compute(Data, Length)) results[BatchCount];
+    algorithm.computeBatch(buffers, lengths, BatchCount, results);
+    for (std::size_t i = 0; i < BatchCount; ++i) {
+      if (results[i] != Algorithm::compute(buffers[i], lengths[i])) {
+        fail("batch", features);
+      }
+    }
+  }
+
+  [[noreturn]] void fail(const char* mode, const detail::CpuFeatures& features) const {
+    std::fprintf(stderr, "%s differs from the portable kernel: mode %s, features%s%s%s%s%s, "
+                 "length %zu, alignment %zu, threads %u, chunks up to %zu bytes\n",
+                 Info.Name, mode, features.AVX2 ? " avx2" : "",
+                 features.AVX512 ? " avx512" : "", features.AVX512BW ? " avx512bw" : "",
+                 features.SHA ? " sha" : "",
+                 features.AVX2 || features.AVX512 || features.SHA ? "" : " none",
+                 Length, Params.Alignment, Params.Threads, Params.MaxChunk);
+    std::abort();
+  }
+};
+
+/// \brief Reads the parameters of a run from the beginning of the input.
+/// \param data Input of the fuzzer, at least ParameterLength bytes long
+/// \return Parameters of the run
+Parameters readParameters(const uint8_t* data) {
+  Parameters parameters {};
+  parameters.Alignment = std::size_t {data[0]} % 64;
+  parameters.Large = (data[1] & 0x3fu) == 0;
+  parameters.MaxChunk = (std::size_t {data[1]} + 1) * (parameters.Large ? 4096 : 1);
+  parameters.Threads = 2 + unsigned {data[2]} % 3;
+  parameters.Seed = uint32_t {data[2]} | (uint32_t {data[3]} << 8);
+  return parameters;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, std::size_t size) {
+  if (size < ParameterLength) {
+    return 0;
+  }
+  const Parameters parameters {readParameters(data)};
+  const uint8_t* payload {data + ParameterLength};
+  std::size_t length {size - ParameterLength};
+
+  // copy the data behind the chosen offset from a 64-byte boundary; stretched
+  // data repeats the payload, changed in every repetition
+  if (parameters.Large) {
+    length += ParallelLength;
+  }
+  std::vector<uint8_t> buffer(length + 64 + parameters.Alignment);
+  uint8_t* aligned {buffer.data() + (64 - reinterpret_cast<uintptr_t>(buffer.data()) % 64)
+                    + parameters.Alignment};
+  for (std::size_t offset {0}, round {0}; offset < length; ++round) {
+    const std::size_t chunk {std::min(size - ParameterLength, length - offset)};
+    if (chunk == 0) {
+      std::fill(aligned, aligned + length, uint8_t {0xa5});
+      break;
+    }
+    for (std::size_t i = 0; i < chunk; ++i) {
+      aligned[offset + i] = static_cast<uint8_t>(payload[i] ^ round);
+    }
+    offset += chunk;
+  }
+
+  const detail::CpuFeatures detected {detail::cpuFeatures()};
+  for (const auto& info : registry::getAlgorithms()) {
+    registry::visit(info.Id, DifferentialCheck {info, parameters, aligned, length});
+  }
+  detail::DetectedFeatures = detected;
+  return 0;
+}
+
+#ifdef LIBCHECKSUM_FUZZ_STANDALONE
+
+namespace {
+
+/// \brief Runs the fuzzer on a file or on all files of a directory.
+/// \param path Path of the file or directory
+/// \return Number of inputs run
+std::size_t runPath(const std::string& path) {
+  if (DIR* directory = opendir(path.c_str())) {
+    std::size_t runs {0};
+    while (const dirent* entry = readdir(directory)) {
+      if (entry->d_name[0] != '.') {
+        runs += runPath(path + "/" + entry->d_name);
+      }
+    }
+    closedir(directory);
+    return runs;
+  }
+  std::ifstream file {path, std::ios::binary};
+  if (!file) {
+    std::fprintf(stderr, "Cannot read input %s\n", path.c_str());
+    std::exit(EXIT_FAILURE);
+  }
+  const std::vector<uint8_t> input {std::istreambuf_iterator<char> {file},
+                                    std::istreambuf_iterator<char> {}};
+  LLVMFuzzerTestOneInput(input.data(), input.size());
+  return 1;
+}
+
+} // namespace
+
+/// \brief Runs the inputs given as files or directories, then random inputs.
+///
+/// Understands the options -runs=N (number of random inputs, default 1000)
+/// and -seed=S of libFuzzer, so both builds run with the same arguments.
+int main(int argc, char* argv[]) {
+  unsigned long long runs {1000};
+  unsigned long long seed {std::random_device {}()};
+  std::size_t inputs {0};
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string argument {argv[i]};
+    if (argument.compare(0, 6, "-runs=") == 0) {
+      runs = std::strtoull(argument.c_str() + 6, nullptr, 10);
+    } else if (argument.compare(0, 6, "-seed=") == 0) {
+      seed = std::strtoull(argument.c_str() + 6, nullptr, 10);
+    } else if (argument[0] == '-') {
+      std::fprintf(stderr, "Unknown option %s\n", argument.c_str());
+      return EXIT_FAILURE;
+    } else {
+      inputs += runPath(argument);
+    }
+  }
+
+  std::printf("Running %llu random inputs with -seed=%llu\n", runs, seed);
+  std::mt19937_64 generator {seed};
+  std::vector<uint8_t> input;
+  for (unsigned long long run = 0; run < runs; ++run) {
+    // mostly short inputs, which reach the tails of the kernels
+    const std::size_t maxLength {generator() % 8 == 0 ? 8192u : 256u};
+    input.resize(ParameterLength + generator() % maxLength);
+    for (auto& byte : input) {
+      byte = static_cast<uint8_t>(generator());
+    }
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+  }
+  std::printf("Done: %zu inputs from files, %llu random inputs\n", inputs, runs);
+  return EXIT_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring block indexes
+ *
+ * This header file declares the block index, a sidecar of per-block CRCs of
+ * a large file, with which any range of the file can be verified by reading
+ * only the blocks covering it.
+ */
+
+#ifndef CHECKSUM_BLOCKINDEX_H
+#define CHECKSUM_BLOCKINDEX_H
+
+#include <libchecksum/common.h>
+#include <libchecksum/file.h>
+
+namespace libchecksum {
+
+/// Result of verifying a range of data with a block index
+struct BlockVerification {
+  /// Whether the checksums of the covering blocks match the root of the
+  /// index, i.e. the index itself is intact
+  bool Authentic;
+  /// Indices of the covering blocks whose data does not match their checksum
+  std::vector<uint64_t> Mismatched;
+
+  /// \brief Returns whether the range is verified.
+  /// \return True if the index is intact and all covering blocks match
+  bool ok() const {
+    return Authentic && Mismatched.empty();
+  }
+};
+
+/// \brief Per-block CRCs of data together with a Merkle root.
+///
+/// The data is split into blocks of a fixed size, whose CRC32 or CRC32C is
+/// stored in an array. The checksums of every LeafBlocks consecutive blocks
+/// form a leaf of a binary SHA256 Merkle tree, whose root also covers the
+/// algorithm, block size and data length. Verifying a range checksums only
+/// the blocks covering it and authenticates their checksums by the Merkle
+/// paths of their leaves, so neither the data nor the index is read as a
+/// whole.
+///
+/// The index is stored as a sidecar file, which is memory-mapped when
+/// opened. All integers are little-endian:
+/// - header of 64 bytes: magic "LCBLKIDX", version (uint32, 1), AlgorithmId
+///   (uint32), block size (uint64), data length (uint64), root (32 bytes)
+/// - the checksums of all blocks (uint32 each)
+/// - the nodes of the Merkle tree (32 bytes each), level by level from the
+///   leaves up to the root of the tree
+///
+/// A leaf is the SHA256 of 0x00 followed by its checksums, an inner node the
+/// SHA256 of 0x01 followed by its children; a node without sibling moves up
+/// unchanged. The root is the SHA256 of 0x02, bytes 8 to 31 of the header and
+/// the root of the tree. Errors of files are reported as
+/// \p std::system_error, invalid indexes as \p std::runtime_error.
+class BlockIndex final {
+
+public:
+  /// Default size of the blocks in bytes
+  static constexpr std::size_t DefaultBlockSize {4096};
+  /// Number of block checksums per leaf of the Merkle tree
+  static constexpr std::size_t LeafBlocks {1024};
+
+  /// \brief Calculates the index of data, hashing its leaves in parallel.
+  /// \param data Pointer to the first byte of the data
+  /// \param length Length of the data in bytes
+  /// \param algorithm Checksum of the blocks, AlgorithmId::CRC32 or
+  /// AlgorithmId::CRC32C
+  /// \param blockSize Size of the blocks in bytes
+  /// \param threads Maximum number of threads, 0 for the number of hardware
+  /// threads
+  /// \return The index
+  /// \throws std::invalid_argument for other algorithms or a block size of 0
+  static BlockIndex create(const uint8_t* data, uint64_t length,
+                           AlgorithmId algorithm = AlgorithmId::CRC32C,
+                           std::size_t blockSize = DefaultBlockSize, unsigned threads = 0);
+
+  /// \brief Memory-maps a sidecar file and checks its structure.
+  ///
+  /// The checksums are authenticated lazily, when ranges are verified, or by
+  /// verifyIndex().
+  /// \param path Path of the sidecar file
+  /// \return The index
+  static BlockIndex open(const std::string& path);
+
+  /// \brief Checks the structure of a serialized index and copies it.
+  /// \param data Pointer to the first byte of the serialized index
+  /// \param length Length of the serialized index in bytes
+  /// \return The index
+  static BlockIndex parse(const uint8_t* data, std::size_t length);
+
+  BlockIndex(BlockIndex&& other) noexcept = default;
+  BlockIndex& operator=(BlockIndex&& other) noexcept = default;
+  BlockIndex(const BlockIndex&) = delete;
+  BlockIndex& operator=(const BlockIndex&) = delete;
+  ~BlockIndex();
+
+  /// \brief Writes the index to a sidecar file.
+  /// \param path Path of the sidecar file, which is replaced
+  void save(const std::string& path) const;
+
+  /// \brief Returns the serialized index, as it is stored in sidecar files.
+  /// \return Pointer to the first byte of the serialized index
+  const uint8_t* data() const {
+    return Data;
+  }
+
+  /// \brief Returns the size of the serialized index.
+  /// \return Size of the serialized index in bytes
+  std::size_t size() const {
+    return Size;
+  }
+
+  /// \brief Returns the algorithm of the block checksums.
+  /// \return AlgorithmId::CRC32 or AlgorithmId::CRC32C
+  AlgorithmId algorithm() const;
+
+  /// \brief Returns the size of the blocks.
+  /// \return Size of the blocks in bytes
+  std::size_t blockSize() const;
+
+  /// \brief Returns the length of the indexed data.
+  /// \return Length of the data in bytes
+  uint64_t dataLength() const;
+
+  /// \brief Returns the number of blocks; the last one may be shorter.
+  /// \return Number of blocks
+  uint64_t blockCount() const;
+
+  /// \brief Returns the checksum of a block.
+  /// \param block Index of the block
+  /// \return Checksum of the block
+  uint32_t blockChecksum(uint64_t block) const;
+
+  /// \brief Returns the root, which identifies the indexed data.
+  /// \return Root of the index
+  Digest256 root() const;
+
+  /// \brief Recalculates the Merkle tree of all checksums.
+  /// \return True if all checksums and nodes match the root
+  bool verifyIndex() const;
+
+  /// \brief Verifies a range of the data in memory.
+  ///
+  /// Only the blocks covering the range are read.
+  /// \param data Pointer to the first byte of the whole data
+  /// \param offset Offset of the range
+  /// \param length Length of the range in bytes
+  /// \return Result of the verification
+  /// \throws std::out_of_range if the range exceeds the indexed data
+  BlockVerification verifyRange(const uint8_t* data, uint64_t offset, uint64_t length) const;
+
+  /// \brief Verifies a range of a file.
+  ///
+  /// Only the blocks covering the range are read, with \p pread, so the file
+  /// offset of the descriptor is not changed. Blocks missing at the end of the
+  /// file do not match.
+  /// \param fd Open file descriptor of the data
+  /// \param offset Offset of the range
+  /// \param length Length of the range in bytes
+  /// \return Result of the verification
+  /// \throws std::out_of_range if the range exceeds the indexed data
+  BlockVerification verifyRange(int fd, uint64_t offset, uint64_t length) const;
+
+private:
+  BlockIndex() = default;
+
+  void checkStructure() const;
+  std::vector<uint64_t> checkBlocks(uint64_t first, uint64_t count, const uint8_t* data,
+                                    std::size_t length) const;
+  bool authenticate(uint64_t firstBlock, uint64_t lastBlock) const;
+
+  const uint8_t* Data {nullptr};
+  std::size_t Size {0};
+  std::vector<uint8_t> Buffer {};
+  std::unique_ptr<MappedFile> File {};
+};
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_BLOCKINDEX_H
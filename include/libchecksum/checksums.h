@@ -33,79 +33,230 @@
 #define LIBCHECKSUM_CHECKSUMS_H
 
 #include <libchecksum/common.h>
+#include <libchecksum/kernels.h>
 
 namespace libchecksum {
 
 /// Class that implements the Adler32 checksum algorithm
-class Adler32 final : public ChecksumAlgorithm<uint32_t> {
+class Adler32 final : public ChecksumAlgorithm<uint32_t>,
+    public StaticChecksumAlgorithm<Adler32> {
 
 public:
+  using State = kernel::Adler32State;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Adler32(unsigned threads = 1);
+
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements the Fletcher16 checksum algorithm
-class Fletcher16 final : public ChecksumAlgorithm<uint16_t> {
+class Fletcher16 final : public ChecksumAlgorithm<uint16_t>,
+    public StaticChecksumAlgorithm<Fletcher16> {
 
 public:
+  using State = kernel::Fletcher16State;
   using ChecksumAlgorithm::operator();
-  uint16_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Fletcher16(unsigned threads = 1);
+
+  uint16_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint16_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements the Fletcher32 checksum algorithm
-class Fletcher32 final : public ChecksumAlgorithm<uint32_t> {
+class Fletcher32 final : public ChecksumAlgorithm<uint32_t>,
+    public StaticChecksumAlgorithm<Fletcher32> {
 
 public:
+  using State = kernel::Fletcher32State;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Fletcher32(unsigned threads = 1);
+
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements a 8 bit checksum
-class Sum8 final : public ChecksumAlgorithm<uint8_t> {
+class Sum8 final : public ChecksumAlgorithm<uint8_t>,
+    public StaticChecksumAlgorithm<Sum8> {
 
 public:
+  using State = kernel::Sum8State;
   using ChecksumAlgorithm::operator();
-  uint8_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Sum8(unsigned threads = 1);
+
+  uint8_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint8_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements a 16 bit checksum
-class Sum16 final : public ChecksumAlgorithm<uint16_t> {
+class Sum16 final : public ChecksumAlgorithm<uint16_t>,
+    public StaticChecksumAlgorithm<Sum16> {
 
 public:
+  using State = kernel::Sum16State;
   using ChecksumAlgorithm::operator();
-  uint16_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Sum16(unsigned threads = 1);
+
+  uint16_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint16_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements a 32 bit checksum
-class Sum32 final : public ChecksumAlgorithm<uint32_t> {
+class Sum32 final : public ChecksumAlgorithm<uint32_t>,
+    public StaticChecksumAlgorithm<Sum32> {
 
 public:
+  using State = kernel::Sum32State;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit Sum32(unsigned threads = 1);
+
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements the 16 bit long BSD sum
-class BSDSum final : public ChecksumAlgorithm<uint16_t> {
+class BSDSum final : public ChecksumAlgorithm<uint16_t>,
+    public StaticChecksumAlgorithm<BSDSum> {
 
 public:
+  using State = kernel::BSDSumState;
   using ChecksumAlgorithm::operator();
-  uint16_t operator()(const std::vector<uint8_t>& input) const override;
+  uint16_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint16_t>> createStream() const override;
 };
 
 /// Class that implements the XOR8 checksum
-class XOR8 final : public ChecksumAlgorithm<uint8_t> {
+class XOR8 final : public ChecksumAlgorithm<uint8_t>,
+    public StaticChecksumAlgorithm<XOR8> {
 
 public:
+  using State = kernel::XOR8State;
   using ChecksumAlgorithm::operator();
-  uint8_t operator()(const std::vector<uint8_t>& input) const override;
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit XOR8(unsigned threads = 1);
+
+  uint8_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint8_t>> createStream() const override;
+
+private:
+  unsigned Threads;
 };
 
 /// Class that implements the SYSV checksum
-class SYSV final : public ChecksumAlgorithm<uint32_t> {
+class SYSV final : public ChecksumAlgorithm<uint32_t>,
+    public StaticChecksumAlgorithm<SYSV> {
+
+public:
+  using State = kernel::SYSVState;
+  using ChecksumAlgorithm::operator();
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads summing a single large input,
+  /// 0 for the number of hardware threads
+  explicit SYSV(unsigned threads = 1);
+
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+private:
+  unsigned Threads;
+};
+
+/// \brief Class that implements the Internet checksum (RFC 1071) of IPv4, TCP
+/// and UDP.
+///
+/// Checksums are returned in host byte order and have to be stored in network
+/// byte order in a header.
+class InternetChecksum final : public ChecksumAlgorithm<uint16_t>,
+    public StaticChecksumAlgorithm<InternetChecksum> {
 
 public:
+  using State = kernel::InternetChecksumState;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+  uint16_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint16_t>> createStream() const override;
+
+  /// \brief Updates a checksum after a 16 bit field of the data changed
+  /// (RFC 1624).
+  /// \param checksum Checksum of the old data
+  /// \param oldValue Old value of the field in host byte order
+  /// \param newValue New value of the field in host byte order
+  /// \return Checksum of the new data
+  static constexpr uint16_t patch16(uint16_t checksum, uint16_t oldValue,
+                                    uint16_t newValue) {
+    return kernel::patchInternetChecksum(checksum, oldValue, newValue);
+  }
+
+  /// \brief Updates a checksum after a 32 bit field of the data, e.g. an IPv4
+  /// address, changed (RFC 1624).
+  /// \param checksum Checksum of the old data
+  /// \param oldValue Old value of the field in host byte order
+  /// \param newValue New value of the field in host byte order
+  /// \return Checksum of the new data
+  static constexpr uint16_t patch32(uint16_t checksum, uint32_t oldValue,
+                                    uint32_t newValue) {
+    return patch16(patch16(checksum, static_cast<uint16_t>(oldValue >> 16),
+                           static_cast<uint16_t>(newValue >> 16)),
+                   static_cast<uint16_t>(oldValue), static_cast<uint16_t>(newValue));
+  }
+
+  /// \brief Updates a checksum after a range of bytes of the data changed.
+  ///
+  /// Costs O(length) regardless of the size of the data (RFC 1624).
+  /// \param checksum Checksum of the old data
+  /// \param offset Offset of the range in the data
+  /// \param oldData Old contents of the range
+  /// \param newData New contents of the range
+  /// \param length Length of the range in bytes
+  /// \return Checksum of the new data
+  static uint16_t patch(uint16_t checksum, std::size_t offset, const uint8_t* oldData,
+                        const uint8_t* newData, std::size_t length);
 };
 
 } // namespace libchecksum
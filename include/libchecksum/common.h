@@ -33,9 +33,17 @@
 #ifndef CHECKSUM_COMMON_H
 #define CHECKSUM_COMMON_H
 
+#include <libchecksum/digest.h>
+
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <iomanip>
+#include <memory>
+#include <sstream>
+#include <type_traits>
+#include <utility>
 
 namespace libchecksum {
 
@@ -87,6 +95,24 @@ std::string toHexString(const std::vector<INTTYPE>& values) {
   return stream.str();
 }
 
+/// \brief Function to convert a digest to a hexadecimal string.
+///
+/// All bytes are padded to 2 characters, so the string always has twice the
+/// size of the digest.
+/// \tparam N Size of the digest in bytes
+/// \param digest Digest to convert to hex
+/// \return The digest as hexadecimal string
+template<std::size_t N>
+std::string toHexString(const Digest<N>& digest) {
+  static constexpr char Digits[] = "0123456789abcdef";
+  std::string result(2 * N, '0');
+  for (std::size_t i = 0; i < N; ++i) {
+    result[2 * i] = Digits[digest.Bytes[i] >> 4];
+    result[2 * i + 1] = Digits[digest.Bytes[i] & 0xF];
+  }
+  return result;
+}
+
 } // namespace util
 
 /// \brief Returns the current version of the library as string.
@@ -95,26 +121,193 @@ inline const std::string getVersionString() {
   return std::string{CHECKSUM_VERSION};
 }
 
-/// Abstract class for checksum algorithms
+/// Identifiers of the algorithms of \p libchecksum
+enum class AlgorithmId : unsigned {
+  Adler32,
+  Fletcher16,
+  Fletcher32,
+  Sum8,
+  Sum16,
+  Sum32,
+  BSDSum,
+  XOR8,
+  SYSV,
+  Cksum,
+  CRC32,
+  CRC32C,
+  InternetChecksum,
+  XXH3,
+  XXH128,
+  SHA256,
+  BLAKE3,
+  CRC32BZIP2
+};
+
+/// Number of algorithms in AlgorithmId
+constexpr std::size_t AlgorithmCount {18};
+
+/// Implementation variants the algorithms can choose from at runtime
+enum class KernelTier : unsigned {
+  Scalar,
+  SSE,
+  AVX2,
+  AVX512,
+  SHA
+};
+
+/// Number of tiers in KernelTier
+constexpr std::size_t KernelTierCount {5};
+
+/// \brief Returns the name of an algorithm.
+/// \param id Identifier of the algorithm
+/// \return Name of the algorithm
+inline const char* getAlgorithmName(AlgorithmId id) {
+  static constexpr const char* Names[AlgorithmCount] = {
+    "Adler32", "Fletcher16", "Fletcher32", "Sum8", "Sum16", "Sum32", "BSDSum",
+    "XOR8", "SYSV", "Cksum", "CRC32", "CRC32C",
+    "InternetChecksum", "XXH3", "XXH128", "SHA256", "BLAKE3", "CRC32BZIP2"
+  };
+  return Names[static_cast<std::size_t>(id)];
+}
+
+/// \brief Returns the name of a kernel tier.
+/// \param tier The kernel tier
+/// \return Name of the kernel tier
+inline const char* getKernelTierName(KernelTier tier) {
+  static constexpr const char* Names[KernelTierCount] = {
+    "scalar", "SSE", "AVX2", "AVX-512", "SHA-NI"
+  };
+  return Names[static_cast<std::size_t>(tier)];
+}
+
+/// \brief Abstract class for incremental checksum calculations.
+///
+/// Streams are created by ChecksumAlgorithm::createStream() and allow
+/// calculating the checksum of data that is not available at once. A stream
+/// must not be used by multiple threads at the same time.
+template<typename T>
+class ChecksumStream {
+
+public:
+  /// \brief Default virtual destructor
+  virtual ~ChecksumStream() = default;
+
+  /// \brief Feeds a raw memory buffer into the checksum.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  virtual void update(const uint8_t* data, std::size_t length) = 0;
+
+  /// \brief Feeds a byte vector into the checksum.
+  /// \param input Byte vector to feed
+  void update(const std::vector<uint8_t>& input) {
+    update(input.data(), input.size());
+  }
+
+  /// \brief Feeds a string into the checksum.
+  /// \param input String to feed
+  void update(const std::string& input) {
+    update(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  /// \brief Returns the checksum of all data fed so far.
+  ///
+  /// The stream is not modified, so more data can be fed afterwards.
+  /// \return Checksum of the data
+  virtual T finalize() const = 0;
+
+  /// \brief Returns the checksum of all data fed so far in hexadecimal
+  /// format.
+  /// \return Checksum of the data as hexadecimal string
+  const std::string getHex() const {
+    return util::toHexString(finalize());
+  }
+
+  /// \brief Resets the stream to its initial state.
+  virtual void reset() = 0;
+};
+
+/// \brief Abstract class for checksum algorithms.
+///
+/// Algorithms hold no mutable state, so a single instance can be shared by
+/// any number of threads without locking. Calculating the checksum of a
+/// buffer neither blocks nor allocates memory; only createStream(), the
+/// batch overload returning a vector and the multithreaded calculation of
+/// large inputs, by BLAKE3 or algorithms created with more than one thread,
+/// allocate, and the latter also starts and joins threads.
 template<typename T>
 class ChecksumAlgorithm {
-  static_assert(std::is_integral<T>::value,
-                "This class can only be used for integral types!");
+  static_assert(std::is_integral<T>::value || IsDigest<T>::value,
+                "This class can only be used for integral types and digests!");
 
 public:
   /// \brief Default virtual destructor
   virtual ~ChecksumAlgorithm() = default;
 
+  /// \brief Calculates the checksum of a raw memory buffer.
+  ///
+  /// This is the entry point every algorithm implements. All other overloads
+  /// forward to it without copying the input.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  /// \return Checksum of the buffer
+  virtual T operator()(const uint8_t* data, std::size_t length) const = 0;
+
+  /// \brief Creates a stream for calculating the checksum incrementally.
+  /// \return New stream in its initial state
+  virtual std::unique_ptr<ChecksumStream<T>> createStream() const = 0;
+
+  /// \brief Calculates the checksums of multiple independent buffers.
+  ///
+  /// Algorithms may override this to process several buffers at once with
+  /// SIMD instructions. The default implementation calculates the checksums
+  /// one after another.
+  /// \param data Pointers to the first bytes of the buffers
+  /// \param lengths Numbers of bytes in the buffers
+  /// \param count Number of buffers
+  /// \param results Array receiving the \p count checksums
+  virtual void computeBatch(const uint8_t* const* data, const std::size_t* lengths,
+                            std::size_t count, T* results) const {
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = (*this)(data[i], lengths[i]);
+    }
+  }
+
+  /// \brief Calculates the checksums of multiple strings.
+  /// \param inputs Strings to get the checksums of
+  /// \return Checksums of the strings in the same order
+  std::vector<T> computeBatch(const std::vector<std::string>& inputs) const {
+    std::vector<const uint8_t*> data;
+    std::vector<std::size_t> lengths;
+    for (const auto& input : inputs) {
+      data.push_back(reinterpret_cast<const uint8_t*>(input.data()));
+      lengths.push_back(input.size());
+    }
+    std::vector<T> results(inputs.size());
+    computeBatch(data.data(), lengths.data(), inputs.size(), results.data());
+    return results;
+  }
+
   /// \brief Calculates the checksum of a byte vector.
   /// \param input Byte vector to get the checksum of
   /// \return Checksum of the byte vector
-  virtual T operator()(const std::vector<uint8_t>& input) const = 0;
+  T operator()(const std::vector<uint8_t>& input) const {
+    return (*this)(input.data(), input.size());
+  }
 
   /// \brief Calculates the checksum of a string.
   /// \param input String to get the checksum of
   /// \return Checksum of the string
   T operator()(const std::string& input) const {
-    return this->operator()(std::vector<uint8_t> {input.begin(), input.end()});
+    return (*this)(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  /// \brief Calculates the checksum of a raw memory buffer and returns it in
+  /// hexadecimal format.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  /// \return Checksum of the buffer as hexadecimal string
+  const std::string getHex(const uint8_t* data, std::size_t length) const {
+    return util::toHexString((*this)(data, length));
   }
 
   /// \brief Calculates the checksum of a byte vector and returns it in
@@ -135,7 +328,118 @@ public:
 
 };
 
-/// Abstract template class for CRC algorithms
+/// \brief Base class providing the static interface of an algorithm.
+///
+/// Every algorithm class derives from this class template with itself as
+/// argument and declares its kernel state type (see kernels.h) as \p State.
+/// The static functions call the kernel directly, without any virtual call,
+/// so generic code templated on the algorithm can inline and vectorize it:
+/// \code
+/// template<typename Algorithm>
+/// auto checksumOf(const std::vector<uint8_t>& data) {
+///   return Algorithm::compute(data);
+/// }
+/// \endcode
+/// The virtual interface of ChecksumAlgorithm remains available for runtime
+/// polymorphism and always gives the same results.
+/// \tparam Derived The algorithm class
+template<typename Derived>
+class StaticChecksumAlgorithm {
+
+public:
+  /// \brief Calculates the checksum of a raw memory buffer.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  /// \return Checksum of the buffer
+  static auto compute(const uint8_t* data, std::size_t length) {
+    typename Derived::State state {};
+    state.update(data, length);
+    return state.finalize();
+  }
+
+  /// \brief Calculates the checksum of a byte vector.
+  /// \param input Byte vector to get the checksum of
+  /// \return Checksum of the byte vector
+  static auto compute(const std::vector<uint8_t>& input) {
+    return compute(input.data(), input.size());
+  }
+
+  /// \brief Calculates the checksum of a string.
+  /// \param input String to get the checksum of
+  /// \return Checksum of the string
+  static auto compute(const std::string& input) {
+    return compute(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  /// \brief Creates a state for calculating the checksum incrementally.
+  /// \return New state in its initial state
+  static auto createState() {
+    return typename Derived::State {};
+  }
+};
+
+namespace util {
+
+/// Maps any list of types to \p void, used for detecting members
+template<typename...>
+struct VoidType {
+  using Type = void;
+};
+
+} // namespace util
+
+/// \brief Type trait checking whether a type models the static algorithm
+/// interface of StaticChecksumAlgorithm.
+template<typename Algorithm, typename = void>
+struct IsStaticChecksumAlgorithm : std::false_type {};
+
+template<typename Algorithm>
+struct IsStaticChecksumAlgorithm<Algorithm, typename util::VoidType<
+    typename Algorithm::State,
+    typename Algorithm::State::ResultType,
+    decltype(Algorithm::compute(std::declval<const uint8_t*>(), std::size_t {}))>::Type>
+  : std::true_type {};
+
+/// Read-only lookup tables of an algorithm
+struct TableFootprint {
+  /// Address of the tables, which identifies tables shared by algorithms
+  const void* Address;
+  /// Size of the tables in bytes
+  std::size_t Size;
+};
+
+namespace util {
+
+/// \brief Returns the number of bytes of distinct lookup tables, e.g. of the
+/// algorithms running on one core, counting shared tables once.
+/// \param tables Tables of the algorithms
+/// \return Number of bytes of the distinct tables
+inline std::size_t combinedFootprint(const std::vector<TableFootprint>& tables) {
+  std::size_t size {0};
+  for (std::size_t i = 0; i < tables.size(); ++i) {
+    bool shared {false};
+    for (std::size_t j = 0; j < i; ++j) {
+      shared = shared || tables[j].Address == tables[i].Address;
+    }
+    size += shared ? 0 : tables[i].Size;
+  }
+  return size;
+}
+
+} // namespace util
+
+/// \brief Abstract template class for CRC algorithms.
+///
+/// Every CRC algorithm provides the static function
+/// \code
+/// static U patch(U checksum, uint64_t dataLength, uint64_t offset,
+///                const uint8_t* oldData, const uint8_t* newData, std::size_t length);
+/// \endcode
+/// which updates the \p checksum of \p dataLength bytes of data after the
+/// \p length bytes at \p offset changed from \p oldData to \p newData and
+/// returns the checksum of the new data. It costs O(length + log dataLength)
+/// regardless of the size of the data and throws \p std::out_of_range if the
+/// range exceeds the data.
 template <typename U>
 class CyclicRedundancyChecksum : public ChecksumAlgorithm<U> {
   static_assert(std::is_integral<U>::value, "This class can only be used for integral types!");
@@ -143,14 +447,17 @@ class CyclicRedundancyChecksum : public ChecksumAlgorithm<U> {
 public:
   virtual ~CyclicRedundancyChecksum() = default;
 
-  /// \brief Calculates the checksum of a byte vector.
-  /// \param input Byte vector to get the checksum of
-  /// \return Checksum of the byte vector
-  virtual U operator()(const std::vector<uint8_t>& input) const = 0;
+  using ChecksumAlgorithm<U>::operator();
 
   /// \brief Function returning the generator polynomial of the underlying CRC.
   /// \return Generator polynomial of the underlying CRC algorithm
   virtual U getGeneratorPolynomial() const = 0;
+
+  /// \brief Returns the lookup tables of the CRC.
+  ///
+  /// Algorithms with the same polynomial and bit order share their tables.
+  /// \return Address and size of the tables
+  virtual TableFootprint getTableFootprint() const = 0;
 };
 
 }
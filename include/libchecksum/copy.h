@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring fused copy functions
+ *
+ * This header file declares functions that copy a buffer and calculate its
+ * checksum in a single pass.
+ */
+
+#ifndef CHECKSUM_COPY_H
+#define CHECKSUM_COPY_H
+
+#include <libchecksum/kernels.h>
+
+namespace libchecksum {
+
+/// \brief Copies a buffer and updates a checksum state with the copied bytes.
+///
+/// The checksum is calculated while copying, so the source is read from memory
+/// only once. Large copies write the destination with non-temporal stores,
+/// which bypass the cache: the destination is not cached after the call. The
+/// buffers must not overlap. Supported for the states of CRC32, CRC32C,
+/// Adler32, Sum8, Sum16 and Sum32.
+/// \tparam State State type of the algorithm
+/// \param state State to update
+/// \param destination Pointer to the first byte of the destination
+/// \param source Pointer to the first byte of the source
+/// \param length Number of bytes to copy
+template<typename State>
+void copyAndUpdate(State& state, uint8_t* destination, const uint8_t* source,
+                   std::size_t length);
+
+extern template void copyAndUpdate(kernel::CRC32State&, uint8_t*, const uint8_t*, std::size_t);
+extern template void copyAndUpdate(kernel::CRC32CState&, uint8_t*, const uint8_t*, std::size_t);
+extern template void copyAndUpdate(kernel::Adler32State&, uint8_t*, const uint8_t*, std::size_t);
+extern template void copyAndUpdate(kernel::Sum8State&, uint8_t*, const uint8_t*, std::size_t);
+extern template void copyAndUpdate(kernel::Sum16State&, uint8_t*, const uint8_t*, std::size_t);
+extern template void copyAndUpdate(kernel::Sum32State&, uint8_t*, const uint8_t*, std::size_t);
+
+/// \brief Copies a buffer and returns the checksum of the copied bytes.
+///
+/// See copyAndUpdate() for details.
+/// \tparam Algorithm Algorithm to use, e.g. \p CRC32
+/// \param destination Pointer to the first byte of the destination
+/// \param source Pointer to the first byte of the source
+/// \param length Number of bytes to copy
+/// \return Checksum of the copied bytes
+template<typename Algorithm>
+typename Algorithm::State::ResultType copyWithChecksum(uint8_t* destination,
+    const uint8_t* source, std::size_t length) {
+  typename Algorithm::State state {};
+  copyAndUpdate(state, destination, source, length);
+  return state.finalize();
+}
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_COPY_H
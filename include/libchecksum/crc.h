@@ -33,32 +33,107 @@
 #define CHECKSUM_CRC_H
 
 #include <libchecksum/common.h>
+#include <libchecksum/kernels.h>
 
 namespace libchecksum {
 
 /// Class that implements the CRC checksum from the GNU coreutil cksum
-class Cksum final : public CyclicRedundancyChecksum<uint32_t> {
+class Cksum final : public CyclicRedundancyChecksum<uint32_t>,
+    public StaticChecksumAlgorithm<Cksum> {
 
 public:
+  using State = kernel::CksumState;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
 
   uint32_t getGeneratorPolynomial() const override {
     return 0x04C11DB7;
   }
+
+  TableFootprint getTableFootprint() const override {
+    return {&State::Tables::Tables, State::Tables::Footprint};
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see
+  /// CyclicRedundancyChecksum).
+  static uint32_t patch(uint32_t checksum, uint64_t dataLength, uint64_t offset,
+                        const uint8_t* oldData, const uint8_t* newData, std::size_t length);
 };
 
 /// Class that implements the CRC-32 algorithm used in Ethernet, etc.
-class CRC32 final : public CyclicRedundancyChecksum<uint32_t> {
+class CRC32 final : public CyclicRedundancyChecksum<uint32_t>,
+    public StaticChecksumAlgorithm<CRC32> {
 
 public:
+  using State = kernel::CRC32State;
   using ChecksumAlgorithm::operator();
-  uint32_t operator()(const std::vector<uint8_t>& input) const override;
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
 
   uint32_t getGeneratorPolynomial() const override {
     return 0xedb88320;
   }
 
+  TableFootprint getTableFootprint() const override {
+    return {&State::Tables::Tables, State::Tables::Footprint};
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see
+  /// CyclicRedundancyChecksum).
+  static uint32_t patch(uint32_t checksum, uint64_t dataLength, uint64_t offset,
+                        const uint8_t* oldData, const uint8_t* newData, std::size_t length);
+};
+
+/// Class that implements the CRC-32C (Castagnoli) algorithm used in iSCSI, etc.
+class CRC32C final : public CyclicRedundancyChecksum<uint32_t>,
+    public StaticChecksumAlgorithm<CRC32C> {
+
+public:
+  using State = kernel::CRC32CState;
+  using ChecksumAlgorithm::operator();
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+  uint32_t getGeneratorPolynomial() const override {
+    return 0x82f63b78;
+  }
+
+  TableFootprint getTableFootprint() const override {
+    return {&State::Tables::Tables, State::Tables::Footprint};
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see
+  /// CyclicRedundancyChecksum).
+  static uint32_t patch(uint32_t checksum, uint64_t dataLength, uint64_t offset,
+                        const uint8_t* oldData, const uint8_t* newData, std::size_t length);
+};
+
+/// \brief Class that implements the CRC-32/BZIP2 algorithm used in bzip2.
+///
+/// The non-reflected variant of CRC-32, which shares its lookup tables with
+/// Cksum.
+class CRC32BZIP2 final : public CyclicRedundancyChecksum<uint32_t>,
+    public StaticChecksumAlgorithm<CRC32BZIP2> {
+
+public:
+  using State = kernel::CRC32BZIP2State;
+  using ChecksumAlgorithm::operator();
+  uint32_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint32_t>> createStream() const override;
+
+  uint32_t getGeneratorPolynomial() const override {
+    return 0x04C11DB7;
+  }
+
+  TableFootprint getTableFootprint() const override {
+    return {&State::Tables::Tables, State::Tables::Footprint};
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see
+  /// CyclicRedundancyChecksum).
+  static uint32_t patch(uint32_t checksum, uint64_t dataLength, uint64_t offset,
+                        const uint8_t* oldData, const uint8_t* newData, std::size_t length);
 };
 
 }
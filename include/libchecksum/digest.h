@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring the digest type
+ *
+ * This header file declares the fixed-size digest returned by algorithms
+ * whose values do not fit into an integer.
+ */
+
+#ifndef CHECKSUM_DIGEST_H
+#define CHECKSUM_DIGEST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace libchecksum {
+
+/// \brief Fixed-size digest of hashes wider than 64 bits.
+///
+/// The bytes are stored in their canonical order, which is the order of
+/// their hexadecimal representation. Digests are plain values that can be
+/// compared and used as keys of (unordered) maps without any allocation.
+/// \tparam N Size of the digest in bytes
+template<std::size_t N>
+struct Digest {
+  static_assert(N != 0, "Digests must not be empty!");
+
+  uint8_t Bytes[N];
+
+  /// \brief Returns the size of the digest.
+  /// \return Size of the digest in bytes
+  static constexpr std::size_t size() {
+    return N;
+  }
+
+  const uint8_t* data() const {
+    return Bytes;
+  }
+
+  uint8_t* data() {
+    return Bytes;
+  }
+
+  constexpr bool operator==(const Digest& other) const {
+    for (std::size_t i = 0; i < N; ++i) {
+      if (Bytes[i] != other.Bytes[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool operator!=(const Digest& other) const {
+    return !(*this == other);
+  }
+
+  constexpr bool operator<(const Digest& other) const {
+    for (std::size_t i = 0; i < N; ++i) {
+      if (Bytes[i] != other.Bytes[i]) {
+        return Bytes[i] < other.Bytes[i];
+      }
+    }
+    return false;
+  }
+};
+
+/// 128 bit digest
+using Digest128 = Digest<16>;
+/// 256 bit digest
+using Digest256 = Digest<32>;
+
+/// \brief Creates a 128 bit digest from two 64 bit halves.
+/// \param high Upper half, stored first
+/// \param low Lower half
+/// \return Digest of both halves in big-endian byte order
+constexpr Digest128 makeDigest128(uint64_t high, uint64_t low) {
+  Digest128 digest {};
+  for (std::size_t i = 0; i < 8; ++i) {
+    digest.Bytes[i] = static_cast<uint8_t>(high >> (56 - 8 * i));
+    digest.Bytes[8 + i] = static_cast<uint8_t>(low >> (56 - 8 * i));
+  }
+  return digest;
+}
+
+/// Checks whether a type is a digest
+template<typename T>
+struct IsDigest : std::false_type {};
+
+template<std::size_t N>
+struct IsDigest<Digest<N>> : std::true_type {};
+
+} // namespace libchecksum
+
+namespace std {
+
+/// Hashes digests by their leading bytes, which are uniformly distributed
+template<std::size_t N>
+struct hash<libchecksum::Digest<N>> {
+  std::size_t operator()(const libchecksum::Digest<N>& digest) const noexcept {
+    std::size_t value {0};
+    std::memcpy(&value, digest.Bytes, N < sizeof(value) ? N : sizeof(value));
+    return value;
+  }
+};
+
+} // namespace std
+
+#endif //CHECKSUM_DIGEST_H
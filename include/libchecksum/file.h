@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring file input functions
+ *
+ * This header file declares functions for calculating checksums of files.
+ */
+
+#ifndef CHECKSUM_FILE_H
+#define CHECKSUM_FILE_H
+
+#include <libchecksum/common.h>
+
+#include <cstdio>
+#include <functional>
+#include <iosfwd>
+
+namespace libchecksum {
+
+/// \brief Read-only view of the contents of a file.
+///
+/// Regular files are memory-mapped, so their contents are never copied. Other
+/// files (pipes, terminals, sockets, ...) cannot be mapped and are read into
+/// an internal buffer instead. Errors are reported as \p std::system_error.
+class MappedFile final {
+
+public:
+  /// \brief Opens and maps the file at the given path.
+  /// \param path Path of the file
+  explicit MappedFile(const std::string& path);
+
+  /// \brief Maps the file referred to by an open file descriptor.
+  ///
+  /// The descriptor is not closed by this object.
+  /// \param fd Open file descriptor
+  explicit MappedFile(int fd);
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  ~MappedFile();
+
+  /// \brief Returns a pointer to the first byte of the file.
+  /// \return Pointer to the contents of the file
+  const uint8_t* data() const {
+    return Data;
+  }
+
+  /// \brief Returns the size of the file.
+  /// \return Size of the file in bytes
+  std::size_t size() const {
+    return Size;
+  }
+
+  /// \brief Returns whether the file is memory-mapped or was read into memory.
+  /// \return True if the file is memory-mapped
+  bool isMapped() const {
+    return Mapped;
+  }
+
+private:
+  void load(int fd, const std::string& name);
+  void release() noexcept;
+
+  const uint8_t* Data {nullptr};
+  std::size_t Size {0};
+  bool Mapped {false};
+  std::vector<uint8_t> Buffer {};
+};
+
+/// \brief Reader feeding data from file descriptors, \p FILE streams or
+/// \p std::istream objects to checksum streams in blocks.
+///
+/// The data is read into a single page-aligned buffer of a fixed block size,
+/// which is reused for every block and every source, so pipes, sockets and
+/// standard input are processed in constant memory. Each block is filled
+/// completely before it is passed on, unless the source ends. Errors are
+/// reported as \p std::system_error.
+class BlockReader final {
+
+public:
+  /// Default size of the blocks in bytes
+  static constexpr std::size_t DefaultBlockSize {1 << 18};
+
+  /// \brief Creates a reader with its buffer.
+  /// \param blockSize Size of the blocks in bytes, at least 1
+  explicit BlockReader(std::size_t blockSize = DefaultBlockSize);
+
+  BlockReader(const BlockReader&) = delete;
+  BlockReader& operator=(const BlockReader&) = delete;
+  ~BlockReader();
+
+  /// \brief Returns the size of the blocks.
+  /// \return Size of the blocks in bytes
+  std::size_t blockSize() const {
+    return BlockSize;
+  }
+
+  /// \brief Reads a file descriptor up to its end into a stream.
+  ///
+  /// The kernel is advised that the descriptor is read sequentially. The
+  /// descriptor is not closed.
+  /// \param fd Open file descriptor
+  /// \param stream Stream receiving the data
+  /// \return Number of bytes read
+  template<typename T>
+  std::size_t read(int fd, ChecksumStream<T>& stream) {
+    return readDescriptor(fd, [&stream](const uint8_t* data, std::size_t length) {
+      stream.update(data, length);
+    });
+  }
+
+  /// \brief Reads a \p FILE stream up to its end into a checksum stream.
+  /// \param file Open \p FILE stream
+  /// \param stream Stream receiving the data
+  /// \return Number of bytes read
+  template<typename T>
+  std::size_t read(std::FILE* file, ChecksumStream<T>& stream) {
+    return readFile(file, [&stream](const uint8_t* data, std::size_t length) {
+      stream.update(data, length);
+    });
+  }
+
+  /// \brief Reads an input stream up to its end into a checksum stream.
+  /// \param input Input stream, which is read in binary
+  /// \param stream Stream receiving the data
+  /// \return Number of bytes read
+  template<typename T>
+  std::size_t read(std::istream& input, ChecksumStream<T>& stream) {
+    return readStream(input, [&stream](const uint8_t* data, std::size_t length) {
+      stream.update(data, length);
+    });
+  }
+
+  /// \brief Calculates the checksum of everything that can be read from a
+  /// source.
+  /// \tparam T Type of the checksum
+  /// \tparam Source File descriptor, \p FILE* or \p std::istream
+  /// \param algorithm Checksum algorithm to use
+  /// \param source Source to read from
+  /// \return Checksum of the data
+  template<typename T, typename Source>
+  T checksum(const ChecksumAlgorithm<T>& algorithm, Source&& source) {
+    const auto stream = algorithm.createStream();
+    read(source, *stream);
+    return stream->finalize();
+  }
+
+private:
+  using Consumer = std::function<void(const uint8_t*, std::size_t)>;
+
+  std::size_t readDescriptor(int fd, const Consumer& consume);
+  std::size_t readFile(std::FILE* file, const Consumer& consume);
+  std::size_t readStream(std::istream& input, const Consumer& consume);
+
+  std::size_t BlockSize;
+  uint8_t* Buffer;
+};
+
+/// \brief Calculates the checksum of a file.
+/// \tparam T Type of the checksum
+/// \param algorithm Checksum algorithm to use
+/// \param path Path of the file
+/// \return Checksum of the file
+template<typename T>
+T checksumFile(const ChecksumAlgorithm<T>& algorithm, const std::string& path) {
+  const MappedFile file {path};
+  return algorithm(file.data(), file.size());
+}
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_FILE_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring hash functions
+ *
+ * This header file declares the hash functions of \p libchecksum, which
+ * produce wider values than the checksums.
+ */
+
+#ifndef CHECKSUM_HASH_H
+#define CHECKSUM_HASH_H
+
+#include <libchecksum/common.h>
+#include <libchecksum/kernels.h>
+
+namespace libchecksum {
+
+/// \brief Class that implements the 64 bit XXH3 hash.
+///
+/// XXH3 is a fast non-cryptographic hash for hash tables and fingerprints.
+/// The values are the same as the ones of \p XXH3_64bits() of the xxHash
+/// library. The stripes of long inputs are processed with SSE2, AVX2 or
+/// AVX-512, depending on the CPU.
+class XXH3 final : public ChecksumAlgorithm<uint64_t>,
+    public StaticChecksumAlgorithm<XXH3> {
+
+public:
+  using State = kernel::XXH3State;
+  using ChecksumAlgorithm::operator();
+  uint64_t operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<uint64_t>> createStream() const override;
+};
+
+/// \brief Class that implements the 128 bit XXH3 hash.
+///
+/// The digests are the canonical representation of \p XXH3_128bits() of the
+/// xxHash library, i.e. the upper half comes first in big-endian byte order.
+/// Long inputs are processed with the same SIMD kernels as XXH3.
+class XXH128 final : public ChecksumAlgorithm<Digest128>,
+    public StaticChecksumAlgorithm<XXH128> {
+
+public:
+  using State = kernel::XXH128State;
+  using ChecksumAlgorithm::operator();
+  Digest128 operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<Digest128>> createStream() const override;
+};
+
+/// \brief Class that implements the SHA-256 hash (FIPS 180-4).
+///
+/// Uses the SHA extensions of x86 CPUs if present. Without them, batches of
+/// buffers (see computeBatch()) are hashed eight at a time with AVX2.
+class SHA256 final : public ChecksumAlgorithm<Digest256>,
+    public StaticChecksumAlgorithm<SHA256> {
+
+public:
+  using State = kernel::SHA256State;
+  using ChecksumAlgorithm::operator();
+  using ChecksumAlgorithm::computeBatch;
+  Digest256 operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<Digest256>> createStream() const override;
+  void computeBatch(const uint8_t* const* data, const std::size_t* lengths,
+                    std::size_t count, Digest256* results) const override;
+};
+
+/// \brief Class that implements the BLAKE3 hash with 256 bit digests.
+///
+/// BLAKE3 hashes chunks of 1 KiB as the leaves of a binary tree, so chunks
+/// are hashed 16 at a time with AVX-512 or 8 at a time with AVX2, and large
+/// inputs, like memory-mapped files, are split into subtrees that are hashed
+/// on several threads.
+class BLAKE3 final : public ChecksumAlgorithm<Digest256>,
+    public StaticChecksumAlgorithm<BLAKE3> {
+
+public:
+  using State = kernel::BLAKE3State;
+  using ChecksumAlgorithm::operator();
+
+  /// \brief Creates the algorithm.
+  /// \param threads Maximum number of threads hashing a single large input,
+  /// 0 for the number of hardware threads
+  explicit BLAKE3(unsigned threads = 0);
+
+  Digest256 operator()(const uint8_t* data, std::size_t length) const override;
+  std::unique_ptr<ChecksumStream<Digest256>> createStream() const override;
+
+private:
+  unsigned Threads;
+};
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_HASH_H
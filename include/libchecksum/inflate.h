@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring compressed data
+ * verification
+ *
+ * This header file declares functions that inflate gzip and zlib data and
+ * verify the checksums of their trailers in the same pass. They are only
+ * part of the library if it was built with zlib (CMake option
+ * \p ENABLE_ZLIB).
+ */
+
+#ifndef CHECKSUM_INFLATE_H
+#define CHECKSUM_INFLATE_H
+
+#include <libchecksum/common.h>
+
+#include <functional>
+
+namespace libchecksum {
+
+/// Container formats of deflate data
+enum class CompressedFormat {
+  /// One or more gzip members (RFC 1952), checked by CRC32 and length
+  Gzip,
+  /// A single zlib stream (RFC 1950), checked by Adler32
+  Zlib
+};
+
+/// Result of verifying compressed data
+struct InflateResult {
+  /// Outcome of the verification
+  enum class Status {
+    Ok,
+    /// The data inflated, but a checksum or length of a trailer differs
+    Mismatch,
+    /// A header or the deflate data is invalid, or data follows the end
+    Corrupt,
+    /// The data ends before the last trailer
+    Truncated
+  };
+
+  Status State;
+  /// Number of members or streams inflated completely
+  std::size_t Members;
+  /// Number of bytes inflated, including those of a failed member
+  uint64_t Length;
+  /// Description of the failure, empty if the data is ok
+  std::string Error;
+};
+
+/// Options for the verification of compressed data
+struct InflateOptions {
+  /// Number of threads verifying gzip members, 0 for one per hardware thread
+  unsigned Threads {0};
+  /// Size in bytes of the window receiving the inflated data, which is
+  /// checksummed while it is in the cache
+  std::size_t WindowSize {1 << 15};
+};
+
+/// \brief Function receiving inflated data.
+///
+/// The data is only valid during the call.
+using InflateOutput = std::function<void(const uint8_t*, std::size_t)>;
+
+/// \brief Inflates compressed data and verifies its trailers.
+///
+/// Every window of inflated data updates the CRC32 or Adler32 state right
+/// after zlib wrote it, while the window is still in the cache, and is then
+/// discarded. zlib computes no checksum itself. The members of gzip data
+/// cannot be located without inflating the preceding ones, so every offset
+/// that starts like a gzip header is inflated in parallel, and the results
+/// of the actual members are chained afterwards. Data after the last member,
+/// even zeroes, makes the data corrupt.
+/// \param data Pointer to the first byte of the compressed data
+/// \param length Length of the compressed data in bytes
+/// \param format Container format of the data
+/// \param options Options of the verification
+/// \return Result of the verification
+InflateResult verifyCompressed(const uint8_t* data, std::size_t length,
+                               CompressedFormat format, const InflateOptions& options = {});
+
+/// \brief Inflates compressed data, passes it on and verifies its trailers.
+///
+/// Works like verifyCompressed(), but passes every window to \p output
+/// after updating the checksum, so the inflated data is read from memory
+/// only once. The members are inflated one after another, in order, by the
+/// calling thread. The trailer of a member is checked after all its data
+/// was passed on; if the result is not ok, the output has to be discarded.
+/// \param data Pointer to the first byte of the compressed data
+/// \param length Length of the compressed data in bytes
+/// \param format Container format of the data
+/// \param output Function receiving the inflated data
+/// \param windowSize Size in bytes of the window receiving the inflated data
+/// \return Result of the verification
+InflateResult inflateVerified(const uint8_t* data, std::size_t length,
+                              CompressedFormat format, const InflateOutput& output,
+                              std::size_t windowSize = InflateOptions {}.WindowSize);
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_INFLATE_H
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring the instrumentation
+ *
+ * This header file declares the optional instrumentation of \p libchecksum,
+ * which counts the calls, processed bytes, used kernel tiers and latencies of
+ * every algorithm.
+ *
+ * The instrumentation is only compiled into the library if it was configured
+ * with the CMake option \p ENABLE_INSTRUMENTATION. Otherwise the hooks do not
+ * exist at all and all counters stay zero. Even when compiled in, it has to
+ * be switched on at runtime with instrumentation::enable(); while it is
+ * switched off, every call pays a single relaxed atomic load.
+ */
+
+#ifndef CHECKSUM_INSTRUMENTATION_H
+#define CHECKSUM_INSTRUMENTATION_H
+
+#include <libchecksum/common.h>
+
+namespace libchecksum {
+
+namespace instrumentation {
+
+/// \brief Number of buckets of the latency histograms.
+///
+/// Bucket \p i counts calls that took at least 2^i and less than 2^(i+1)
+/// nanoseconds, calls below 1 ns are counted in bucket 0 and the last bucket
+/// counts all longer calls.
+constexpr std::size_t LatencyBucketCount {32};
+
+/// Counters of a single algorithm
+struct AlgorithmCounters {
+  /// Number of calls, including updates of streams
+  uint64_t Calls;
+  /// Number of processed bytes
+  uint64_t Bytes;
+  /// Total time spent in the algorithm in nanoseconds
+  uint64_t Nanoseconds;
+  /// Number of calls per kernel tier, indexed by KernelTier
+  uint64_t TierCalls[KernelTierCount];
+  /// Histogram of the call latencies
+  uint64_t Latency[LatencyBucketCount];
+};
+
+/// Counters of all algorithms at a point in time
+struct Snapshot {
+  /// Counters indexed by AlgorithmId
+  AlgorithmCounters Algorithms[AlgorithmCount];
+
+  /// \brief Returns the counters of an algorithm.
+  /// \param id Identifier of the algorithm
+  /// \return Counters of the algorithm
+  const AlgorithmCounters& operator[](AlgorithmId id) const {
+    return Algorithms[static_cast<std::size_t>(id)];
+  }
+};
+
+/// \brief Returns whether the instrumentation was compiled into the library.
+/// \return True if the library was built with instrumentation
+bool isAvailable();
+
+/// \brief Switches the recording on or off.
+///
+/// Has no effect if the instrumentation is not available.
+/// \param enabled True to start recording, false to stop it
+void enable(bool enabled);
+
+/// \brief Returns whether calls are currently recorded.
+/// \return True if the instrumentation is available and switched on
+bool isEnabled();
+
+/// \brief Returns the current values of all counters.
+///
+/// The counters are read one by one while other threads may keep updating
+/// them, so the snapshot is not atomic as a whole.
+/// \return Snapshot of all counters
+Snapshot getSnapshot();
+
+/// \brief Sets all counters to zero.
+void reset();
+
+} // namespace instrumentation
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_INSTRUMENTATION_H
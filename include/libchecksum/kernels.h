@@ -0,0 +1,1915 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header-only implementations of the algorithms of \p libchecksum
+ *
+ * This header file implements all checksum algorithms of \p libchecksum as
+ * non-virtual, \p constexpr state types. It does not depend on the compiled
+ * library, so it can be used on its own (see the CMake target
+ * \p checksum_header_only) and lets the compiler inline the algorithms into
+ * hot loops or fold checksums of constant data at compile time.
+ *
+ * Every state type provides \p update() for feeding data incrementally and
+ * \p finalize() for getting the checksum of all data fed so far. The free
+ * functions compute the checksum of a single buffer.
+ */
+
+#ifndef CHECKSUM_KERNELS_H
+#define CHECKSUM_KERNELS_H
+
+#include <libchecksum/digest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace libchecksum {
+
+namespace kernel {
+
+/// \brief Lookup table of a table-driven CRC.
+///
+/// Tables start at a cache line, so each of them spans exactly 16 lines.
+struct alignas(64) CrcTable {
+  uint32_t Entries[256];
+};
+
+/// \brief Generates the lookup table of a reflected (LSB first) 32 bit CRC.
+/// \param polynomial Reversed generator polynomial
+/// \return Lookup table for the polynomial
+constexpr CrcTable makeReflectedTable(uint32_t polynomial) {
+  CrcTable table {};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t value {i};
+    for (int bit = 0; bit < 8; ++bit) {
+      value = (value & 1) != 0 ? (value >> 1) ^ polynomial : value >> 1;
+    }
+    table.Entries[i] = value;
+  }
+  return table;
+}
+
+/// \brief Generates the lookup table of a non-reflected (MSB first) 32 bit
+/// CRC.
+/// \param polynomial Generator polynomial
+/// \return Lookup table for the polynomial
+constexpr CrcTable makeTable(uint32_t polynomial) {
+  CrcTable table {};
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t value {i << 24};
+    for (int bit = 0; bit < 8; ++bit) {
+      value = (value & 0x80000000) != 0 ? (value << 1) ^ polynomial : value << 1;
+    }
+    table.Entries[i] = value;
+  }
+  return table;
+}
+
+/// \brief Lookup tables of a CRC for slicing-by-8.
+///
+/// Slice \p k holds the CRC of a byte followed by \p k zero bytes, so eight
+/// input bytes are processed with eight independent lookups.
+struct SlicedCrcTable {
+  CrcTable Slices[8];
+};
+
+/// \brief Generates the lookup tables of a 32 bit CRC for slicing-by-8.
+/// \param polynomial Generator polynomial, reversed for reflected CRCs
+/// \param reflected Whether the CRC processes the least significant bit first
+/// \return Lookup tables for the polynomial
+constexpr SlicedCrcTable makeSlicedTable(uint32_t polynomial, bool reflected) {
+  SlicedCrcTable tables {};
+  tables.Slices[0] = reflected ? makeReflectedTable(polynomial) : makeTable(polynomial);
+  const CrcTable& base = tables.Slices[0];
+  for (std::size_t slice = 1; slice < 8; ++slice) {
+    for (std::size_t i = 0; i < 256; ++i) {
+      const uint32_t previous {tables.Slices[slice - 1].Entries[i]};
+      tables.Slices[slice].Entries[i] = reflected
+          ? (previous >> 8) ^ base.Entries[previous & 0xFF]
+          : (previous << 8) ^ base.Entries[previous >> 24];
+    }
+  }
+  return tables;
+}
+
+/// \brief Multiplies two polynomials modulo the generator polynomial of a
+/// 32 bit CRC.
+///
+/// The polynomials are represented like the CRC register, i.e. reflected
+/// ones hold the coefficient of x^0 in the most significant bit.
+/// \param a First factor
+/// \param b Second factor
+/// \param polynomial Generator polynomial, reversed for reflected CRCs
+/// \param reflected Whether the CRC processes the least significant bit first
+/// \return Product of the factors modulo the generator polynomial
+constexpr uint32_t multiplyModulo(uint32_t a, uint32_t b, uint32_t polynomial, bool reflected) {
+  uint32_t product {0};
+  for (int i = 0; i < 32; ++i) {
+    // add b times the next power of x in a, then multiply b by x
+    if ((a & (reflected ? 0x80000000u >> i : 1u << i)) != 0) {
+      product ^= b;
+    }
+    if (reflected) {
+      b = (b & 1) != 0 ? (b >> 1) ^ polynomial : b >> 1;
+    } else {
+      b = (b & 0x80000000) != 0 ? (b << 1) ^ polynomial : b << 1;
+    }
+  }
+  return product;
+}
+
+/// \brief Powers of x that shift a CRC register over zero bytes.
+///
+/// Entry \p k is x^(8 * 2^k) modulo the generator polynomial, which shifts
+/// the register over 2^k zero bytes when multiplied with it.
+struct CrcPowers {
+  uint32_t Entries[64];
+};
+
+/// \brief Generates the powers of x of a 32 bit CRC (see CrcPowers).
+/// \param polynomial Generator polynomial, reversed for reflected CRCs
+/// \param reflected Whether the CRC processes the least significant bit first
+/// \return Powers of x for the polynomial
+constexpr CrcPowers makePowers(uint32_t polynomial, bool reflected) {
+  CrcPowers powers {};
+  powers.Entries[0] = reflected ? 0x80000000u >> 8 : 1u << 8;
+  for (std::size_t k = 1; k < 64; ++k) {
+    const uint32_t previous {powers.Entries[k - 1]};
+    powers.Entries[k] = multiplyModulo(previous, previous, polynomial, reflected);
+  }
+  return powers;
+}
+
+/// \brief Registry of the lookup tables of the CRC algorithms.
+///
+/// The tables are generated at compile time and placed in read-only storage,
+/// so they need no initialization at runtime and can be read by any number
+/// of threads. As a class template, the registry holds a single copy of the
+/// tables of every polynomial and bit order in a program, which is shared by
+/// all algorithms using them (e.g. Cksum and CRC-32/BZIP2), no matter how
+/// many translation units include this header.
+/// \tparam Polynomial Generator polynomial, reversed for reflected CRCs
+/// \tparam Reflected Whether the CRC processes the least significant bit first
+template<uint32_t Polynomial, bool Reflected>
+struct CrcTables {
+  static constexpr SlicedCrcTable Tables {makeSlicedTable(Polynomial, Reflected)};
+  /// Number of bytes of the tables, i.e. of the cache lines they occupy
+  static constexpr std::size_t Footprint {sizeof(SlicedCrcTable)};
+  /// Powers of x, which are only read when patching a CRC (see patchCrc())
+  static constexpr CrcPowers Powers {makePowers(Polynomial, Reflected)};
+  static constexpr uint32_t GeneratorPolynomial {Polynomial};
+  static constexpr bool IsReflected {Reflected};
+};
+
+template<uint32_t Polynomial, bool Reflected>
+constexpr SlicedCrcTable CrcTables<Polynomial, Reflected>::Tables;
+template<uint32_t Polynomial, bool Reflected>
+constexpr std::size_t CrcTables<Polynomial, Reflected>::Footprint;
+template<uint32_t Polynomial, bool Reflected>
+constexpr CrcPowers CrcTables<Polynomial, Reflected>::Powers;
+template<uint32_t Polynomial, bool Reflected>
+constexpr uint32_t CrcTables<Polynomial, Reflected>::GeneratorPolynomial;
+template<uint32_t Polynomial, bool Reflected>
+constexpr bool CrcTables<Polynomial, Reflected>::IsReflected;
+
+/// \brief Updates a reflected (LSB first) 32 bit CRC with slicing-by-8.
+/// \tparam Tables Entry of the table registry (see CrcTables)
+/// \param crc Current value of the CRC register
+/// \param data Input
+/// \param length Number of bytes of the input
+/// \return New value of the CRC register
+template<typename Tables, typename Byte>
+constexpr uint32_t updateReflectedCrc(uint32_t crc, const Byte* data, std::size_t length) {
+  const CrcTable (&t)[8] = Tables::Tables.Slices;
+  for (; length >= 8; length -= 8, data += 8) {
+    uint32_t low {crc}, high {0};
+    for (std::size_t i = 0; i < 4; ++i) {
+      low ^= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+      high |= static_cast<uint32_t>(static_cast<uint8_t>(data[4 + i])) << (8 * i);
+    }
+    crc = t[7].Entries[low & 0xFF] ^ t[6].Entries[(low >> 8) & 0xFF]
+          ^ t[5].Entries[(low >> 16) & 0xFF] ^ t[4].Entries[low >> 24]
+          ^ t[3].Entries[high & 0xFF] ^ t[2].Entries[(high >> 8) & 0xFF]
+          ^ t[1].Entries[(high >> 16) & 0xFF] ^ t[0].Entries[high >> 24];
+  }
+  for (std::size_t i = 0; i < length; ++i) {
+    crc = t[0].Entries[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+/// \brief Updates a non-reflected (MSB first) 32 bit CRC with slicing-by-8.
+/// \tparam Tables Entry of the table registry (see CrcTables)
+/// \param crc Current value of the CRC register
+/// \param data Input
+/// \param length Number of bytes of the input
+/// \return New value of the CRC register
+template<typename Tables, typename Byte>
+constexpr uint32_t updateCrc(uint32_t crc, const Byte* data, std::size_t length) {
+  const CrcTable (&t)[8] = Tables::Tables.Slices;
+  for (; length >= 8; length -= 8, data += 8) {
+    uint32_t high {crc}, low {0};
+    for (std::size_t i = 0; i < 4; ++i) {
+      high ^= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (24 - 8 * i);
+      low |= static_cast<uint32_t>(static_cast<uint8_t>(data[4 + i])) << (24 - 8 * i);
+    }
+    crc = t[7].Entries[high >> 24] ^ t[6].Entries[(high >> 16) & 0xFF]
+          ^ t[5].Entries[(high >> 8) & 0xFF] ^ t[4].Entries[high & 0xFF]
+          ^ t[3].Entries[low >> 24] ^ t[2].Entries[(low >> 16) & 0xFF]
+          ^ t[1].Entries[(low >> 8) & 0xFF] ^ t[0].Entries[low & 0xFF];
+  }
+  for (std::size_t i = 0; i < length; ++i) {
+    crc = (crc << 8) ^ t[0].Entries[(crc >> 24) ^ static_cast<uint8_t>(data[i])];
+  }
+  return crc;
+}
+
+/// \brief Shifts a CRC register over zero bytes.
+///
+/// Takes one multiplication per set bit of \p zeroes instead of one table
+/// lookup per byte.
+/// \tparam Tables Entry of the table registry (see CrcTables)
+/// \param crc Value of the CRC register
+/// \param zeroes Number of zero bytes
+/// \return Value of the CRC register after the zero bytes
+template<typename Tables>
+constexpr uint32_t shiftCrc(uint32_t crc, uint64_t zeroes) {
+  for (std::size_t k = 0; zeroes != 0; ++k, zeroes >>= 1) {
+    if ((zeroes & 1) != 0) {
+      crc = multiplyModulo(Tables::Powers.Entries[k], crc, Tables::GeneratorPolynomial,
+                           Tables::IsReflected);
+    }
+  }
+  return crc;
+}
+
+/// \brief Calculates how the CRC of data changes if a range of it is
+/// replaced.
+///
+/// The CRC register is linear in the data, so the change only depends on the
+/// bytes that differ: it is the register of their XOR, starting from zero and
+/// shifted over the bytes following the range. This takes time proportional
+/// to the length of the range plus the logarithm of the number of following
+/// bytes.
+/// \tparam Tables Entry of the table registry (see CrcTables)
+/// \param oldData Old contents of the range
+/// \param newData New contents of the range
+/// \param length Length of the range in bytes
+/// \param following Number of bytes following the range
+/// \return Value to XOR to the old CRC to get the new one
+///
+/// The CRC states build on this the static function
+/// \code
+/// patch(checksum, dataLength, offset, oldData, newData, length)
+/// \endcode
+/// which returns the checksum of the data after the \p length bytes at
+/// \p offset of the \p dataLength bytes changed from \p oldData to
+/// \p newData. \p dataLength must be at least \p offset + \p length.
+template<typename Tables, typename Byte>
+constexpr uint32_t patchCrc(const Byte* oldData, const Byte* newData, std::size_t length,
+                            uint64_t following) {
+  uint32_t crc {0};
+  uint8_t difference[256] {};
+  while (length != 0) {
+    const std::size_t block {length < sizeof(difference) ? length : sizeof(difference)};
+    for (std::size_t i = 0; i < block; ++i) {
+      difference[i] = static_cast<uint8_t>(static_cast<uint8_t>(oldData[i])
+                                           ^ static_cast<uint8_t>(newData[i]));
+    }
+    crc = Tables::IsReflected ? updateReflectedCrc<Tables>(crc, difference, block)
+                              : updateCrc<Tables>(crc, difference, block);
+    oldData += block;
+    newData += block;
+    length -= block;
+  }
+  return shiftCrc<Tables>(crc, following);
+}
+
+/// \brief Largest number of bytes that can be summed up before the 32 bit
+/// sums of Adler32 and Fletcher32 have to be reduced.
+constexpr std::size_t MaxDeferredBytes {5552};
+
+/// Incremental state of the Adler32 checksum
+class Adler32State {
+
+public:
+  using ResultType = uint32_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    // the sums are kept in locals, as they might alias the data otherwise
+    uint32_t a {s1}, b {s2};
+    while (length != 0) {
+      const std::size_t block {length < MaxDeferredBytes ? length : MaxDeferredBytes};
+      for (std::size_t i = 0; i < block; ++i) {
+        a += static_cast<uint8_t>(data[i]);
+        b += a;
+      }
+      a %= 65521;
+      b %= 65521;
+      data += block;
+      length -= block;
+    }
+    s1 = a;
+    s2 = b;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  /// \param nextLength Length of the following data
+  constexpr void combine(const Adler32State& next, std::size_t nextLength) {
+    // both states start with s1 = 1, and every following byte adds the sum
+    // of this data, without that start, once more to s2
+    const uint64_t sum {(s1 + 65520) % 65521};
+    s2 = static_cast<uint32_t>((s2 + next.s2 + nextLength % 65521 * sum) % 65521);
+    s1 = static_cast<uint32_t>((sum + next.s1) % 65521);
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  /// \param window Number of bytes in the window
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t window) {
+    // out was added to s2 once for every byte of the window, and the start
+    // value of s1 once more
+    s1 = (s1 + 65521 - out + in) % 65521;
+    s2 = static_cast<uint32_t>((s2 + s1 + 2 * 65521 - 1 - window % 65521 * out % 65521) % 65521);
+  }
+
+  constexpr ResultType finalize() const {
+    return (s2 << 16) | s1;
+  }
+
+private:
+  uint32_t s1 {1}, s2 {0};
+};
+
+/// Incremental state of the Fletcher16 checksum
+class Fletcher16State {
+
+public:
+  using ResultType = uint16_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    // the sums are kept in locals, as they might alias the data otherwise
+    uint32_t a {s1}, b {s2};
+    while (length != 0) {
+      const std::size_t block {length < MaxDeferredBytes ? length : MaxDeferredBytes};
+      for (std::size_t i = 0; i < block; ++i) {
+        a += static_cast<uint8_t>(data[i]);
+        b += a;
+      }
+      a %= 255;
+      b %= 255;
+      data += block;
+      length -= block;
+    }
+    s1 = a;
+    s2 = b;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  /// \param nextLength Length of the following data
+  constexpr void combine(const Fletcher16State& next, std::size_t nextLength) {
+    // every following byte adds the sum of this data once more to s2
+    s2 = static_cast<uint32_t>((s2 + next.s2 + nextLength % 255 * s1) % 255);
+    s1 = (s1 + next.s1) % 255;
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  /// \param window Number of bytes in the window
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t window) {
+    // out was added to s2 once for every byte of the window
+    s1 = (s1 + 255 - out + in) % 255;
+    s2 = static_cast<uint32_t>((s2 + s1 + 255 - window % 255 * out % 255) % 255);
+  }
+
+  constexpr ResultType finalize() const {
+    return static_cast<uint16_t>((s2 << 8) | s1);
+  }
+
+private:
+  uint32_t s1 {0}, s2 {0};
+};
+
+/// Incremental state of the Fletcher32 checksum
+class Fletcher32State {
+
+public:
+  using ResultType = uint32_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    // the sums are kept in locals, as they might alias the data otherwise
+    uint32_t a {s1}, b {s2};
+    while (length != 0) {
+      const std::size_t block {length < MaxDeferredBytes ? length : MaxDeferredBytes};
+      for (std::size_t i = 0; i < block; ++i) {
+        a += static_cast<uint8_t>(data[i]);
+        b += a;
+      }
+      a %= 65535;
+      b %= 65535;
+      data += block;
+      length -= block;
+    }
+    s1 = a;
+    s2 = b;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  /// \param nextLength Length of the following data
+  constexpr void combine(const Fletcher32State& next, std::size_t nextLength) {
+    // every following byte adds the sum of this data once more to s2
+    s2 = static_cast<uint32_t>((s2 + next.s2 + uint64_t {nextLength % 65535} * s1) % 65535);
+    s1 = (s1 + next.s1) % 65535;
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  /// \param window Number of bytes in the window
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t window) {
+    // out was added to s2 once for every byte of the window
+    s1 = (s1 + 65535 - out + in) % 65535;
+    s2 = static_cast<uint32_t>((s2 + s1 + 65535 - window % 65535 * out % 65535) % 65535);
+  }
+
+  constexpr ResultType finalize() const {
+    return (s2 << 16) | s1;
+  }
+
+private:
+  uint32_t s1 {0}, s2 {0};
+};
+
+/// \brief Incremental state of the plain byte sums.
+///
+/// The sum is kept in 32 bits and truncated to \p Mask when finalized, which
+/// gives the same result as truncating after every byte.
+/// \tparam T Type of the checksum
+/// \tparam Mask Mask applied to the sum
+template<typename T, uint32_t Mask>
+class ByteSumState {
+
+public:
+  using ResultType = T;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    uint32_t sum {Sum};
+    for (std::size_t i = 0; i < length; ++i) {
+      sum += static_cast<uint8_t>(data[i]);
+    }
+    Sum = sum;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  constexpr void combine(const ByteSumState& next, std::size_t /*nextLength*/) {
+    Sum += next.Sum;
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t /*window*/) {
+    Sum = Sum - out + in;
+  }
+
+  constexpr ResultType finalize() const {
+    return static_cast<T>(Sum & Mask);
+  }
+
+private:
+  uint32_t Sum {0};
+};
+
+/// Incremental state of the 8 bit checksum
+using Sum8State = ByteSumState<uint8_t, 0xFF>;
+/// Incremental state of the 16 bit checksum
+using Sum16State = ByteSumState<uint16_t, 0xFFFF>;
+/// Incremental state of the 32 bit checksum, which only keeps 24 bits
+using Sum32State = ByteSumState<uint32_t, 0xFFFFFF>;
+
+/// Incremental state of the 16 bit BSD sum
+class BSDSumState {
+
+public:
+  using ResultType = uint16_t;
+
+  constexpr BSDSumState() = default;
+
+  /// \brief Continues a sum from an intermediate checksum.
+  /// \param checksum Sum of the data before the next update
+  constexpr explicit BSDSumState(uint16_t checksum) : Checksum {checksum} {}
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    uint16_t checksum {Checksum};
+    for (std::size_t i = 0; i < length; ++i) {
+      checksum = static_cast<uint16_t>((checksum >> 1) + ((checksum & 1) << 15));
+      checksum = static_cast<uint16_t>(checksum + static_cast<uint8_t>(data[i]));
+    }
+    Checksum = checksum;
+  }
+
+  constexpr ResultType finalize() const {
+    return Checksum;
+  }
+
+private:
+  uint16_t Checksum {0};
+};
+
+/// Incremental state of the XOR8 checksum
+class XOR8State {
+
+public:
+  using ResultType = uint8_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    uint8_t checksum {Checksum};
+    for (std::size_t i = 0; i < length; ++i) {
+      checksum ^= static_cast<uint8_t>(data[i]);
+    }
+    Checksum = checksum;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  constexpr void combine(const XOR8State& next, std::size_t /*nextLength*/) {
+    Checksum ^= next.Checksum;
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t /*window*/) {
+    Checksum = static_cast<uint8_t>(Checksum ^ out ^ in);
+  }
+
+  constexpr ResultType finalize() const {
+    return Checksum;
+  }
+
+private:
+  uint8_t Checksum {0};
+};
+
+/// Incremental state of the SYSV checksum
+class SYSVState {
+
+public:
+  using ResultType = uint32_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    uint32_t sum {Sum};
+    for (std::size_t i = 0; i < length; ++i) {
+      sum += static_cast<uint8_t>(data[i]);
+    }
+    Sum = sum;
+  }
+
+  /// \brief Appends the state of the data following the data of this state.
+  /// \param next State of the following data
+  constexpr void combine(const SYSVState& next, std::size_t /*nextLength*/) {
+    // the folded results lose the wrap-around of the 32 bit sums, the
+    // states keep it
+    Sum += next.Sum;
+  }
+
+  /// \brief Slides the window of the state over the data by one byte.
+  /// \param out First byte of the window, which leaves it
+  /// \param in Byte following the window, which enters it
+  constexpr void roll(uint8_t out, uint8_t in, std::size_t /*window*/) {
+    Sum = Sum - out + in;
+  }
+
+  constexpr ResultType finalize() const {
+    const uint32_t r {(Sum & 0xFFFF) + (Sum >> 16)};
+    return (r & 0xFFFF) + (r >> 16);
+  }
+
+private:
+  uint32_t Sum {0};
+};
+
+/// Incremental state of the CRC of the GNU coreutil cksum
+class CksumState {
+
+public:
+  using ResultType = uint32_t;
+  using Tables = CrcTables<0x04C11DB7, false>;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    CRC = updateCrc<Tables>(CRC, data, length);
+    Length += length;
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see patchCrc()).
+  template<typename Byte>
+  static constexpr ResultType patch(ResultType checksum, uint64_t dataLength, uint64_t offset,
+                                    const Byte* oldData, const Byte* newData,
+                                    std::size_t length) {
+    // the length of the data follows it, but does not change
+    uint64_t following {dataLength - offset - length};
+    for (; dataLength != 0; dataLength >>= 8) {
+      ++following;
+    }
+    return checksum ^ patchCrc<Tables>(oldData, newData, length, following);
+  }
+
+  /// \brief Returns the checksum, which includes the length of the data.
+  constexpr ResultType finalize() const {
+    uint32_t result {CRC};
+    for (uint64_t length = Length; length != 0; length >>= 8) {
+      result = (result << 8) ^ Tables::Tables.Slices[0].Entries[((result >> 24) ^ length) & 0xFF];
+    }
+    return ~result;
+  }
+
+private:
+  uint32_t CRC {0};
+  uint64_t Length {0};
+};
+
+/// Incremental state of the CRC-32 algorithm used in Ethernet, etc.
+class CRC32State {
+
+public:
+  using ResultType = uint32_t;
+  using Tables = CrcTables<0xEDB88320, true>;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    CRC = updateReflectedCrc<Tables>(CRC, data, length);
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see patchCrc()).
+  template<typename Byte>
+  static constexpr ResultType patch(ResultType checksum, uint64_t dataLength, uint64_t offset,
+                                    const Byte* oldData, const Byte* newData,
+                                    std::size_t length) {
+    return checksum ^ patchCrc<Tables>(oldData, newData, length, dataLength - offset - length);
+  }
+
+  constexpr ResultType finalize() const {
+    return CRC ^ 0xFFFFFFFF;
+  }
+
+private:
+  uint32_t CRC {0xFFFFFFFF};
+};
+
+/// Incremental state of the CRC-32C (Castagnoli) algorithm used in iSCSI, etc.
+class CRC32CState {
+
+public:
+  using ResultType = uint32_t;
+  using Tables = CrcTables<0x82F63B78, true>;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    CRC = updateReflectedCrc<Tables>(CRC, data, length);
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see patchCrc()).
+  template<typename Byte>
+  static constexpr ResultType patch(ResultType checksum, uint64_t dataLength, uint64_t offset,
+                                    const Byte* oldData, const Byte* newData,
+                                    std::size_t length) {
+    return checksum ^ patchCrc<Tables>(oldData, newData, length, dataLength - offset - length);
+  }
+
+  constexpr ResultType finalize() const {
+    return CRC ^ 0xFFFFFFFF;
+  }
+
+private:
+  uint32_t CRC {0xFFFFFFFF};
+};
+
+/// \brief Incremental state of the CRC-32/BZIP2 algorithm used in bzip2.
+///
+/// It is the non-reflected variant of CRC-32 and shares its tables with
+/// Cksum.
+class CRC32BZIP2State {
+
+public:
+  using ResultType = uint32_t;
+  using Tables = CrcTables<0x04C11DB7, false>;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    CRC = updateCrc<Tables>(CRC, data, length);
+  }
+
+  /// \brief Updates a checksum after a range of the data changed (see patchCrc()).
+  template<typename Byte>
+  static constexpr ResultType patch(ResultType checksum, uint64_t dataLength, uint64_t offset,
+                                    const Byte* oldData, const Byte* newData,
+                                    std::size_t length) {
+    return checksum ^ patchCrc<Tables>(oldData, newData, length, dataLength - offset - length);
+  }
+
+  constexpr ResultType finalize() const {
+    return CRC ^ 0xFFFFFFFF;
+  }
+
+private:
+  uint32_t CRC {0xFFFFFFFF};
+};
+
+/// \brief Folds a sum of 16 bit words to 16 bits with end-around carry.
+/// \param sum Sum of 16 bit words
+/// \return Ones' complement sum in the range 0 to 0xFFFF
+constexpr uint32_t foldOnesComplement(uint64_t sum) {
+  while ((sum >> 16) != 0) {
+    sum = (sum & 0xFFFF) + (sum >> 16);
+  }
+  return static_cast<uint32_t>(sum);
+}
+
+/// \brief Adds to a sum of 16 bit words with end-around carry.
+///
+/// As 2^64 is 1 modulo 0xFFFF, adding the carry out of 64 bits back in keeps
+/// the ones' complement sum of a sum that would overflow.
+/// \param sum Sum of 16 bit words
+/// \param value Value to add
+/// \return Sum folding to the ones' complement sum of \p sum and \p value
+constexpr uint64_t addEndAroundCarry(uint64_t sum, uint64_t value) {
+  sum += value;
+  return sum < value ? sum + 1 : sum;
+}
+
+/// \brief Incremental state of the Internet checksum (RFC 1071) of IPv4, TCP
+/// and UDP.
+///
+/// The checksum is the ones' complement of the ones' complement sum of the
+/// big-endian 16 bit words of the data, returned in host byte order.
+class InternetChecksumState {
+
+public:
+  using ResultType = uint16_t;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    uint64_t sum {0};
+    for (std::size_t i = 1; i < length; i += 2) {
+      sum += (static_cast<uint32_t>(static_cast<uint8_t>(data[i - 1])) << 8)
+             | static_cast<uint8_t>(data[i]);
+    }
+    if (length % 2 != 0) {
+      sum += static_cast<uint32_t>(static_cast<uint8_t>(data[length - 1])) << 8;
+    }
+    addSum(sum, length);
+  }
+
+  /// \brief Adds the sum of the big-endian 16 bit words of a block.
+  ///
+  /// A trailing odd byte of the block counts as the high byte of a word.
+  /// Blocks following an odd number of bytes are byte-swapped, as their words
+  /// are shifted by one byte (RFC 1071, section 2 (B)).
+  /// \param sum Sum of the words of the block
+  /// \param length Length of the block in bytes
+  constexpr void addSum(uint64_t sum, std::size_t length) {
+    uint32_t folded {foldOnesComplement(sum)};
+    if (Odd) {
+      folded = ((folded & 0xFF) << 8) | (folded >> 8);
+    }
+    Sum = foldOnesComplement(Sum + folded);
+    Odd = Odd != (length % 2 != 0);
+  }
+
+  constexpr ResultType finalize() const {
+    return static_cast<uint16_t>(~Sum);
+  }
+
+private:
+  uint32_t Sum {0};
+  bool Odd {false};
+};
+
+/// \brief Updates an Internet checksum after a 16 bit word of the data
+/// changed, without recalculating it (RFC 1624, equation 3).
+/// \param checksum Checksum of the old data
+/// \param oldWord Old value of the word
+/// \param newWord New value of the word
+/// \return Checksum of the new data
+constexpr uint16_t patchInternetChecksum(uint16_t checksum, uint16_t oldWord,
+                                         uint16_t newWord) {
+  return static_cast<uint16_t>(~foldOnesComplement(
+      uint64_t {static_cast<uint16_t>(~checksum)} + static_cast<uint16_t>(~oldWord) + newWord));
+}
+
+namespace xxh {
+
+constexpr uint32_t Prime32_1 {0x9E3779B1};
+constexpr uint32_t Prime32_2 {0x85EBCA77};
+constexpr uint32_t Prime32_3 {0xC2B2AE3D};
+constexpr uint64_t Prime64_1 {0x9E3779B185EBCA87};
+constexpr uint64_t Prime64_2 {0xC2B2AE3D27D4EB4F};
+constexpr uint64_t Prime64_3 {0x165667B19E3779F9};
+constexpr uint64_t Prime64_4 {0x85EBCA77C2B2AE63};
+constexpr uint64_t Prime64_5 {0x27D4EB2F165667C5};
+
+/// Number of bytes consumed by one accumulation step
+constexpr std::size_t StripeLength {64};
+/// Size of the default secret
+constexpr std::size_t SecretSize {192};
+/// Number of stripes accumulated before the accumulators are scrambled
+constexpr std::size_t StripesPerBlock {(SecretSize - StripeLength) / 8};
+/// Inputs up to this length are hashed without the accumulators
+constexpr std::size_t MidSizeMax {240};
+/// Size of the input buffer of the incremental state
+constexpr std::size_t BufferSize {256};
+
+/// Default secret of XXH3, used for the unseeded hash
+template<typename Unused = void>
+struct DefaultSecret {
+  alignas(64) static constexpr uint8_t Bytes[SecretSize] {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+  };
+};
+
+template<typename Unused>
+alignas(64) constexpr uint8_t DefaultSecret<Unused>::Bytes[SecretSize];
+
+/// \brief Reads a little-endian 32 bit value.
+template<typename Byte>
+constexpr uint32_t read32(const Byte* data) {
+  return static_cast<uint32_t>(static_cast<uint8_t>(data[0]))
+         | (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 8)
+         | (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 16)
+         | (static_cast<uint32_t>(static_cast<uint8_t>(data[3])) << 24);
+}
+
+/// \brief Reads a little-endian 64 bit value.
+template<typename Byte>
+constexpr uint64_t read64(const Byte* data) {
+  return read32(data) | (static_cast<uint64_t>(read32(data + 4)) << 32);
+}
+
+/// Full product of two 64 bit values
+struct Product128 {
+  uint64_t Low;
+  uint64_t High;
+};
+
+/// \brief Multiplies two 64 bit values to their 128 bit product.
+constexpr Product128 mul128(uint64_t lhs, uint64_t rhs) {
+#ifdef __SIZEOF_INT128__
+  __extension__ typedef unsigned __int128 Product;
+  const Product product {static_cast<Product>(lhs) * rhs};
+  return {static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64)};
+#else
+  const uint64_t lowLow {(lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF)};
+  const uint64_t highLow {(lhs >> 32) * (rhs & 0xFFFFFFFF)};
+  const uint64_t lowHigh {(lhs & 0xFFFFFFFF) * (rhs >> 32)};
+  const uint64_t highHigh {(lhs >> 32) * (rhs >> 32)};
+  const uint64_t cross {(lowLow >> 32) + (highLow & 0xFFFFFFFF) + lowHigh};
+  return {(cross << 32) | (lowLow & 0xFFFFFFFF), (highLow >> 32) + (cross >> 32) + highHigh};
+#endif
+}
+
+/// \brief Multiplies two 64 bit values and folds the 128 bit product to
+/// 64 bits.
+constexpr uint64_t mul128Fold64(uint64_t lhs, uint64_t rhs) {
+  const Product128 product {mul128(lhs, rhs)};
+  return product.Low ^ product.High;
+}
+
+constexpr uint64_t rotl64(uint64_t value, unsigned bits) {
+  return (value << bits) | (value >> (64 - bits));
+}
+
+constexpr uint64_t swap64(uint64_t value) {
+  return ((value & 0xFF) << 56) | ((value & 0xFF00) << 40) | ((value & 0xFF0000) << 24)
+         | ((value & 0xFF000000) << 8) | ((value >> 8) & 0xFF000000)
+         | ((value >> 24) & 0xFF0000) | ((value >> 40) & 0xFF00) | (value >> 56);
+}
+
+constexpr uint64_t avalanche(uint64_t hash) {
+  hash ^= hash >> 37;
+  hash *= 0x165667919E3779F9;
+  return hash ^ (hash >> 32);
+}
+
+constexpr uint64_t avalancheXXH64(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= Prime64_2;
+  hash ^= hash >> 29;
+  hash *= Prime64_3;
+  return hash ^ (hash >> 32);
+}
+
+constexpr uint64_t rrmxmx(uint64_t hash, std::size_t length) {
+  hash ^= rotl64(hash, 49) ^ rotl64(hash, 24);
+  hash *= 0x9FB21C651E98DF25;
+  hash ^= (hash >> 35) + length;
+  hash *= 0x9FB21C651E98DF25;
+  return hash ^ (hash >> 28);
+}
+
+template<typename Byte>
+constexpr uint64_t mix16(const Byte* data, const uint8_t* secret) {
+  return mul128Fold64(read64(data) ^ read64(secret), read64(data + 8) ^ read64(secret + 8));
+}
+
+/// \brief Hashes inputs of up to 240 bytes.
+template<typename Byte>
+constexpr uint64_t hashShort(const Byte* data, std::size_t length) {
+  const uint8_t* secret {DefaultSecret<>::Bytes};
+  if (length == 0) {
+    return avalancheXXH64(read64(secret + 56) ^ read64(secret + 64));
+  }
+  if (length <= 3) {
+    const uint32_t combined {(static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 16)
+                             | (static_cast<uint32_t>(static_cast<uint8_t>(data[length >> 1])) << 24)
+                             | static_cast<uint8_t>(data[length - 1])
+                             | static_cast<uint32_t>(length << 8)};
+    return avalancheXXH64(combined ^ static_cast<uint64_t>(read32(secret) ^ read32(secret + 4)));
+  }
+  if (length <= 8) {
+    const uint64_t input {read32(data + length - 4) + (static_cast<uint64_t>(read32(data)) << 32)};
+    return rrmxmx(input ^ (read64(secret + 8) ^ read64(secret + 16)), length);
+  }
+  if (length <= 16) {
+    const uint64_t low {read64(data) ^ read64(secret + 24) ^ read64(secret + 32)};
+    const uint64_t high {read64(data + length - 8) ^ read64(secret + 40) ^ read64(secret + 48)};
+    return avalanche(length + swap64(low) + high + mul128Fold64(low, high));
+  }
+
+  uint64_t hash {length * Prime64_1};
+  if (length <= 128) {
+    if (length > 32) {
+      if (length > 64) {
+        if (length > 96) {
+          hash += mix16(data + 48, secret + 96);
+          hash += mix16(data + length - 64, secret + 112);
+        }
+        hash += mix16(data + 32, secret + 64);
+        hash += mix16(data + length - 48, secret + 80);
+      }
+      hash += mix16(data + 16, secret + 32);
+      hash += mix16(data + length - 32, secret + 48);
+    }
+    hash += mix16(data, secret);
+    hash += mix16(data + length - 16, secret + 16);
+    return avalanche(hash);
+  }
+
+  for (std::size_t i = 0; i < 8; ++i) {
+    hash += mix16(data + 16 * i, secret + 16 * i);
+  }
+  hash = avalanche(hash);
+  for (std::size_t i = 8; i < length / 16; ++i) {
+    hash += mix16(data + 16 * i, secret + 16 * (i - 8) + 3);
+  }
+  // the last 16 bytes use the secret at the minimum secret size minus 17
+  hash += mix16(data + length - 16, secret + 136 - 17);
+  return avalanche(hash);
+}
+
+/// \brief Mixes 32 bytes into both halves of a 128 bit hash.
+template<typename Byte>
+constexpr Product128 mix32(Product128 acc, const Byte* first, const Byte* second,
+                           const uint8_t* secret) {
+  acc.Low += mix16(first, secret);
+  acc.Low ^= read64(second) + read64(second + 8);
+  acc.High += mix16(second, secret + 16);
+  acc.High ^= read64(first) + read64(first + 8);
+  return acc;
+}
+
+/// \brief Hashes inputs of up to 240 bytes to 128 bits.
+template<typename Byte>
+constexpr Digest128 hashShort128(const Byte* data, std::size_t length) {
+  const uint8_t* secret {DefaultSecret<>::Bytes};
+  if (length == 0) {
+    return makeDigest128(avalancheXXH64(read64(secret + 80) ^ read64(secret + 88)),
+                         avalancheXXH64(read64(secret + 64) ^ read64(secret + 72)));
+  }
+  if (length <= 3) {
+    const uint32_t low {(static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 16)
+                        | (static_cast<uint32_t>(static_cast<uint8_t>(data[length >> 1])) << 24)
+                        | static_cast<uint8_t>(data[length - 1])
+                        | static_cast<uint32_t>(length << 8)};
+    const uint32_t swapped {(low >> 24) | ((low >> 8) & 0xFF00) | ((low << 8) & 0xFF0000)
+                            | (low << 24)};
+    const uint32_t high {(swapped << 13) | (swapped >> 19)};
+    return makeDigest128(
+        avalancheXXH64(high ^ static_cast<uint64_t>(read32(secret + 8) ^ read32(secret + 12))),
+        avalancheXXH64(low ^ static_cast<uint64_t>(read32(secret) ^ read32(secret + 4))));
+  }
+  if (length <= 8) {
+    const uint64_t input {read32(data) + (static_cast<uint64_t>(read32(data + length - 4)) << 32)};
+    Product128 product {mul128(input ^ read64(secret + 16) ^ read64(secret + 24),
+                               Prime64_1 + (length << 2))};
+    product.High += product.Low << 1;
+    product.Low ^= product.High >> 3;
+    product.Low ^= product.Low >> 35;
+    product.Low *= 0x9FB21C651E98DF25;
+    product.Low ^= product.Low >> 28;
+    return makeDigest128(avalanche(product.High), product.Low);
+  }
+  if (length <= 16) {
+    const uint64_t low {read64(data)};
+    const uint64_t high {read64(data + length - 8) ^ read64(secret + 48) ^ read64(secret + 56)};
+    Product128 product {mul128(low ^ read64(data + length - 8) ^ read64(secret + 32)
+                               ^ read64(secret + 40), Prime64_1)};
+    product.Low += static_cast<uint64_t>(length - 1) << 54;
+    product.High += high + (high & 0xFFFFFFFF) * (Prime32_2 - 1);
+    product.Low ^= swap64(product.High);
+    Product128 hash {mul128(product.Low, Prime64_2)};
+    hash.High += product.High * Prime64_2;
+    return makeDigest128(avalanche(hash.High), avalanche(hash.Low));
+  }
+
+  Product128 acc {length * Prime64_1, 0};
+  if (length <= 128) {
+    if (length > 32) {
+      if (length > 64) {
+        if (length > 96) {
+          acc = mix32(acc, data + 48, data + length - 64, secret + 96);
+        }
+        acc = mix32(acc, data + 32, data + length - 48, secret + 64);
+      }
+      acc = mix32(acc, data + 16, data + length - 32, secret + 32);
+    }
+    acc = mix32(acc, data, data + length - 16, secret);
+  } else {
+    for (std::size_t i = 0; i < 4; ++i) {
+      acc = mix32(acc, data + 32 * i, data + 32 * i + 16, secret + 32 * i);
+    }
+    acc.Low = avalanche(acc.Low);
+    acc.High = avalanche(acc.High);
+    for (std::size_t i = 4; i < length / 32; ++i) {
+      acc = mix32(acc, data + 32 * i, data + 32 * i + 16, secret + 3 + 32 * (i - 4));
+    }
+    acc = mix32(acc, data + length - 16, data + length - 32, secret + 136 - 17 - 16);
+  }
+  const uint64_t low {acc.Low + acc.High};
+  const uint64_t high {acc.Low * Prime64_1 + acc.High * Prime64_4 + length * Prime64_2};
+  return makeDigest128(0 - avalanche(high), avalanche(low));
+}
+
+/// \brief Merges the accumulators of long inputs to 64 bits.
+constexpr uint64_t mergeAccumulators(const uint64_t (&acc)[8], const uint8_t* secret,
+                                     uint64_t start) {
+  for (std::size_t i = 0; i < 4; ++i) {
+    start += mul128Fold64(acc[2 * i] ^ read64(secret + 16 * i),
+                          acc[2 * i + 1] ^ read64(secret + 16 * i + 8));
+  }
+  return avalanche(start);
+}
+
+// overloads selecting the 64 or 128 bit variant
+
+template<typename Byte>
+constexpr uint64_t hashShort(const Byte* data, std::size_t length, std::false_type) {
+  return hashShort(data, length);
+}
+
+template<typename Byte>
+constexpr Digest128 hashShort(const Byte* data, std::size_t length, std::true_type) {
+  return hashShort128(data, length);
+}
+
+constexpr uint64_t mergeLong(const uint64_t (&acc)[8], uint64_t length, std::false_type) {
+  return mergeAccumulators(acc, DefaultSecret<>::Bytes + 11, length * Prime64_1);
+}
+
+constexpr Digest128 mergeLong(const uint64_t (&acc)[8], uint64_t length, std::true_type) {
+  return makeDigest128(
+      mergeAccumulators(acc, DefaultSecret<>::Bytes + SecretSize - StripeLength - 11,
+                        ~(length * Prime64_2)),
+      mergeAccumulators(acc, DefaultSecret<>::Bytes + 11, length * Prime64_1));
+}
+
+/// Accumulates stripes with portable code, usable in constant expressions
+struct ScalarStripes {
+  /// \brief Accumulates consecutive stripes of the input.
+  /// \param acc Accumulators
+  /// \param data Input of \p count stripes
+  /// \param secret Secret of the first stripe, advanced by 8 bytes per stripe
+  /// \param count Number of stripes
+  template<typename Byte>
+  static constexpr void accumulate(uint64_t (&acc)[8], const Byte* data,
+                                   const uint8_t* secret, std::size_t count) {
+    for (std::size_t stripe = 0; stripe < count; ++stripe) {
+      for (std::size_t i = 0; i < 8; ++i) {
+        const uint64_t value {read64(data + 8 * i)};
+        const uint64_t key {value ^ read64(secret + 8 * i)};
+        acc[i ^ 1] += value;
+        acc[i] += (key & 0xFFFFFFFF) * (key >> 32);
+      }
+      data += StripeLength;
+      secret += 8;
+    }
+  }
+
+  /// \brief Scrambles the accumulators after a block of stripes.
+  static constexpr void scramble(uint64_t (&acc)[8], const uint8_t* secret) {
+    for (std::size_t i = 0; i < 8; ++i) {
+      uint64_t value {acc[i]};
+      value ^= value >> 47;
+      value ^= read64(secret + 8 * i);
+      acc[i] = value * Prime32_1;
+    }
+  }
+};
+
+} // namespace xxh
+
+/// \brief Incremental state of the XXH3 hash with the default secret and a
+/// seed of zero.
+///
+/// Produces the same values as \p XXH3_64bits() and \p XXH3_128bits() of the
+/// xxHash library.
+/// \tparam Stripes Implementation of the stripe accumulation, which may use
+/// SIMD instructions (see xxh::ScalarStripes)
+/// \tparam Wide Whether to produce the 128 bit instead of the 64 bit hash
+template<typename Stripes, bool Wide = false>
+class BasicXXH3State {
+
+public:
+  using ResultType = typename std::conditional<Wide, Digest128, uint64_t>::type;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    TotalLength += length;
+    if (Buffered + length <= xxh::BufferSize) {
+      buffer(data, length);
+      return;
+    }
+    if (Buffered != 0) {
+      const std::size_t fill {xxh::BufferSize - Buffered};
+      buffer(data, fill);
+      data += fill;
+      length -= fill;
+      consume(Accumulators, StripesInBlock, Buffer, xxh::BufferSize / xxh::StripeLength);
+      Buffered = 0;
+    }
+    if (length > xxh::BufferSize) {
+      // the last stripe is kept for finalize(), as it is hashed once more
+      const std::size_t stripes {(length - 1) / xxh::StripeLength};
+      consume(Accumulators, StripesInBlock, data, stripes);
+      data += stripes * xxh::StripeLength;
+      length -= stripes * xxh::StripeLength;
+      for (std::size_t i = 0; i < xxh::StripeLength; ++i) {
+        Buffer[xxh::BufferSize - xxh::StripeLength + i] =
+            static_cast<uint8_t>((data - xxh::StripeLength)[i]);
+      }
+    }
+    buffer(data, length);
+  }
+
+  constexpr ResultType finalize() const {
+    if (TotalLength <= xxh::MidSizeMax) {
+      return xxh::hashShort(Buffer, static_cast<std::size_t>(TotalLength), Width {});
+    }
+
+    const uint8_t* secret {xxh::DefaultSecret<>::Bytes};
+    uint64_t acc[8] {Accumulators[0], Accumulators[1], Accumulators[2], Accumulators[3],
+                     Accumulators[4], Accumulators[5], Accumulators[6], Accumulators[7]};
+    uint8_t lastStripe[xxh::StripeLength] {};
+    if (Buffered >= xxh::StripeLength) {
+      std::size_t stripesInBlock {StripesInBlock};
+      consume(acc, stripesInBlock, Buffer, (Buffered - 1) / xxh::StripeLength);
+      for (std::size_t i = 0; i < xxh::StripeLength; ++i) {
+        lastStripe[i] = Buffer[Buffered - xxh::StripeLength + i];
+      }
+    } else {
+      // the last stripe wraps around to the end of the previous buffer
+      const std::size_t previous {xxh::StripeLength - Buffered};
+      for (std::size_t i = 0; i < previous; ++i) {
+        lastStripe[i] = Buffer[xxh::BufferSize - previous + i];
+      }
+      for (std::size_t i = 0; i < Buffered; ++i) {
+        lastStripe[previous + i] = Buffer[i];
+      }
+    }
+    Stripes::accumulate(acc, lastStripe, secret + xxh::SecretSize - xxh::StripeLength - 7, 1);
+
+    return xxh::mergeLong(acc, TotalLength, Width {});
+  }
+
+private:
+  using Width = std::integral_constant<bool, Wide>;
+
+  template<typename Byte>
+  constexpr void buffer(const Byte* data, std::size_t length) {
+    for (std::size_t i = 0; i < length; ++i) {
+      Buffer[Buffered + i] = static_cast<uint8_t>(data[i]);
+    }
+    Buffered += length;
+  }
+
+  /// \brief Accumulates stripes, scrambling the accumulators after every
+  /// block.
+  template<typename Byte>
+  static constexpr void consume(uint64_t (&acc)[8], std::size_t& stripesInBlock,
+                                const Byte* data, std::size_t stripes) {
+    const uint8_t* secret {xxh::DefaultSecret<>::Bytes};
+    while (stripesInBlock + stripes >= xxh::StripesPerBlock) {
+      const std::size_t count {xxh::StripesPerBlock - stripesInBlock};
+      Stripes::accumulate(acc, data, secret + 8 * stripesInBlock, count);
+      Stripes::scramble(acc, secret + xxh::SecretSize - xxh::StripeLength);
+      data += count * xxh::StripeLength;
+      stripes -= count;
+      stripesInBlock = 0;
+    }
+    Stripes::accumulate(acc, data, secret + 8 * stripesInBlock, stripes);
+    stripesInBlock += stripes;
+  }
+
+  uint64_t Accumulators[8] {xxh::Prime32_3, xxh::Prime64_1, xxh::Prime64_2, xxh::Prime64_3,
+                            xxh::Prime64_4, xxh::Prime32_2, xxh::Prime64_5, xxh::Prime32_1};
+  uint8_t Buffer[xxh::BufferSize] {};
+  std::size_t Buffered {0};
+  std::size_t StripesInBlock {0};
+  uint64_t TotalLength {0};
+};
+
+/// Incremental state of the 64 bit XXH3 hash with portable stripe accumulation
+using XXH3State = BasicXXH3State<xxh::ScalarStripes>;
+/// Incremental state of the 128 bit XXH3 hash with portable stripe accumulation
+using XXH128State = BasicXXH3State<xxh::ScalarStripes, true>;
+
+namespace sha {
+
+/// Round constants of SHA-256
+template<typename Unused = void>
+struct Constants {
+  alignas(64) static constexpr uint32_t K[64] {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+  };
+  static constexpr uint32_t Initial[8] {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+};
+
+template<typename Unused>
+alignas(64) constexpr uint32_t Constants<Unused>::K[64];
+template<typename Unused>
+constexpr uint32_t Constants<Unused>::Initial[8];
+
+/// Size of a block of SHA-256
+constexpr std::size_t BlockSize {64};
+
+constexpr uint32_t rotr(uint32_t value, unsigned bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+/// \brief Reads a big-endian 32 bit value.
+template<typename Byte>
+constexpr uint32_t read32(const Byte* data) {
+  return (static_cast<uint32_t>(static_cast<uint8_t>(data[0])) << 24)
+         | (static_cast<uint32_t>(static_cast<uint8_t>(data[1])) << 16)
+         | (static_cast<uint32_t>(static_cast<uint8_t>(data[2])) << 8)
+         | static_cast<uint8_t>(data[3]);
+}
+
+/// Compresses blocks with portable code, usable in constant expressions
+struct ScalarCompress {
+  /// \brief Compresses consecutive blocks into the hash state.
+  /// \param state Hash state
+  /// \param data Input of \p count blocks
+  /// \param count Number of blocks
+  template<typename Byte>
+  static constexpr void compress(uint32_t (&state)[8], const Byte* data, std::size_t count) {
+    for (; count != 0; --count, data += BlockSize) {
+      uint32_t w[64] {};
+      for (std::size_t t = 0; t < 16; ++t) {
+        w[t] = read32(data + 4 * t);
+      }
+      for (std::size_t t = 16; t < 64; ++t) {
+        const uint32_t s0 {rotr(w[t - 15], 7) ^ rotr(w[t - 15], 18) ^ (w[t - 15] >> 3)};
+        const uint32_t s1 {rotr(w[t - 2], 17) ^ rotr(w[t - 2], 19) ^ (w[t - 2] >> 10)};
+        w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+      }
+
+      uint32_t a {state[0]}, b {state[1]}, c {state[2]}, d {state[3]};
+      uint32_t e {state[4]}, f {state[5]}, g {state[6]}, h {state[7]};
+      for (std::size_t t = 0; t < 64; ++t) {
+        const uint32_t t1 {h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g))
+                           + Constants<>::K[t] + w[t]};
+        const uint32_t t2 {(rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c))};
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+      }
+      state[0] += a;
+      state[1] += b;
+      state[2] += c;
+      state[3] += d;
+      state[4] += e;
+      state[5] += f;
+      state[6] += g;
+      state[7] += h;
+    }
+  }
+};
+
+} // namespace sha
+
+/// \brief Incremental state of the SHA-256 hash (FIPS 180-4).
+/// \tparam Compress Implementation of the block compression, which may use
+/// hardware instructions (see sha::ScalarCompress)
+template<typename Compress>
+class BasicSHA256State {
+
+public:
+  using ResultType = Digest256;
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    Length += length;
+    if (Buffered != 0) {
+      const std::size_t fill {sha::BlockSize - Buffered < length ? sha::BlockSize - Buffered : length};
+      for (std::size_t i = 0; i < fill; ++i) {
+        Buffer[Buffered + i] = static_cast<uint8_t>(data[i]);
+      }
+      Buffered += fill;
+      data += fill;
+      length -= fill;
+      if (Buffered < sha::BlockSize) {
+        return;
+      }
+      Compress::compress(State, Buffer, 1);
+      Buffered = 0;
+    }
+    Compress::compress(State, data, length / sha::BlockSize);
+    data += length / sha::BlockSize * sha::BlockSize;
+    Buffered = length % sha::BlockSize;
+    for (std::size_t i = 0; i < Buffered; ++i) {
+      Buffer[i] = static_cast<uint8_t>(data[i]);
+    }
+  }
+
+  constexpr ResultType finalize() const {
+    uint32_t state[8] {State[0], State[1], State[2], State[3],
+                       State[4], State[5], State[6], State[7]};
+    // padding: a one bit, zeroes and the length in bits in the last 8 bytes
+    uint8_t tail[2 * sha::BlockSize] {};
+    for (std::size_t i = 0; i < Buffered; ++i) {
+      tail[i] = Buffer[i];
+    }
+    tail[Buffered] = 0x80;
+    const std::size_t blocks {Buffered + 9 > sha::BlockSize ? 2u : 1u};
+    const uint64_t bits {Length * 8};
+    for (std::size_t i = 0; i < 8; ++i) {
+      tail[blocks * sha::BlockSize - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    Compress::compress(state, tail, blocks);
+
+    Digest256 digest {};
+    for (std::size_t i = 0; i < 32; ++i) {
+      digest.Bytes[i] = static_cast<uint8_t>(state[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+  }
+
+private:
+  uint32_t State[8] {sha::Constants<>::Initial[0], sha::Constants<>::Initial[1],
+                     sha::Constants<>::Initial[2], sha::Constants<>::Initial[3],
+                     sha::Constants<>::Initial[4], sha::Constants<>::Initial[5],
+                     sha::Constants<>::Initial[6], sha::Constants<>::Initial[7]};
+  uint8_t Buffer[sha::BlockSize] {};
+  std::size_t Buffered {0};
+  uint64_t Length {0};
+};
+
+/// Incremental state of the SHA-256 hash with portable block compression
+using SHA256State = BasicSHA256State<sha::ScalarCompress>;
+
+namespace blake {
+
+/// Constants of BLAKE3
+template<typename Unused = void>
+struct Constants {
+  /// Initial chaining value, the same as the one of SHA-256
+  static constexpr uint32_t IV[8] {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+  /// Order of the message words in each of the seven rounds
+  static constexpr uint8_t Schedule[7][16] {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8},
+    {3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1},
+    {10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6},
+    {12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4},
+    {9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7},
+    {11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13},
+  };
+};
+
+template<typename Unused>
+constexpr uint32_t Constants<Unused>::IV[8];
+template<typename Unused>
+constexpr uint8_t Constants<Unused>::Schedule[7][16];
+
+/// Size of a block, the input of a single compression
+constexpr std::size_t BlockLength {64};
+/// Size of a chunk, the leaves of the hash tree
+constexpr std::size_t ChunkLength {1024};
+/// Maximum number of chunks hashed at once by a chunk kernel
+constexpr std::size_t MaxChunks {16};
+/// Maximum depth of the hash tree, enough for 2^64 bytes
+constexpr std::size_t MaxDepth {54};
+
+/// Domain flags of the compression
+enum Flags : uint32_t {
+  ChunkStart = 1,
+  ChunkEnd = 2,
+  Parent = 4,
+  Root = 8
+};
+
+constexpr uint32_t rotr(uint32_t value, unsigned bits) {
+  return (value >> bits) | (value << (32 - bits));
+}
+
+/// \brief Reads a block of up to 64 bytes as little-endian words, padded
+/// with zeroes.
+template<typename Byte>
+constexpr void loadBlock(const Byte* data, std::size_t length, uint32_t (&block)[16]) {
+  for (std::size_t i = 0; i < 16; ++i) {
+    block[i] = 0;
+  }
+  for (std::size_t i = 0; i < length; ++i) {
+    block[i / 4] |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * (i % 4));
+  }
+}
+
+/// The quarter-round of BLAKE3
+constexpr void mix(uint32_t (&v)[16], std::size_t a, std::size_t b, std::size_t c,
+                   std::size_t d, uint32_t x, uint32_t y) {
+  v[a] += v[b] + x;
+  v[d] = rotr(v[d] ^ v[a], 16);
+  v[c] += v[d];
+  v[b] = rotr(v[b] ^ v[c], 12);
+  v[a] += v[b] + y;
+  v[d] = rotr(v[d] ^ v[a], 8);
+  v[c] += v[d];
+  v[b] = rotr(v[b] ^ v[c], 7);
+}
+
+/// \brief Compresses a block into a chaining value.
+///
+/// Only the first half of the output is computed, which is all that is needed
+/// for 256 bit digests.
+/// \param cv Chaining value, replaced by the output
+/// \param block Message block
+/// \param counter Chunk counter, or 0 for parent nodes and the root
+/// \param length Number of bytes in the block
+/// \param flags Domain flags
+constexpr void compress(uint32_t (&cv)[8], const uint32_t (&block)[16], uint64_t counter,
+                        uint32_t length, uint32_t flags) {
+  uint32_t v[16] {cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                  Constants<>::IV[0], Constants<>::IV[1], Constants<>::IV[2], Constants<>::IV[3],
+                  static_cast<uint32_t>(counter), static_cast<uint32_t>(counter >> 32),
+                  length, flags};
+  for (std::size_t round = 0; round < 7; ++round) {
+    const uint8_t (&s)[16] = Constants<>::Schedule[round];
+    mix(v, 0, 4, 8, 12, block[s[0]], block[s[1]]);
+    mix(v, 1, 5, 9, 13, block[s[2]], block[s[3]]);
+    mix(v, 2, 6, 10, 14, block[s[4]], block[s[5]]);
+    mix(v, 3, 7, 11, 15, block[s[6]], block[s[7]]);
+    mix(v, 0, 5, 10, 15, block[s[8]], block[s[9]]);
+    mix(v, 1, 6, 11, 12, block[s[10]], block[s[11]]);
+    mix(v, 2, 7, 8, 13, block[s[12]], block[s[13]]);
+    mix(v, 3, 4, 9, 14, block[s[14]], block[s[15]]);
+  }
+  for (std::size_t i = 0; i < 8; ++i) {
+    cv[i] = v[i] ^ v[i + 8];
+  }
+}
+
+/// Hashes whole chunks one after another with portable code
+struct ScalarChunks {
+  /// \brief Computes the chaining values of consecutive whole chunks.
+  /// \param data Input of \p count chunks
+  /// \param count Number of chunks, at most MaxChunks
+  /// \param counter Index of the first chunk in the input
+  /// \param cvs Chaining values of the chunks
+  template<typename Byte>
+  static constexpr void hashChunks(const Byte* data, std::size_t count, uint64_t counter,
+                                   uint32_t (*cvs)[8]) {
+    for (std::size_t chunk = 0; chunk < count; ++chunk) {
+      for (std::size_t i = 0; i < 8; ++i) {
+        cvs[chunk][i] = Constants<>::IV[i];
+      }
+      for (std::size_t offset = 0; offset < ChunkLength; offset += BlockLength) {
+        uint32_t block[16] {};
+        loadBlock(data + chunk * ChunkLength + offset, BlockLength, block);
+        const uint32_t flags {(offset == 0 ? ChunkStart : 0u)
+                              | (offset + BlockLength == ChunkLength ? ChunkEnd : 0u)};
+        compress(cvs[chunk], block, counter + chunk, BlockLength, flags);
+      }
+    }
+  }
+};
+
+} // namespace blake
+
+/// \brief Incremental state of the BLAKE3 hash.
+///
+/// The input is split into chunks of 1 KiB, the leaves of a binary hash tree.
+/// Like the reference implementation, the state keeps the chaining values of
+/// completed subtrees on a stack and merges them lazily, so independent parts
+/// of the tree can be hashed by other threads and added with pushSubtree().
+/// \tparam Chunks Kernel hashing whole chunks, which may process several
+/// chunks in parallel (see blake::ScalarChunks)
+template<typename Chunks>
+class BasicBLAKE3State {
+
+public:
+  using ResultType = Digest256;
+
+  constexpr BasicBLAKE3State() = default;
+
+  /// \brief Creates the state of a subtree of a larger input.
+  /// \param firstChunk Index of the first chunk of the subtree in the input,
+  /// a multiple of the number of chunks in the subtree
+  explicit constexpr BasicBLAKE3State(uint64_t firstChunk) : FirstChunk {firstChunk} {}
+
+  template<typename Byte>
+  constexpr void update(const Byte* data, std::size_t length) {
+    static_assert(sizeof(Byte) == 1, "Only byte buffers are supported!");
+    while (length != 0) {
+      if (BlocksDone * blake::BlockLength + BlockFill == blake::ChunkLength) {
+        uint32_t cv[8] {};
+        chunkOutput().chainingValue(cv);
+        push(cv, 1);
+        resetChunk();
+      }
+      if (BlocksDone == 0 && BlockFill == 0 && length > blake::ChunkLength) {
+        // the last chunk might end the input, so it is kept in the state
+        std::size_t count {(length - 1) / blake::ChunkLength};
+        count = count < blake::MaxChunks ? count : blake::MaxChunks;
+        uint32_t cvs[blake::MaxChunks][8] {};
+        Chunks::hashChunks(data, count, FirstChunk + Count, cvs);
+        for (std::size_t i = 0; i < count; ++i) {
+          push(cvs[i], 1);
+        }
+        data += count * blake::ChunkLength;
+        length -= count * blake::ChunkLength;
+        continue;
+      }
+      if (BlockFill == blake::BlockLength) {
+        uint32_t block[16] {};
+        blake::loadBlock(Block, blake::BlockLength, block);
+        blake::compress(ChunkCV, block, FirstChunk + Count, blake::BlockLength,
+                         BlocksDone == 0 ? blake::ChunkStart : 0u);
+        ++BlocksDone;
+        BlockFill = 0;
+      }
+      const std::size_t fill {blake::BlockLength - BlockFill < length
+                              ? blake::BlockLength - BlockFill : length};
+      for (std::size_t i = 0; i < fill; ++i) {
+        Block[BlockFill + i] = static_cast<uint8_t>(data[i]);
+      }
+      BlockFill += fill;
+      data += fill;
+      length -= fill;
+    }
+    if (BlockFill != 0) {
+      // the current chunk has input, so none of the subtrees can be the root
+      mergeStack(Count);
+    }
+  }
+
+  /// \brief Adds the chaining value of a subtree hashed separately.
+  ///
+  /// The subtree must start at the current position, which must be at a
+  /// chunk boundary, and more input must follow it.
+  /// \param cv Chaining value of the subtree (see chainingValue())
+  /// \param chunks Number of chunks in the subtree, a power of two
+  constexpr void pushSubtree(const uint32_t (&cv)[8], uint64_t chunks) {
+    push(cv, chunks);
+  }
+
+  constexpr ResultType finalize() const {
+    const Output output {rootOutput()};
+    uint32_t cv[8] {output.CV[0], output.CV[1], output.CV[2], output.CV[3],
+                    output.CV[4], output.CV[5], output.CV[6], output.CV[7]};
+    blake::compress(cv, output.Block, 0, output.Length, output.Flags | blake::Root);
+    Digest256 digest {};
+    for (std::size_t i = 0; i < 32; ++i) {
+      digest.Bytes[i] = static_cast<uint8_t>(cv[i / 4] >> (8 * (i % 4)));
+    }
+    return digest;
+  }
+
+  /// \brief Returns the chaining value of the input as a subtree of a larger
+  /// input, i.e. without the root flag.
+  /// \param cv Chaining value of the subtree
+  constexpr void chainingValue(uint32_t (&cv)[8]) const {
+    rootOutput().chainingValue(cv);
+  }
+
+private:
+  /// Input of the last compression of a node
+  struct Output {
+    uint32_t CV[8];
+    uint32_t Block[16];
+    uint64_t Counter;
+    uint32_t Length;
+    uint32_t Flags;
+
+    constexpr void chainingValue(uint32_t (&cv)[8]) const {
+      for (std::size_t i = 0; i < 8; ++i) {
+        cv[i] = CV[i];
+      }
+      blake::compress(cv, Block, Counter, Length, Flags);
+    }
+  };
+
+  constexpr Output chunkOutput() const {
+    Output output {};
+    for (std::size_t i = 0; i < 8; ++i) {
+      output.CV[i] = ChunkCV[i];
+    }
+    blake::loadBlock(Block, BlockFill, output.Block);
+    output.Counter = FirstChunk + Count;
+    output.Length = static_cast<uint32_t>(BlockFill);
+    output.Flags = blake::ChunkEnd | (BlocksDone == 0 ? blake::ChunkStart : 0u);
+    return output;
+  }
+
+  static constexpr Output parentOutput(const uint32_t (&left)[8], const uint32_t (&right)[8]) {
+    Output output {};
+    for (std::size_t i = 0; i < 8; ++i) {
+      output.CV[i] = blake::Constants<>::IV[i];
+      output.Block[i] = left[i];
+      output.Block[i + 8] = right[i];
+    }
+    output.Length = blake::BlockLength;
+    output.Flags = blake::Parent;
+    return output;
+  }
+
+  /// Returns the output of the root node, folding the stack from the right
+  constexpr Output rootOutput() const {
+    std::size_t remaining {StackSize};
+    Output output {};
+    if (BlockFill != 0 || StackSize == 0) {
+      output = chunkOutput();
+    } else {
+      output = parentOutput(Stack[StackSize - 2], Stack[StackSize - 1]);
+      remaining -= 2;
+    }
+    while (remaining != 0) {
+      uint32_t cv[8] {};
+      output.chainingValue(cv);
+      output = parentOutput(Stack[--remaining], cv);
+    }
+    return output;
+  }
+
+  /// \brief Merges completed subtrees until the stack holds one entry per set
+  /// bit of the number of chunks.
+  constexpr void mergeStack(uint64_t chunks) {
+    std::size_t bits {0};
+    for (; chunks != 0; chunks &= chunks - 1) {
+      ++bits;
+    }
+    while (StackSize > bits) {
+      parentOutput(Stack[StackSize - 2], Stack[StackSize - 1]).chainingValue(Stack[StackSize - 2]);
+      --StackSize;
+    }
+  }
+
+  constexpr void push(const uint32_t (&cv)[8], uint64_t chunks) {
+    mergeStack(Count);
+    for (std::size_t i = 0; i < 8; ++i) {
+      Stack[StackSize][i] = cv[i];
+    }
+    ++StackSize;
+    Count += chunks;
+  }
+
+  constexpr void resetChunk() {
+    for (std::size_t i = 0; i < 8; ++i) {
+      ChunkCV[i] = blake::Constants<>::IV[i];
+    }
+    BlocksDone = 0;
+    BlockFill = 0;
+  }
+
+  /// Chaining values of completed subtrees, ordered from left to right
+  uint32_t Stack[blake::MaxDepth + 1][8] {};
+  std::size_t StackSize {0};
+  /// Index of the first chunk of the input
+  uint64_t FirstChunk {0};
+  /// Number of chunks on the stack
+  uint64_t Count {0};
+  uint32_t ChunkCV[8] {blake::Constants<>::IV[0], blake::Constants<>::IV[1],
+                       blake::Constants<>::IV[2], blake::Constants<>::IV[3],
+                       blake::Constants<>::IV[4], blake::Constants<>::IV[5],
+                       blake::Constants<>::IV[6], blake::Constants<>::IV[7]};
+  uint8_t Block[blake::BlockLength] {};
+  std::size_t BlockFill {0};
+  std::size_t BlocksDone {0};
+};
+
+/// Incremental state of the BLAKE3 hash with portable chunk hashing
+using BLAKE3State = BasicBLAKE3State<blake::ScalarChunks>;
+
+/// \brief Computes a checksum of a single buffer with the given state type.
+/// \tparam State State type of the algorithm
+/// \param data Pointer to the first byte of the buffer
+/// \param length Number of bytes in the buffer
+/// \return Checksum of the buffer
+template<typename State, typename Byte>
+constexpr typename State::ResultType compute(const Byte* data, std::size_t length) {
+  State state {};
+  state.update(data, length);
+  return state.finalize();
+}
+
+/// \brief Calculates the Adler32 checksum of a buffer.
+template<typename Byte>
+constexpr uint32_t adler32(const Byte* data, std::size_t length) {
+  return compute<Adler32State>(data, length);
+}
+
+/// \brief Calculates the Fletcher16 checksum of a buffer.
+template<typename Byte>
+constexpr uint16_t fletcher16(const Byte* data, std::size_t length) {
+  return compute<Fletcher16State>(data, length);
+}
+
+/// \brief Calculates the Fletcher32 checksum of a buffer.
+template<typename Byte>
+constexpr uint32_t fletcher32(const Byte* data, std::size_t length) {
+  return compute<Fletcher32State>(data, length);
+}
+
+/// \brief Calculates the 8 bit checksum of a buffer.
+template<typename Byte>
+constexpr uint8_t sum8(const Byte* data, std::size_t length) {
+  return compute<Sum8State>(data, length);
+}
+
+/// \brief Calculates the 16 bit checksum of a buffer.
+template<typename Byte>
+constexpr uint16_t sum16(const Byte* data, std::size_t length) {
+  return compute<Sum16State>(data, length);
+}
+
+/// \brief Calculates the 32 bit checksum of a buffer.
+template<typename Byte>
+constexpr uint32_t sum32(const Byte* data, std::size_t length) {
+  return compute<Sum32State>(data, length);
+}
+
+/// \brief Calculates the 16 bit BSD sum of a buffer.
+template<typename Byte>
+constexpr uint16_t bsdSum(const Byte* data, std::size_t length) {
+  return compute<BSDSumState>(data, length);
+}
+
+/// \brief Calculates the XOR8 checksum of a buffer.
+template<typename Byte>
+constexpr uint8_t xor8(const Byte* data, std::size_t length) {
+  return compute<XOR8State>(data, length);
+}
+
+/// \brief Calculates the SYSV checksum of a buffer.
+template<typename Byte>
+constexpr uint32_t sysv(const Byte* data, std::size_t length) {
+  return compute<SYSVState>(data, length);
+}
+
+/// \brief Calculates the CRC of the GNU coreutil cksum of a buffer.
+template<typename Byte>
+constexpr uint32_t cksum(const Byte* data, std::size_t length) {
+  return compute<CksumState>(data, length);
+}
+
+/// \brief Calculates the CRC-32 of a buffer.
+template<typename Byte>
+constexpr uint32_t crc32(const Byte* data, std::size_t length) {
+  return compute<CRC32State>(data, length);
+}
+
+/// \brief Calculates the CRC-32C of a buffer.
+template<typename Byte>
+constexpr uint32_t crc32c(const Byte* data, std::size_t length) {
+  return compute<CRC32CState>(data, length);
+}
+
+/// \brief Calculates the CRC-32/BZIP2 of a buffer.
+template<typename Byte>
+constexpr uint32_t crc32bzip2(const Byte* data, std::size_t length) {
+  return compute<CRC32BZIP2State>(data, length);
+}
+
+/// \brief Calculates the Internet checksum of a buffer.
+template<typename Byte>
+constexpr uint16_t internetChecksum(const Byte* data, std::size_t length) {
+  return compute<InternetChecksumState>(data, length);
+}
+
+/// \brief Calculates the 64 bit XXH3 hash of a buffer.
+template<typename Byte>
+constexpr uint64_t xxh3(const Byte* data, std::size_t length) {
+  return compute<XXH3State>(data, length);
+}
+
+/// \brief Calculates the 128 bit XXH3 hash of a buffer.
+template<typename Byte>
+constexpr Digest128 xxh128(const Byte* data, std::size_t length) {
+  return compute<XXH128State>(data, length);
+}
+
+/// \brief Calculates the SHA-256 hash of a buffer.
+template<typename Byte>
+constexpr Digest256 sha256(const Byte* data, std::size_t length) {
+  return compute<SHA256State>(data, length);
+}
+
+/// \brief Calculates the BLAKE3 hash of a buffer.
+template<typename Byte>
+constexpr Digest256 blake3(const Byte* data, std::size_t length) {
+  return compute<BLAKE3State>(data, length);
+}
+
+} // namespace kernel
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_KERNELS_H
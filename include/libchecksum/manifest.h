@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring manifest verification
+ *
+ * This header file declares functions for verifying manifests, i.e. text
+ * files listing checksums of files in the format "checksum  path".
+ */
+
+#ifndef CHECKSUM_MANIFEST_H
+#define CHECKSUM_MANIFEST_H
+
+#include <libchecksum/common.h>
+#include <libchecksum/file.h>
+
+#include <functional>
+
+namespace libchecksum {
+
+/// A single line of a manifest
+struct ManifestEntry {
+  /// Expected checksum in hexadecimal format
+  std::string Checksum;
+  /// Path of the file
+  std::string Path;
+  /// Line number in the manifest, starting at 1
+  std::size_t Line;
+};
+
+/// Result of verifying a single manifest entry
+struct ManifestResult {
+  /// Outcome of the verification
+  enum class Status {
+    Ok,
+    Mismatch,
+    Unreadable
+  };
+
+  Status State;
+  /// The verified entry
+  const ManifestEntry& Entry;
+  /// Actual checksum in hexadecimal format, empty if the file was unreadable
+  std::string Actual;
+  /// Error message if the file was unreadable
+  std::string Error;
+};
+
+/// Options for manifest verification
+struct ManifestOptions {
+  /// Number of threads verifying files, 0 for one per hardware thread
+  unsigned Threads {0};
+  /// Verify files in the order of their physical location on disk instead of
+  /// the order of the manifest
+  bool OrderByLocation {true};
+  /// Report matching files to the callback as well, not only failures
+  bool ReportMatches {false};
+};
+
+/// Summary of a manifest verification
+struct ManifestSummary {
+  std::size_t Entries {0};
+  std::size_t Matched {0};
+  std::size_t Mismatched {0};
+  std::size_t Unreadable {0};
+  /// Number of non-empty lines not in the format "checksum  path"
+  std::size_t Malformed {0};
+};
+
+/// \brief Callback receiving verification results as soon as they are
+/// available.
+///
+/// Calls are serialized, so the callback does not need to be thread-safe. It
+/// is called from worker threads and must not throw.
+using ManifestCallback = std::function<void(const ManifestResult&)>;
+
+/// \brief Parses the lines of a manifest.
+///
+/// Every line has the format "checksum  path" as written by \p sha256sum and
+/// similar tools, a '*' instead of the second space marks binary mode and is
+/// accepted as well.
+/// \param data Contents of the manifest
+/// \param length Length of the manifest in bytes
+/// \param malformed Incremented for every line not in the expected format
+/// \return The parsed entries in the order of the manifest
+std::vector<ManifestEntry> parseManifest(const uint8_t* data, std::size_t length,
+                                         std::size_t& malformed);
+
+namespace detail {
+
+/// Function calculating the hexadecimal checksum of a file's contents
+using HexFunction = std::function<std::string(const uint8_t*, std::size_t)>;
+
+/// Format of the hexadecimal checksums of an algorithm
+struct HexFormat {
+  /// Number of hexadecimal digits of the checksum type
+  std::size_t Digits;
+  /// Whether leading zeroes are omitted, as by util::toHexString() for
+  /// integral checksums
+  bool Unpadded;
+};
+
+ManifestSummary verifyManifest(const std::string& path, const HexFunction& hex,
+                               const HexFormat& format,
+                               const ManifestCallback& callback,
+                               const ManifestOptions& options);
+
+} // namespace detail
+
+/// \brief Verifies all files listed in a manifest.
+///
+/// The manifest is memory-mapped and all entries are verified in parallel.
+/// Checksums are compared case-insensitively. Expected checksums must have
+/// the number of digits of the checksum type, except that leading zeroes may
+/// be omitted for integral checksums, whose hexadecimal format omits them.
+/// Errors reading the manifest itself are reported as \p std::system_error.
+/// \tparam T Type of the checksum
+/// \param algorithm Checksum algorithm the manifest was created with
+/// \param path Path of the manifest
+/// \param callback Function receiving failed (and optionally matching) entries
+/// \param options Options of the verification
+/// \return Summary of the verification
+template<typename T>
+ManifestSummary verifyManifest(const ChecksumAlgorithm<T>& algorithm,
+                               const std::string& path,
+                               const ManifestCallback& callback,
+                               const ManifestOptions& options = {}) {
+  return detail::verifyManifest(path, [&algorithm](const uint8_t* data, std::size_t length) {
+    return algorithm.getHex(data, length);
+  }, {2 * sizeof(T), std::is_integral<T>::value}, callback, options);
+}
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_MANIFEST_H
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring the algorithm registry
+ *
+ * This header file declares the registry, which resolves algorithm names to
+ * instances at runtime and describes the capabilities of every algorithm and
+ * the kernel tier it runs on this CPU.
+ */
+
+#ifndef CHECKSUM_REGISTRY_H
+#define CHECKSUM_REGISTRY_H
+
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+
+#include <stdexcept>
+
+namespace libchecksum {
+
+/// Capabilities of an algorithm
+struct AlgorithmInfo {
+  /// Identifier of the algorithm
+  AlgorithmId Id;
+  /// Lower-case name of the algorithm, e.g. "crc32"
+  const char* Name;
+  /// Number of bits of the checksum type
+  std::size_t OutputBits;
+  /// Whether the states of consecutive pieces can be combined, so the pieces
+  /// can be summed independently (see Adler32State::combine)
+  bool Combinable;
+  /// Whether a single large input can be spread over several threads
+  bool Parallel;
+  /// Whether the checksum can be calculated incrementally by a stream
+  bool Streamable;
+  /// Whether a state can slide a window over the data byte by byte (see
+  /// Adler32State::roll)
+  bool Rolling;
+  /// Widest kernel tier the algorithm uses for large inputs on this CPU
+  KernelTier Tier;
+};
+
+/// \brief Stream of an algorithm created by name.
+///
+/// The type of the checksum is erased, so it is only available in
+/// hexadecimal format.
+class AnyChecksumStream {
+
+public:
+  /// \brief Default virtual destructor
+  virtual ~AnyChecksumStream() = default;
+
+  /// \brief Feeds a raw memory buffer into the checksum.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  virtual void update(const uint8_t* data, std::size_t length) = 0;
+
+  /// \brief Feeds a string into the checksum.
+  /// \param input String to feed
+  void update(const std::string& input) {
+    update(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  /// \brief Returns the checksum of all data fed so far in hexadecimal
+  /// format.
+  /// \return Checksum of the data as hexadecimal string
+  virtual std::string getHex() const = 0;
+
+  /// \brief Resets the stream to its initial state.
+  virtual void reset() = 0;
+};
+
+/// \brief Algorithm created by name.
+///
+/// The type of the checksum is erased, so it is only available in
+/// hexadecimal format, which is the same as ChecksumAlgorithm::getHex()
+/// gives. Code that needs the typed checksum uses registry::visit() instead.
+class AnyChecksumAlgorithm {
+
+public:
+  /// \brief Default virtual destructor
+  virtual ~AnyChecksumAlgorithm() = default;
+
+  /// \brief Returns the capabilities of the algorithm.
+  /// \return Capabilities of the algorithm
+  virtual const AlgorithmInfo& getInfo() const = 0;
+
+  /// \brief Calculates the checksum of a raw memory buffer and returns it in
+  /// hexadecimal format.
+  /// \param data Pointer to the first byte of the buffer
+  /// \param length Number of bytes in the buffer
+  /// \return Checksum of the buffer as hexadecimal string
+  virtual std::string getHex(const uint8_t* data, std::size_t length) const = 0;
+
+  /// \brief Calculates the checksum of a string and returns it in hexadecimal
+  /// format.
+  /// \param input String to get the checksum of
+  /// \return Checksum of the string as hexadecimal string
+  std::string getHex(const std::string& input) const {
+    return getHex(reinterpret_cast<const uint8_t*>(input.data()), input.size());
+  }
+
+  /// \brief Creates a stream for calculating the checksum incrementally.
+  /// \return New stream in its initial state
+  virtual std::unique_ptr<AnyChecksumStream> createStream() const = 0;
+};
+
+namespace detail {
+
+/// Tag passing an algorithm type to the factories of registry::visit()
+template<typename Algorithm>
+struct AlgorithmType {};
+
+/// Creates algorithms with their default arguments
+struct DefaultFactory {
+  template<typename Algorithm>
+  Algorithm operator()(AlgorithmType<Algorithm>) const {
+    return Algorithm {};
+  }
+};
+
+/// Creates algorithms with a number of threads, if they take one
+struct ThreadFactory {
+  unsigned Threads;
+
+  template<typename Algorithm>
+  Algorithm operator()(AlgorithmType<Algorithm>) const {
+    return create<Algorithm>(std::is_constructible<Algorithm, unsigned> {});
+  }
+
+private:
+  template<typename Algorithm>
+  Algorithm create(std::true_type) const {
+    return Algorithm {Threads};
+  }
+
+  template<typename Algorithm>
+  Algorithm create(std::false_type) const {
+    return Algorithm {};
+  }
+};
+
+/// \brief Calls a visitor with the algorithm of an identifier.
+template<typename Factory, typename Visitor>
+decltype(auto) visitAlgorithm(AlgorithmId id, const Factory& factory, Visitor&& visitor) {
+  switch (id) {
+    case AlgorithmId::Adler32: return visitor(factory(AlgorithmType<Adler32> {}));
+    case AlgorithmId::Fletcher16: return visitor(factory(AlgorithmType<Fletcher16> {}));
+    case AlgorithmId::Fletcher32: return visitor(factory(AlgorithmType<Fletcher32> {}));
+    case AlgorithmId::Sum8: return visitor(factory(AlgorithmType<Sum8> {}));
+    case AlgorithmId::Sum16: return visitor(factory(AlgorithmType<Sum16> {}));
+    case AlgorithmId::Sum32: return visitor(factory(AlgorithmType<Sum32> {}));
+    case AlgorithmId::BSDSum: return visitor(factory(AlgorithmType<BSDSum> {}));
+    case AlgorithmId::XOR8: return visitor(factory(AlgorithmType<XOR8> {}));
+    case AlgorithmId::SYSV: return visitor(factory(AlgorithmType<SYSV> {}));
+    case AlgorithmId::Cksum: return visitor(factory(AlgorithmType<Cksum> {}));
+    case AlgorithmId::CRC32: return visitor(factory(AlgorithmType<CRC32> {}));
+    case AlgorithmId::CRC32C: return visitor(factory(AlgorithmType<CRC32C> {}));
+    case AlgorithmId::InternetChecksum: return visitor(factory(AlgorithmType<InternetChecksum> {}));
+    case AlgorithmId::XXH3: return visitor(factory(AlgorithmType<XXH3> {}));
+    case AlgorithmId::XXH128: return visitor(factory(AlgorithmType<XXH128> {}));
+    case AlgorithmId::SHA256: return visitor(factory(AlgorithmType<SHA256> {}));
+    case AlgorithmId::BLAKE3: return visitor(factory(AlgorithmType<BLAKE3> {}));
+    case AlgorithmId::CRC32BZIP2: return visitor(factory(AlgorithmType<CRC32BZIP2> {}));
+  }
+  throw std::invalid_argument {"Unknown algorithm identifier"};
+}
+
+} // namespace detail
+
+namespace registry {
+
+/// \brief Returns the capabilities of all algorithms.
+/// \return Capabilities indexed by AlgorithmId
+const std::vector<AlgorithmInfo>& getAlgorithms();
+
+/// \brief Returns the capabilities of an algorithm.
+/// \param id Identifier of the algorithm
+/// \return Capabilities of the algorithm
+const AlgorithmInfo& getInfo(AlgorithmId id);
+
+/// \brief Looks up an algorithm by name.
+///
+/// Names are matched without regard to case, dashes and underscores, so
+/// "CRC-32C" finds CRC32C. Besides the names of AlgorithmInfo, "bsd" and
+/// "internet" are accepted.
+/// \param name Name of the algorithm
+/// \return Capabilities of the algorithm or \p nullptr if the name is unknown
+const AlgorithmInfo* find(const std::string& name);
+
+/// \brief Creates an algorithm by name with its default arguments.
+/// \param name Name of the algorithm (see find())
+/// \return The algorithm
+/// \throws std::invalid_argument if the name is unknown
+std::unique_ptr<AnyChecksumAlgorithm> create(const std::string& name);
+
+/// \brief Creates an algorithm by name.
+/// \param name Name of the algorithm (see find())
+/// \param threads Maximum number of threads calculating the checksum of a
+/// single large input, 0 for the number of hardware threads; ignored by
+/// algorithms that are not AlgorithmInfo::Parallel
+/// \return The algorithm
+/// \throws std::invalid_argument if the name is unknown
+std::unique_ptr<AnyChecksumAlgorithm> create(const std::string& name, unsigned threads);
+
+/// \brief Calls a visitor with the algorithm of an identifier, created with
+/// its default arguments.
+///
+/// The visitor is called with the concrete algorithm class, so generic code
+/// can use the typed checksum and the static interface of the algorithm:
+/// \code
+/// registry::visit(registry::find("crc32")->Id, [&](const auto& algorithm) {
+///   return algorithm(data) == expected;
+/// });
+/// \endcode
+/// \param id Identifier of the algorithm
+/// \param visitor Callable taking every algorithm class and returning the
+/// same type for all of them
+/// \return Result of the visitor
+template<typename Visitor>
+decltype(auto) visit(AlgorithmId id, Visitor&& visitor) {
+  return detail::visitAlgorithm(id, detail::DefaultFactory {}, std::forward<Visitor>(visitor));
+}
+
+/// \brief Calls a visitor with the algorithm of an identifier, created with
+/// a number of threads.
+/// \param id Identifier of the algorithm
+/// \param threads Maximum number of threads calculating the checksum of a
+/// single large input (see create())
+/// \param visitor Callable taking every algorithm class and returning the
+/// same type for all of them
+/// \return Result of the visitor
+template<typename Visitor>
+decltype(auto) visit(AlgorithmId id, unsigned threads, Visitor&& visitor) {
+  return detail::visitAlgorithm(id, detail::ThreadFactory {threads}, std::forward<Visitor>(visitor));
+}
+
+} // namespace registry
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_REGISTRY_H
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Header file of \p libchecksum declaring non-contiguous inputs
+ *
+ * This header file declares functions for calculating checksums of data that
+ * is scattered over several segments or laid out in padded rows, without
+ * copying it into a contiguous buffer first.
+ */
+
+#ifndef CHECKSUM_SEGMENTS_H
+#define CHECKSUM_SEGMENTS_H
+
+#include <libchecksum/common.h>
+
+#include <sys/uio.h>
+
+namespace libchecksum {
+
+/// Description of a pitched two-dimensional buffer, like an image frame
+/// whose rows are padded
+struct StridedBuffer {
+  /// Pointer to the first byte of the first row
+  const uint8_t* Base;
+  /// Number of bytes of each row that belong to the data
+  std::size_t RowLength;
+  /// Distance in bytes between the first bytes of two consecutive rows
+  std::size_t Pitch;
+  /// Number of rows
+  std::size_t Rows;
+};
+
+/// \brief Calculates the checksum of scattered segments as if they were one
+/// contiguous buffer.
+///
+/// Segments that directly follow each other in memory are passed to the
+/// algorithm together. Other segments are added to a stream, which carries
+/// the state across the segment boundaries.
+/// \tparam T Type of the checksum
+/// \param algorithm Checksum algorithm to use
+/// \param segments Segments of the data in order, e.g. of a packet
+/// \param count Number of segments
+/// \return Checksum of the concatenated segments
+template<typename T>
+T checksumSegments(const ChecksumAlgorithm<T>& algorithm, const iovec* segments,
+                   std::size_t count) {
+  std::unique_ptr<ChecksumStream<T>> stream {};
+  const uint8_t* run {nullptr};
+  std::size_t runLength {0};
+  for (std::size_t i = 0; i < count; ++i) {
+    const uint8_t* data {static_cast<const uint8_t*>(segments[i].iov_base)};
+    if (segments[i].iov_len == 0) {
+      continue;
+    }
+    if (run != nullptr && run + runLength == data) {
+      runLength += segments[i].iov_len;
+      continue;
+    }
+    if (run != nullptr) {
+      if (!stream) {
+        stream = algorithm.createStream();
+      }
+      stream->update(run, runLength);
+    }
+    run = data;
+    runLength = segments[i].iov_len;
+  }
+  if (!stream) {
+    // the data is a single contiguous run or empty
+    return algorithm(run, runLength);
+  }
+  stream->update(run, runLength);
+  return stream->finalize();
+}
+
+/// \brief Calculates the checksum of the rows of a pitched buffer as if they
+/// were one contiguous buffer, leaving out the padding between the rows.
+/// \tparam T Type of the checksum
+/// \param algorithm Checksum algorithm to use
+/// \param buffer Description of the rows
+/// \return Checksum of the concatenated rows
+template<typename T>
+T checksumStrided(const ChecksumAlgorithm<T>& algorithm, const StridedBuffer& buffer) {
+  if (buffer.Rows <= 1 || buffer.Pitch == buffer.RowLength) {
+    return algorithm(buffer.Base, buffer.Rows * buffer.RowLength);
+  }
+  const auto stream = algorithm.createStream();
+  for (std::size_t row = 0; row < buffer.Rows; ++row) {
+    stream->update(buffer.Base + row * buffer.Pitch, buffer.RowLength);
+  }
+  return stream->finalize();
+}
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_SEGMENTS_H
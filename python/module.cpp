@@ -0,0 +1,570 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Python bindings of \p libchecksum
+ *
+ * This source file implements the Python extension module \p libchecksum,
+ * which exposes the algorithms of the library as Python types. Inputs are
+ * taken through the buffer protocol without copying, and the GIL is released
+ * while large inputs are processed, so threads calculate checksums in
+ * parallel.
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+using namespace libchecksum;
+
+namespace {
+
+/// Smallest input for which the GIL is released; for smaller inputs,
+/// releasing and taking it again costs more than the calculation
+constexpr std::size_t MinUnlockedLength {2048};
+
+/// \brief Calls a function and releases the GIL meanwhile if the input is
+/// large enough.
+///
+/// Exceptions of the function are rethrown once the GIL is held again.
+/// \param length Number of bytes the function processes
+/// \param function Function that must not call the Python API
+template<typename Function>
+void runUnlocked(std::size_t length, const Function& function) {
+  if (length < MinUnlockedLength) {
+    function();
+    return;
+  }
+  std::exception_ptr error {};
+  Py_BEGIN_ALLOW_THREADS
+  try {
+    function();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  Py_END_ALLOW_THREADS
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+/// \brief Sets the Python exception for the C++ exception being handled.
+/// \return nullptr, to be returned to Python
+PyObject* raiseCurrentException() {
+  try {
+    throw;
+  } catch (const std::bad_alloc&) {
+    PyErr_NoMemory();
+  } catch (const std::exception& error) {
+    PyErr_SetString(PyExc_RuntimeError, error.what());
+  }
+  return nullptr;
+}
+
+/// Buffers exported by Python objects, which are released together
+class Buffers final {
+
+public:
+  explicit Buffers(std::size_t count) {
+    Views.reserve(count);
+  }
+
+  Buffers(const Buffers&) = delete;
+  Buffers& operator=(const Buffers&) = delete;
+
+  ~Buffers() {
+    for (Py_buffer& view : Views) {
+      PyBuffer_Release(&view);
+    }
+  }
+
+  /// \brief Gets the contiguous bytes of an object.
+  /// \return False with a Python exception set if the object does not
+  /// export a contiguous buffer
+  bool add(PyObject* object) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(object, &view, PyBUF_SIMPLE) != 0) {
+      return false;
+    }
+    Views.push_back(view);
+    return true;
+  }
+
+  std::size_t count() const {
+    return Views.size();
+  }
+
+  const uint8_t* data(std::size_t index) const {
+    return static_cast<const uint8_t*>(Views[index].buf);
+  }
+
+  std::size_t length(std::size_t index) const {
+    return static_cast<std::size_t>(Views[index].len);
+  }
+
+private:
+  std::vector<Py_buffer> Views;
+};
+
+/// \brief Converts an integral checksum to a Python integer.
+template<typename T>
+PyObject* toPython(T value) {
+  static_assert(std::is_integral<T>::value, "Only integral checksums are supported!");
+  return PyLong_FromUnsignedLongLong(value);
+}
+
+/// \brief Converts a digest to Python bytes.
+template<std::size_t N>
+PyObject* toPython(const Digest<N>& digest) {
+  return PyBytes_FromStringAndSize(reinterpret_cast<const char*>(digest.Bytes), N);
+}
+
+/// \brief Converts a string to a Python string.
+PyObject* toPython(const std::string& value) {
+  return PyUnicode_FromStringAndSize(value.data(), static_cast<Py_ssize_t>(value.size()));
+}
+
+/// Stream of an algorithm with the type of its checksum erased
+class StreamBinding {
+
+public:
+  virtual ~StreamBinding() = default;
+  virtual void update(const uint8_t* data, std::size_t length) = 0;
+  virtual PyObject* finalize() const = 0;
+  virtual PyObject* getHex() const = 0;
+  virtual void reset() = 0;
+
+  /// \brief Returns the mutex serializing the calls of Python threads,
+  /// which may update the stream without holding the GIL.
+  std::mutex& mutex() {
+    return Mutex;
+  }
+
+private:
+  std::mutex Mutex {};
+};
+
+template<typename T>
+class TypedStream final : public StreamBinding {
+
+public:
+  explicit TypedStream(std::unique_ptr<ChecksumStream<T>> stream) : Stream {std::move(stream)} {}
+
+  void update(const uint8_t* data, std::size_t length) override {
+    Stream->update(data, length);
+  }
+
+  PyObject* finalize() const override {
+    return toPython(Stream->finalize());
+  }
+
+  PyObject* getHex() const override {
+    return toPython(Stream->getHex());
+  }
+
+  void reset() override {
+    Stream->reset();
+  }
+
+private:
+  std::unique_ptr<ChecksumStream<T>> Stream;
+};
+
+/// Algorithm with the type of its checksum erased
+class AlgorithmBinding {
+
+public:
+  virtual ~AlgorithmBinding() = default;
+  virtual PyObject* compute(const uint8_t* data, std::size_t length) const = 0;
+  virtual PyObject* getHex(const uint8_t* data, std::size_t length) const = 0;
+  virtual PyObject* computeBatch(const Buffers& buffers) const = 0;
+  virtual std::unique_ptr<StreamBinding> createStream() const = 0;
+};
+
+template<typename T>
+class TypedAlgorithm final : public AlgorithmBinding {
+
+public:
+  explicit TypedAlgorithm(std::unique_ptr<ChecksumAlgorithm<T>> algorithm)
+    : Algorithm {std::move(algorithm)} {}
+
+  PyObject* compute(const uint8_t* data, std::size_t length) const override {
+    T result {};
+    runUnlocked(length, [&]() {
+      result = (*Algorithm)(data, length);
+    });
+    return toPython(result);
+  }
+
+  PyObject* getHex(const uint8_t* data, std::size_t length) const override {
+    std::string result {};
+    runUnlocked(length, [&]() {
+      result = Algorithm->getHex(data, length);
+    });
+    return toPython(result);
+  }
+
+  PyObject* computeBatch(const Buffers& buffers) const override {
+    const std::size_t count {buffers.count()};
+    std::vector<const uint8_t*> data(count);
+    std::vector<std::size_t> lengths(count);
+    std::vector<T> results(count);
+    std::size_t total {0};
+    for (std::size_t i = 0; i < count; ++i) {
+      data[i] = buffers.data(i);
+      lengths[i] = buffers.length(i);
+      total += lengths[i];
+    }
+    runUnlocked(total, [&]() {
+      Algorithm->computeBatch(data.data(), lengths.data(), count, results.data());
+    });
+
+    PyObject* list {PyList_New(static_cast<Py_ssize_t>(count))};
+    for (std::size_t i = 0; list != nullptr && i < count; ++i) {
+      PyObject* item {toPython(results[i])};
+      if (item == nullptr) {
+        Py_CLEAR(list);
+        break;
+      }
+      PyList_SET_ITEM(list, static_cast<Py_ssize_t>(i), item);
+    }
+    return list;
+  }
+
+  std::unique_ptr<StreamBinding> createStream() const override {
+    return std::make_unique<TypedStream<T>>(Algorithm->createStream());
+  }
+
+private:
+  std::unique_ptr<ChecksumAlgorithm<T>> Algorithm;
+};
+
+/// Python object of an algorithm
+struct AlgorithmObject {
+  PyObject_HEAD
+  AlgorithmBinding* Binding;
+};
+
+/// Python object of a stream
+struct StreamObject {
+  PyObject_HEAD
+  StreamBinding* Binding;
+};
+
+/// Type of the Python stream objects, created when the module is loaded
+PyTypeObject* StreamType {nullptr};
+
+/// \brief Frees a Python object of a heap type and its binding.
+template<typename Object>
+void deallocate(PyObject* self) {
+  delete reinterpret_cast<Object*>(self)->Binding;
+  PyTypeObject* type {Py_TYPE(self)};
+  type->tp_free(self);
+  Py_DECREF(type);
+}
+
+/// \brief Gets the only argument of a call as contiguous bytes.
+/// \return False with a Python exception set on failure
+bool parseBuffer(PyObject* args, Buffers& buffers) {
+  PyObject* object {nullptr};
+  return PyArg_UnpackTuple(args, "data", 1, 1, &object) != 0 && buffers.add(object);
+}
+
+PyObject* callAlgorithm(PyObject* self, PyObject* args, PyObject* kwargs) {
+  if (kwargs != nullptr && PyDict_Size(kwargs) != 0) {
+    PyErr_SetString(PyExc_TypeError, "algorithms take no keyword arguments");
+    return nullptr;
+  }
+  Buffers buffers {1};
+  if (!parseBuffer(args, buffers)) {
+    return nullptr;
+  }
+  try {
+    return reinterpret_cast<AlgorithmObject*>(self)->Binding->compute(buffers.data(0),
+                                                                       buffers.length(0));
+  } catch (...) {
+    return raiseCurrentException();
+  }
+}
+
+PyObject* algorithmHex(PyObject* self, PyObject* args) {
+  Buffers buffers {1};
+  if (!parseBuffer(args, buffers)) {
+    return nullptr;
+  }
+  try {
+    return reinterpret_cast<AlgorithmObject*>(self)->Binding->getHex(buffers.data(0),
+                                                                      buffers.length(0));
+  } catch (...) {
+    return raiseCurrentException();
+  }
+}
+
+PyObject* algorithmComputeBatch(PyObject* self, PyObject* inputs) {
+  PyObject* sequence {PySequence_Fast(inputs, "compute_batch() takes an iterable of buffers")};
+  if (sequence == nullptr) {
+    return nullptr;
+  }
+  PyObject* result {nullptr};
+  try {
+    const Py_ssize_t count {PySequence_Fast_GET_SIZE(sequence)};
+    Buffers buffers {static_cast<std::size_t>(count)};
+    bool ok {true};
+    for (Py_ssize_t i = 0; ok && i < count; ++i) {
+      ok = buffers.add(PySequence_Fast_GET_ITEM(sequence, i));
+    }
+    if (ok) {
+      result = reinterpret_cast<AlgorithmObject*>(self)->Binding->computeBatch(buffers);
+    }
+  } catch (...) {
+    result = raiseCurrentException();
+  }
+  Py_DECREF(sequence);
+  return result;
+}
+
+PyObject* algorithmCreateStream(PyObject* self, PyObject* /*args*/) {
+  StreamObject* stream {PyObject_New(StreamObject, StreamType)};
+  if (stream == nullptr) {
+    return nullptr;
+  }
+  stream->Binding = nullptr;
+  try {
+    stream->Binding = reinterpret_cast<AlgorithmObject*>(self)->Binding->createStream().release();
+  } catch (...) {
+    Py_DECREF(stream);
+    return raiseCurrentException();
+  }
+  return reinterpret_cast<PyObject*>(stream);
+}
+
+PyMethodDef AlgorithmMethods[] {
+  {"hex", algorithmHex, METH_VARARGS,
+   "hex(data)\n--\n\nReturns the checksum of a bytes-like object as hexadecimal string."},
+  {"compute_batch", algorithmComputeBatch, METH_O,
+   "compute_batch(inputs)\n--\n\nReturns the checksums of an iterable of bytes-like objects."},
+  {"create_stream", algorithmCreateStream, METH_NOARGS,
+   "create_stream()\n--\n\nReturns a stream for calculating a checksum incrementally."},
+  {nullptr, nullptr, 0, nullptr}
+};
+
+/// \brief Creates an algorithm, passing the maximum number of threads if the
+/// algorithm takes one.
+template<typename Algorithm>
+std::unique_ptr<Algorithm> makeAlgorithm(PyObject* threads, std::true_type /*takesThreads*/) {
+  if (threads == nullptr) {
+    return std::make_unique<Algorithm>();
+  }
+  const unsigned long count {PyLong_AsUnsignedLong(threads)};
+  if (PyErr_Occurred() != nullptr) {
+    return nullptr;
+  }
+  return std::make_unique<Algorithm>(static_cast<unsigned>(count));
+}
+
+template<typename Algorithm>
+std::unique_ptr<Algorithm> makeAlgorithm(PyObject* threads, std::false_type /*takesThreads*/) {
+  if (threads != nullptr) {
+    PyErr_SetString(PyExc_TypeError, "this algorithm takes no number of threads");
+    return nullptr;
+  }
+  return std::make_unique<Algorithm>();
+}
+
+template<typename Algorithm>
+PyObject* newAlgorithm(PyTypeObject* type, PyObject* args, PyObject* kwargs) {
+  using T = typename Algorithm::State::ResultType;
+  static const char* keywords[] {"threads", nullptr};
+  PyObject* threads {nullptr};
+  if (PyArg_ParseTupleAndKeywords(args, kwargs, "|O", const_cast<char**>(keywords),
+                                  &threads) == 0) {
+    return nullptr;
+  }
+  AlgorithmObject* self {reinterpret_cast<AlgorithmObject*>(type->tp_alloc(type, 0))};
+  if (self == nullptr) {
+    return nullptr;
+  }
+  try {
+    std::unique_ptr<Algorithm> algorithm {makeAlgorithm<Algorithm>(
+        threads, std::is_constructible<Algorithm, unsigned> {})};
+    if (algorithm) {
+      self->Binding = new TypedAlgorithm<T> {std::move(algorithm)};
+    }
+  } catch (...) {
+    raiseCurrentException();
+  }
+  if (self->Binding == nullptr) {
+    Py_DECREF(self);
+    return nullptr;
+  }
+  return reinterpret_cast<PyObject*>(self);
+}
+
+PyObject* streamUpdate(PyObject* self, PyObject* args) {
+  Buffers buffers {1};
+  if (!parseBuffer(args, buffers)) {
+    return nullptr;
+  }
+  StreamBinding& stream {*reinterpret_cast<StreamObject*>(self)->Binding};
+  try {
+    runUnlocked(buffers.length(0), [&]() {
+      const std::lock_guard<std::mutex> lock {stream.mutex()};
+      stream.update(buffers.data(0), buffers.length(0));
+    });
+  } catch (...) {
+    return raiseCurrentException();
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* streamFinalize(PyObject* self, PyObject* /*args*/) {
+  StreamBinding& stream {*reinterpret_cast<StreamObject*>(self)->Binding};
+  const std::lock_guard<std::mutex> lock {stream.mutex()};
+  return stream.finalize();
+}
+
+PyObject* streamHex(PyObject* self, PyObject* /*args*/) {
+  StreamBinding& stream {*reinterpret_cast<StreamObject*>(self)->Binding};
+  const std::lock_guard<std::mutex> lock {stream.mutex()};
+  return stream.getHex();
+}
+
+PyObject* streamReset(PyObject* self, PyObject* /*args*/) {
+  StreamBinding& stream {*reinterpret_cast<StreamObject*>(self)->Binding};
+  const std::lock_guard<std::mutex> lock {stream.mutex()};
+  stream.reset();
+  Py_RETURN_NONE;
+}
+
+PyMethodDef StreamMethods[] {
+  {"update", streamUpdate, METH_VARARGS,
+   "update(data)\n--\n\nAdds a bytes-like object to the checksum."},
+  {"finalize", streamFinalize, METH_NOARGS,
+   "finalize()\n--\n\nReturns the checksum of the data added so far."},
+  {"hex", streamHex, METH_NOARGS,
+   "hex()\n--\n\nReturns the checksum of the data added so far as hexadecimal string."},
+  {"reset", streamReset, METH_NOARGS,
+   "reset()\n--\n\nResets the stream to its initial state."},
+  {nullptr, nullptr, 0, nullptr}
+};
+
+PyObject* newStream(PyTypeObject* /*type*/, PyObject* /*args*/, PyObject* /*kwargs*/) {
+  PyErr_SetString(PyExc_TypeError, "streams are created by create_stream() of an algorithm");
+  return nullptr;
+}
+
+PyType_Slot StreamSlots[] {
+  {Py_tp_new, reinterpret_cast<void*>(newStream)},
+  {Py_tp_dealloc, reinterpret_cast<void*>(deallocate<StreamObject>)},
+  {Py_tp_methods, StreamMethods},
+  {Py_tp_doc, const_cast<char*>("Incremental calculation of a checksum.")},
+  {0, nullptr}
+};
+
+PyType_Spec StreamSpec {
+  "libchecksum.Stream", sizeof(StreamObject), 0, Py_TPFLAGS_DEFAULT, StreamSlots
+};
+
+/// \brief Adds the type of an algorithm to the module.
+/// \param module Module to add the type to
+/// \param name Qualified name of the type, e.g. "libchecksum.CRC32"
+/// \return False with a Python exception set on failure
+template<typename Algorithm>
+bool addAlgorithm(PyObject* module, const char* name) {
+  static PyType_Slot slots[] {
+    {Py_tp_new, reinterpret_cast<void*>(newAlgorithm<Algorithm>)},
+    {Py_tp_dealloc, reinterpret_cast<void*>(deallocate<AlgorithmObject>)},
+    {Py_tp_call, reinterpret_cast<void*>(callAlgorithm)},
+    {Py_tp_methods, AlgorithmMethods},
+    {Py_tp_doc, const_cast<char*>(
+        "Checksum algorithm. Calling it with a bytes-like object returns the checksum.")},
+    {0, nullptr}
+  };
+  static PyType_Spec spec {name, sizeof(AlgorithmObject), 0, Py_TPFLAGS_DEFAULT, slots};
+  PyObject* type {PyType_FromSpec(&spec)};
+  if (type == nullptr) {
+    return false;
+  }
+  if (PyModule_AddObject(module, std::strrchr(name, '.') + 1, type) != 0) {
+    Py_DECREF(type);
+    return false;
+  }
+  return true;
+}
+
+PyModuleDef Module {
+  PyModuleDef_HEAD_INIT, "libchecksum",
+  "Checksums and hashes of bytes-like objects, calculated without copying.",
+  -1, nullptr, nullptr, nullptr, nullptr, nullptr
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_libchecksum() {
+  PyObject* module {PyModule_Create(&Module)};
+  if (module == nullptr) {
+    return nullptr;
+  }
+  StreamType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&StreamSpec));
+  const bool ok {StreamType != nullptr
+      && PyModule_AddObject(module, "Stream", reinterpret_cast<PyObject*>(StreamType)) == 0
+      && PyModule_AddStringConstant(module, "__version__", getVersionString().c_str()) == 0
+      && addAlgorithm<Adler32>(module, "libchecksum.Adler32")
+      && addAlgorithm<Fletcher16>(module, "libchecksum.Fletcher16")
+      && addAlgorithm<Fletcher32>(module, "libchecksum.Fletcher32")
+      && addAlgorithm<Sum8>(module, "libchecksum.Sum8")
+      && addAlgorithm<Sum16>(module, "libchecksum.Sum16")
+      && addAlgorithm<Sum32>(module, "libchecksum.Sum32")
+      && addAlgorithm<BSDSum>(module, "libchecksum.BSDSum")
+      && addAlgorithm<XOR8>(module, "libchecksum.XOR8")
+      && addAlgorithm<SYSV>(module, "libchecksum.SYSV")
+      && addAlgorithm<InternetChecksum>(module, "libchecksum.InternetChecksum")
+      && addAlgorithm<Cksum>(module, "libchecksum.Cksum")
+      && addAlgorithm<CRC32>(module, "libchecksum.CRC32")
+      && addAlgorithm<CRC32C>(module, "libchecksum.CRC32C")
+      && addAlgorithm<CRC32BZIP2>(module, "libchecksum.CRC32BZIP2")
+      && addAlgorithm<XXH3>(module, "libchecksum.XXH3")
+      && addAlgorithm<XXH128>(module, "libchecksum.XXH128")
+      && addAlgorithm<SHA256>(module, "libchecksum.SHA256")
+      && addAlgorithm<BLAKE3>(module, "libchecksum.BLAKE3")};
+  if (!ok) {
+    Py_DECREF(module);
+    return nullptr;
+  }
+  return module;
+}
@@ -0,0 +1,117 @@
+# Copyright (c) 2018 Kevin Kirchner
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Tests of the Python extension module libchecksum."""
+
+import array
+import hashlib
+import mmap
+import threading
+import unittest
+import zlib
+
+import libchecksum
+
+DATA = bytes((i * 151 + 7) & 0xFF for i in range(100000))
+
+
+class AlgorithmTest(unittest.TestCase):
+
+    def test_known_values(self):
+        self.assertEqual(libchecksum.CRC32()(b"abcdef"), 0x4B8E39EF)
+        self.assertEqual(libchecksum.Cksum()(b"abcdef"), 0x2E152BB1)
+        self.assertEqual(libchecksum.BSDSum()(b"abcdef"), 2247)
+        self.assertEqual(libchecksum.CRC32().hex(b"abcdef"), "4b8e39ef")
+        self.assertEqual(libchecksum.CRC32()(DATA), zlib.crc32(DATA))
+        self.assertEqual(libchecksum.Adler32()(DATA), zlib.adler32(DATA))
+        self.assertEqual(libchecksum.SHA256()(DATA), hashlib.sha256(DATA).digest())
+        self.assertEqual(libchecksum.SHA256().hex(DATA), hashlib.sha256(DATA).hexdigest())
+        self.assertEqual(len(libchecksum.BLAKE3()(b"")), 32)
+        self.assertIsInstance(libchecksum.XXH3()(b""), int)
+
+    def test_buffer_types(self):
+        crc = libchecksum.CRC32()
+        expected = zlib.crc32(DATA)
+        self.assertEqual(crc(bytearray(DATA)), expected)
+        self.assertEqual(crc(memoryview(DATA)), expected)
+        self.assertEqual(crc(array.array("B", DATA)), expected)
+        self.assertEqual(crc(memoryview(DATA)[10:20]), zlib.crc32(DATA[10:20]))
+        with mmap.mmap(-1, len(DATA)) as mapped:
+            mapped.write(DATA)
+            self.assertEqual(crc(mapped), expected)
+        with self.assertRaises(TypeError):
+            crc("text")
+        with self.assertRaises(BufferError):
+            crc(memoryview(DATA)[::2])
+
+    def test_threads(self):
+        self.assertEqual(libchecksum.Fletcher32(threads=4)(DATA * 50),
+                         libchecksum.Fletcher32()(DATA * 50))
+        self.assertEqual(libchecksum.BLAKE3(threads=1)(DATA), libchecksum.BLAKE3()(DATA))
+        with self.assertRaises(TypeError):
+            libchecksum.CRC32(threads=2)
+        with self.assertRaises(OverflowError):
+            libchecksum.Sum8(threads=-1)
+
+    def test_batch(self):
+        inputs = [DATA[:length] for length in range(0, 5000, 97)]
+        for algorithm in (libchecksum.SHA256(), libchecksum.CRC32C(), libchecksum.XXH128()):
+            self.assertEqual(algorithm.compute_batch(inputs),
+                             [algorithm(data) for data in inputs])
+            self.assertEqual(algorithm.compute_batch(iter(inputs[:3])),
+                             [algorithm(data) for data in inputs[:3]])
+        with self.assertRaises(TypeError):
+            libchecksum.CRC32().compute_batch([b"a", 1])
+
+    def test_stream(self):
+        for algorithm in (libchecksum.InternetChecksum(), libchecksum.BSDSum(),
+                          libchecksum.BLAKE3(), libchecksum.Sum32()):
+            stream = algorithm.create_stream()
+            for position in range(0, len(DATA), 3333):
+                stream.update(DATA[position:position + 3333])
+            self.assertEqual(stream.finalize(), algorithm(DATA))
+            self.assertEqual(stream.hex(), algorithm.hex(DATA))
+            stream.reset()
+            self.assertEqual(stream.finalize(), algorithm(b""))
+        with self.assertRaises(TypeError):
+            libchecksum.Stream()
+
+    def test_concurrent_calls(self):
+        # the GIL is released while large inputs are processed
+        algorithm = libchecksum.SHA256()
+        stream = algorithm.create_stream()
+        results = []
+
+        def work():
+            for _ in range(20):
+                results.append(algorithm(DATA))
+                stream.update(DATA)
+
+        threads = [threading.Thread(target=work) for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        self.assertEqual(results, [hashlib.sha256(DATA).digest()] * 80)
+        self.assertEqual(stream.finalize(), hashlib.sha256(DATA * 80).digest())
+
+
+if __name__ == "__main__":
+    unittest.main()
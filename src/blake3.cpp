@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the BLAKE3 hash
+ *
+ * This source file implements the BLAKE3 hash declared in hash.h. Whole
+ * chunks are hashed 16 at a time with AVX-512 or 8 at a time with AVX2, and
+ * large inputs are split into subtrees that are hashed on several threads.
+ */
+
+#include <libchecksum/hash.h>
+#include "cpu.h"
+#include "instrumentation_hooks.h"
+#include "parallel.h"
+#include "simd.h"
+#include "stream.h"
+#include "tiers.h"
+
+#include <vector>
+
+namespace libchecksum {
+
+namespace {
+
+using kernel::blake::BlockLength;
+using kernel::blake::ChunkLength;
+using kernel::blake::Constants;
+
+/// Number of chunks of the subtrees hashed by separate threads
+constexpr uint64_t SubtreeChunks {512};
+/// Minimum input length for hashing on several threads
+constexpr std::size_t ParallelThreshold {4 * SubtreeChunks * ChunkLength};
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+/// Stands in for the chunks of unused lanes
+alignas(64) const uint8_t UnusedChunk[ChunkLength] {};
+
+/// The quarter-round of BLAKE3 on 8 lanes
+__attribute__((target("avx2")))
+inline void mix(__m256i& a, __m256i& b, __m256i& c, __m256i& d, __m256i x, __m256i y) {
+  const __m256i rotate16 {_mm256_set_epi8(
+      13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+      13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2)};
+  const __m256i rotate8 {_mm256_set_epi8(
+      12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1,
+      12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1)};
+  a = _mm256_add_epi32(_mm256_add_epi32(a, b), x);
+  d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rotate16);
+  c = _mm256_add_epi32(c, d);
+  b = _mm256_xor_si256(b, c);
+  b = _mm256_or_si256(_mm256_srli_epi32(b, 12), _mm256_slli_epi32(b, 20));
+  a = _mm256_add_epi32(_mm256_add_epi32(a, b), y);
+  d = _mm256_shuffle_epi8(_mm256_xor_si256(d, a), rotate8);
+  c = _mm256_add_epi32(c, d);
+  b = _mm256_xor_si256(b, c);
+  b = _mm256_or_si256(_mm256_srli_epi32(b, 7), _mm256_slli_epi32(b, 25));
+}
+
+/// \brief Hashes up to 8 whole chunks at once, one chunk per lane.
+/// \param data Input of \p count chunks
+/// \param count Number of chunks, at most 8
+/// \param counter Index of the first chunk in the input
+/// \param cvs Chaining values of the chunks
+__attribute__((target("avx2")))
+void hashChunksAVX2(const uint8_t* data, std::size_t count, uint64_t counter,
+                    uint32_t (*cvs)[8]) {
+  constexpr std::size_t Lanes {8};
+  const uint8_t* chunks[Lanes];
+  alignas(32) uint32_t counterLow[Lanes];
+  alignas(32) uint32_t counterHigh[Lanes];
+  for (std::size_t lane = 0; lane < Lanes; ++lane) {
+    chunks[lane] = lane < count ? data + lane * ChunkLength : UnusedChunk;
+    counterLow[lane] = static_cast<uint32_t>(counter + lane);
+    counterHigh[lane] = static_cast<uint32_t>((counter + lane) >> 32);
+  }
+  __m256i h[8];
+  for (std::size_t i = 0; i < 8; ++i) {
+    h[i] = _mm256_set1_epi32(static_cast<int>(Constants<>::IV[i]));
+  }
+
+  for (std::size_t offset = 0; offset < ChunkLength; offset += BlockLength) {
+    __m256i m[16];
+    for (std::size_t half = 0; half < 2; ++half) {
+      __m256i rows[8];
+      for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        rows[lane] = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(chunks[lane] + offset) + half);
+      }
+      detail::transpose8x8(rows);
+      std::copy(rows, rows + 8, m + 8 * half);
+    }
+    const uint32_t flags {(offset == 0 ? kernel::blake::ChunkStart : 0u)
+                          | (offset + BlockLength == ChunkLength ? kernel::blake::ChunkEnd : 0u)};
+    __m256i v[16] {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm256_set1_epi32(static_cast<int>(Constants<>::IV[0])),
+      _mm256_set1_epi32(static_cast<int>(Constants<>::IV[1])),
+      _mm256_set1_epi32(static_cast<int>(Constants<>::IV[2])),
+      _mm256_set1_epi32(static_cast<int>(Constants<>::IV[3])),
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(counterLow)),
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(counterHigh)),
+      _mm256_set1_epi32(static_cast<int>(BlockLength)),
+      _mm256_set1_epi32(static_cast<int>(flags))
+    };
+    for (std::size_t round = 0; round < 7; ++round) {
+      const uint8_t (&s)[16] = Constants<>::Schedule[round];
+      mix(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+      mix(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+      mix(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+      mix(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+      mix(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+      mix(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      mix(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+      mix(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+    }
+    for (std::size_t i = 0; i < 8; ++i) {
+      h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+    }
+  }
+
+  alignas(32) uint32_t words[8][Lanes];
+  for (std::size_t i = 0; i < 8; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), h[i]);
+  }
+  for (std::size_t lane = 0; lane < count; ++lane) {
+    for (std::size_t i = 0; i < 8; ++i) {
+      cvs[lane][i] = words[i][lane];
+    }
+  }
+}
+
+// the AVX-512 intrinsics of GCC trip its own uninitialized warnings, as they
+// pass _mm512_undefined_epi32() as the unused source of masked instructions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/// The quarter-round of BLAKE3 on 16 lanes
+__attribute__((target("avx512f")))
+inline void mix(__m512i& a, __m512i& b, __m512i& c, __m512i& d, __m512i x, __m512i y) {
+  a = _mm512_add_epi32(_mm512_add_epi32(a, b), x);
+  d = _mm512_ror_epi32(_mm512_xor_si512(d, a), 16);
+  c = _mm512_add_epi32(c, d);
+  b = _mm512_ror_epi32(_mm512_xor_si512(b, c), 12);
+  a = _mm512_add_epi32(_mm512_add_epi32(a, b), y);
+  d = _mm512_ror_epi32(_mm512_xor_si512(d, a), 8);
+  c = _mm512_add_epi32(c, d);
+  b = _mm512_ror_epi32(_mm512_xor_si512(b, c), 7);
+}
+
+/// \brief Hashes up to 16 whole chunks at once, one chunk per lane.
+/// \param data Input of \p count chunks
+/// \param count Number of chunks, at most 16
+/// \param counter Index of the first chunk in the input
+/// \param cvs Chaining values of the chunks
+__attribute__((target("avx512f")))
+void hashChunksAVX512(const uint8_t* data, std::size_t count, uint64_t counter,
+                      uint32_t (*cvs)[8]) {
+  constexpr std::size_t Lanes {16};
+  const uint8_t* chunks[Lanes];
+  alignas(64) uint32_t counterLow[Lanes];
+  alignas(64) uint32_t counterHigh[Lanes];
+  for (std::size_t lane = 0; lane < Lanes; ++lane) {
+    chunks[lane] = lane < count ? data + lane * ChunkLength : UnusedChunk;
+    counterLow[lane] = static_cast<uint32_t>(counter + lane);
+    counterHigh[lane] = static_cast<uint32_t>((counter + lane) >> 32);
+  }
+  __m512i h[8];
+  for (std::size_t i = 0; i < 8; ++i) {
+    h[i] = _mm512_set1_epi32(static_cast<int>(Constants<>::IV[i]));
+  }
+
+  for (std::size_t offset = 0; offset < ChunkLength; offset += BlockLength) {
+    __m512i m[16];
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+      m[lane] = _mm512_loadu_si512(chunks[lane] + offset);
+    }
+    detail::transpose16x16(m);
+    const uint32_t flags {(offset == 0 ? kernel::blake::ChunkStart : 0u)
+                          | (offset + BlockLength == ChunkLength ? kernel::blake::ChunkEnd : 0u)};
+    __m512i v[16] {
+      h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7],
+      _mm512_set1_epi32(static_cast<int>(Constants<>::IV[0])),
+      _mm512_set1_epi32(static_cast<int>(Constants<>::IV[1])),
+      _mm512_set1_epi32(static_cast<int>(Constants<>::IV[2])),
+      _mm512_set1_epi32(static_cast<int>(Constants<>::IV[3])),
+      _mm512_load_si512(counterLow),
+      _mm512_load_si512(counterHigh),
+      _mm512_set1_epi32(static_cast<int>(BlockLength)),
+      _mm512_set1_epi32(static_cast<int>(flags))
+    };
+    for (std::size_t round = 0; round < 7; ++round) {
+      const uint8_t (&s)[16] = Constants<>::Schedule[round];
+      mix(v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+      mix(v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+      mix(v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+      mix(v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+      mix(v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+      mix(v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+      mix(v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+      mix(v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+    }
+    for (std::size_t i = 0; i < 8; ++i) {
+      h[i] = _mm512_xor_si512(v[i], v[i + 8]);
+    }
+  }
+
+  alignas(64) uint32_t words[8][Lanes];
+  for (std::size_t i = 0; i < 8; ++i) {
+    _mm512_store_si512(words[i], h[i]);
+  }
+  for (std::size_t lane = 0; lane < count; ++lane) {
+    for (std::size_t i = 0; i < 8; ++i) {
+      cvs[lane][i] = words[i][lane];
+    }
+  }
+}
+#pragma GCC diagnostic pop
+#endif
+
+/// Hashes whole chunks with the widest SIMD kernel of the CPU
+struct SimdChunks {
+  static void hashChunks(const uint8_t* data, std::size_t count, uint64_t counter,
+                         uint32_t (*cvs)[8]) {
+#ifdef LIBCHECKSUM_X86_KERNELS
+    if (count > 8 && detail::cpuFeatures().AVX512) {
+      hashChunksAVX512(data, count, counter, cvs);
+      return;
+    }
+    if (count > 1 && detail::cpuFeatures().AVX2) {
+      for (std::size_t first = 0; first < count; first += 8) {
+        hashChunksAVX2(data + first * ChunkLength, std::min<std::size_t>(8, count - first),
+                       counter + first, cvs + first);
+      }
+      return;
+    }
+#endif
+    kernel::blake::ScalarChunks::hashChunks(data, count, counter, cvs);
+  }
+
+  template<typename Byte>
+  static void hashChunks(const Byte* data, std::size_t count, uint64_t counter,
+                         uint32_t (*cvs)[8]) {
+    hashChunks(reinterpret_cast<const uint8_t*>(data), count, counter, cvs);
+  }
+};
+
+using SimdState = kernel::BasicBLAKE3State<SimdChunks>;
+
+/// \brief Updates a state with the widest SIMD kernel of the CPU.
+/// \return Kernel tier used for the update
+KernelTier updateSimd(SimdState& state, const uint8_t* data, std::size_t length) {
+  state.update(data, length);
+  return length > ChunkLength ? detail::blake3Tier() : KernelTier::Scalar;
+}
+
+/// Chaining value of a subtree
+struct ChainingValue {
+  uint32_t Words[8];
+};
+
+} // namespace
+
+namespace detail {
+
+KernelTier blake3Tier() {
+  const CpuFeatures& features = cpuFeatures();
+  return features.AVX512 ? KernelTier::AVX512 : features.AVX2 ? KernelTier::AVX2 : KernelTier::Scalar;
+}
+
+} // namespace detail
+
+BLAKE3::BLAKE3(unsigned threads) : Threads {threads} {}
+
+Digest256 BLAKE3::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::BLAKE3, length};
+  SimdState state {};
+  if (length >= ParallelThreshold && Threads != 1) {
+    // every subtree but the last one, which ends the input and stays in the
+    // state, is hashed on its own
+    constexpr std::size_t subtreeLength {SubtreeChunks * ChunkLength};
+    const std::size_t subtrees {(length - 1) / subtreeLength};
+    std::vector<ChainingValue> cvs(subtrees);
+    detail::parallelFor(subtrees, Threads, [&](std::size_t index) {
+      SimdState subtree {index * SubtreeChunks};
+      subtree.update(data + index * subtreeLength, subtreeLength);
+      subtree.chainingValue(cvs[index].Words);
+    });
+    for (const ChainingValue& cv : cvs) {
+      state.pushSubtree(cv.Words, SubtreeChunks);
+    }
+    data += subtrees * subtreeLength;
+    length -= subtrees * subtreeLength;
+  }
+  scope.setTier(updateSimd(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<Digest256>> BLAKE3::createStream() const {
+  return detail::makeStream<SimdState, updateSimd>(AlgorithmId::BLAKE3);
+}
+
+} // namespace libchecksum
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements block indexes
+ *
+ * This source file implements the block index declared in blockindex.h.
+ */
+
+#include <libchecksum/blockindex.h>
+#include <libchecksum/hash.h>
+#include <libchecksum/kernels.h>
+#include "parallel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace libchecksum {
+
+namespace {
+
+constexpr char Magic[8] = {'L', 'C', 'B', 'L', 'K', 'I', 'D', 'X'};
+constexpr uint32_t Version {1};
+constexpr std::size_t HeaderSize {64};
+/// Offset of the root in the header
+constexpr std::size_t RootOffset {32};
+constexpr std::size_t NodeSize {32};
+/// Number of blocks read at once when verifying a file
+constexpr std::size_t ReadBlocks {256};
+
+/// Prefixes of the hashed nodes of the Merkle tree
+constexpr uint8_t LeafPrefix {0x00};
+constexpr uint8_t InnerPrefix {0x01};
+constexpr uint8_t RootPrefix {0x02};
+
+uint32_t read32(const uint8_t* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint64_t read64(const uint8_t* data) {
+  return read32(data) | (static_cast<uint64_t>(read32(data + 4)) << 32);
+}
+
+void write32(uint8_t* data, uint32_t value) {
+  for (std::size_t i = 0; i < 4; ++i) {
+    data[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+void write64(uint8_t* data, uint64_t value) {
+  write32(data, static_cast<uint32_t>(value));
+  write32(data + 4, static_cast<uint32_t>(value >> 32));
+}
+
+uint64_t divideRoundingUp(uint64_t value, uint64_t divisor) {
+  return value / divisor + (value % divisor != 0 ? 1 : 0);
+}
+
+/// \brief Returns the number of nodes of every level of the Merkle tree.
+std::vector<uint64_t> levelSizes(uint64_t blocks) {
+  // data without blocks still has a leaf, which hashes no checksums
+  std::vector<uint64_t> sizes {std::max<uint64_t>(divideRoundingUp(blocks, BlockIndex::LeafBlocks), 1)};
+  while (sizes.back() > 1) {
+    sizes.push_back(divideRoundingUp(sizes.back(), 2));
+  }
+  return sizes;
+}
+
+/// \brief Returns the number of nodes of the Merkle tree.
+uint64_t nodeCount(const std::vector<uint64_t>& sizes) {
+  uint64_t count {0};
+  for (const uint64_t size : sizes) {
+    count += size;
+  }
+  return count;
+}
+
+Digest256 hashLeaf(const uint8_t* checksums, std::size_t count) {
+  const auto stream = SHA256 {}.createStream();
+  stream->update(&LeafPrefix, 1);
+  stream->update(checksums, 4 * count);
+  return stream->finalize();
+}
+
+Digest256 hashInner(const uint8_t* left, const uint8_t* right) {
+  uint8_t input[1 + 2 * NodeSize];
+  input[0] = InnerPrefix;
+  std::memcpy(input + 1, left, NodeSize);
+  std::memcpy(input + 1 + NodeSize, right, NodeSize);
+  return SHA256 {}(input, sizeof(input));
+}
+
+Digest256 hashRoot(const uint8_t* header, const uint8_t* treeRoot) {
+  uint8_t input[1 + RootOffset - sizeof(Magic) + NodeSize];
+  input[0] = RootPrefix;
+  std::memcpy(input + 1, header + sizeof(Magic), RootOffset - sizeof(Magic));
+  std::memcpy(input + 1 + RootOffset - sizeof(Magic), treeRoot, NodeSize);
+  return SHA256 {}(input, sizeof(input));
+}
+
+/// \brief Calculates the checksum of a block.
+uint32_t checksumBlock(AlgorithmId algorithm, const uint8_t* data, std::size_t length) {
+  return algorithm == AlgorithmId::CRC32 ? kernel::compute<kernel::CRC32State>(data, length)
+                                         : kernel::compute<kernel::CRC32CState>(data, length);
+}
+
+} // namespace
+
+constexpr std::size_t BlockIndex::DefaultBlockSize;
+constexpr std::size_t BlockIndex::LeafBlocks;
+
+BlockIndex::~BlockIndex() = default;
+
+BlockIndex BlockIndex::create(const uint8_t* data, uint64_t length, AlgorithmId algorithm,
+                              std::size_t blockSize, unsigned threads) {
+  if (algorithm != AlgorithmId::CRC32 && algorithm != AlgorithmId::CRC32C) {
+    throw std::invalid_argument {"Block indexes support CRC32 and CRC32C only"};
+  }
+  if (blockSize == 0) {
+    throw std::invalid_argument {"The block size must not be 0"};
+  }
+  const uint64_t blocks {divideRoundingUp(length, blockSize)};
+  const std::vector<uint64_t> sizes {levelSizes(blocks)};
+
+  BlockIndex index;
+  index.Buffer.resize(HeaderSize + 4 * blocks + NodeSize * nodeCount(sizes));
+  uint8_t* const header {index.Buffer.data()};
+  std::memcpy(header, Magic, sizeof(Magic));
+  write32(header + 8, Version);
+  write32(header + 12, static_cast<uint32_t>(algorithm));
+  write64(header + 16, blockSize);
+  write64(header + 24, length);
+  uint8_t* const checksums {header + HeaderSize};
+  uint8_t* nodes {checksums + 4 * blocks};
+
+  // each leaf checksums its blocks and hashes their checksums
+  detail::parallelFor(sizes[0], threads, [&](std::size_t leaf) {
+    const uint64_t first {leaf * LeafBlocks};
+    const uint64_t count {std::min<uint64_t>(blocks - std::min(blocks, first), LeafBlocks)};
+    for (uint64_t block = first; block < first + count; ++block) {
+      const uint64_t offset {block * blockSize};
+      write32(checksums + 4 * block, checksumBlock(algorithm, data + offset,
+          static_cast<std::size_t>(std::min<uint64_t>(blockSize, length - offset))));
+    }
+    const Digest256 hash {hashLeaf(checksums + 4 * first, count)};
+    std::memcpy(nodes + NodeSize * leaf, hash.data(), NodeSize);
+  });
+
+  for (std::size_t level = 1; level < sizes.size(); ++level) {
+    const uint8_t* const children {nodes};
+    nodes += NodeSize * sizes[level - 1];
+    for (uint64_t node = 0; node < sizes[level]; ++node) {
+      const uint8_t* const left {children + NodeSize * 2 * node};
+      if (2 * node + 1 < sizes[level - 1]) {
+        const Digest256 hash {hashInner(left, left + NodeSize)};
+        std::memcpy(nodes + NodeSize * node, hash.data(), NodeSize);
+      } else {
+        std::memcpy(nodes + NodeSize * node, left, NodeSize);
+      }
+    }
+  }
+  const Digest256 root {hashRoot(header, nodes)};
+  std::memcpy(header + RootOffset, root.data(), NodeSize);
+
+  index.Data = index.Buffer.data();
+  index.Size = index.Buffer.size();
+  return index;
+}
+
+BlockIndex BlockIndex::open(const std::string& path) {
+  BlockIndex index;
+  index.File.reset(new MappedFile {path});
+  index.Data = index.File->data();
+  index.Size = index.File->size();
+  index.checkStructure();
+  return index;
+}
+
+BlockIndex BlockIndex::parse(const uint8_t* data, std::size_t length) {
+  BlockIndex index;
+  index.Buffer.assign(data, data + length);
+  index.Data = index.Buffer.data();
+  index.Size = index.Buffer.size();
+  index.checkStructure();
+  return index;
+}
+
+void BlockIndex::checkStructure() const {
+  if (Size < HeaderSize || std::memcmp(Data, Magic, sizeof(Magic)) != 0) {
+    throw std::runtime_error {"Not a block index"};
+  }
+  if (read32(Data + 8) != Version) {
+    throw std::runtime_error {"Unsupported version of the block index"};
+  }
+  if (algorithm() != AlgorithmId::CRC32 && algorithm() != AlgorithmId::CRC32C) {
+    throw std::runtime_error {"Unsupported algorithm of the block index"};
+  }
+  if (read64(Data + 16) == 0) {
+    throw std::runtime_error {"Invalid block size of the block index"};
+  }
+  // the sizes are checked one by one, so they cannot overflow
+  const uint64_t blocks {blockCount()};
+  const uint64_t nodes {nodeCount(levelSizes(blocks))};
+  if (blocks > (Size - HeaderSize) / 4 || nodes != (Size - HeaderSize - 4 * blocks) / NodeSize
+      || (Size - HeaderSize - 4 * blocks) % NodeSize != 0) {
+    throw std::runtime_error {"Truncated block index"};
+  }
+}
+
+void BlockIndex::save(const std::string& path) const {
+  std::FILE* file {std::fopen(path.c_str(), "wb")};
+  if (file == nullptr) {
+    throw std::system_error {errno, std::generic_category(), path};
+  }
+  const bool written {std::fwrite(Data, 1, Size, file) == Size};
+  const int error {errno};
+  if (std::fclose(file) != 0 || !written) {
+    throw std::system_error {written ? errno : error, std::generic_category(), path};
+  }
+}
+
+AlgorithmId BlockIndex::algorithm() const {
+  return static_cast<AlgorithmId>(read32(Data + 12));
+}
+
+std::size_t BlockIndex::blockSize() const {
+  return static_cast<std::size_t>(read64(Data + 16));
+}
+
+uint64_t BlockIndex::dataLength() const {
+  return read64(Data + 24);
+}
+
+uint64_t BlockIndex::blockCount() const {
+  return divideRoundingUp(dataLength(), read64(Data + 16));
+}
+
+uint32_t BlockIndex::blockChecksum(uint64_t block) const {
+  if (block >= blockCount()) {
+    throw std::out_of_range {"Block outside of the index"};
+  }
+  return read32(Data + HeaderSize + 4 * block);
+}
+
+Digest256 BlockIndex::root() const {
+  Digest256 root {};
+  std::memcpy(root.data(), Data + RootOffset, NodeSize);
+  return root;
+}
+
+bool BlockIndex::verifyIndex() const {
+  const uint64_t blocks {blockCount()};
+  const std::vector<uint64_t> sizes {levelSizes(blocks)};
+  const uint8_t* const checksums {Data + HeaderSize};
+  const uint8_t* nodes {checksums + 4 * blocks};
+  for (uint64_t leaf = 0; leaf < sizes[0]; ++leaf) {
+    const uint64_t first {leaf * LeafBlocks};
+    const uint64_t count {std::min<uint64_t>(blocks - std::min(blocks, first), LeafBlocks)};
+    if (std::memcmp(hashLeaf(checksums + 4 * first, count).data(), nodes + NodeSize * leaf,
+                    NodeSize) != 0) {
+      return false;
+    }
+  }
+  for (std::size_t level = 1; level < sizes.size(); ++level) {
+    const uint8_t* const children {nodes};
+    nodes += NodeSize * sizes[level - 1];
+    for (uint64_t node = 0; node < sizes[level]; ++node) {
+      const uint8_t* const left {children + NodeSize * 2 * node};
+      const bool matches {2 * node + 1 < sizes[level - 1]
+          ? std::memcmp(hashInner(left, left + NodeSize).data(), nodes + NodeSize * node,
+                        NodeSize) == 0
+          : std::memcmp(left, nodes + NodeSize * node, NodeSize) == 0};
+      if (!matches) {
+        return false;
+      }
+    }
+  }
+  return hashRoot(Data, nodes) == root();
+}
+
+bool BlockIndex::authenticate(uint64_t firstBlock, uint64_t lastBlock) const {
+  const uint64_t blocks {blockCount()};
+  const std::vector<uint64_t> sizes {levelSizes(blocks)};
+  const uint8_t* const checksums {Data + HeaderSize};
+  const uint8_t* const tree {checksums + 4 * blocks};
+  for (uint64_t leaf = firstBlock / LeafBlocks; leaf <= lastBlock / LeafBlocks; ++leaf) {
+    // climb from the recalculated leaf to the root with the stored siblings
+    const uint64_t first {leaf * LeafBlocks};
+    Digest256 node {hashLeaf(checksums + 4 * first, std::min<uint64_t>(blocks - first, LeafBlocks))};
+    const uint8_t* level {tree};
+    uint64_t position {leaf};
+    for (std::size_t depth = 0; depth + 1 < sizes.size(); ++depth) {
+      const uint64_t sibling {position ^ 1};
+      if (sibling < sizes[depth]) {
+        const uint8_t* const other {level + NodeSize * sibling};
+        node = (position & 1) != 0 ? hashInner(other, node.data()) : hashInner(node.data(), other);
+      }
+      level += NodeSize * sizes[depth];
+      position >>= 1;
+    }
+    if (hashRoot(Data, node.data()) != root()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<uint64_t> BlockIndex::checkBlocks(uint64_t first, uint64_t count,
+                                              const uint8_t* data, std::size_t length) const {
+  std::vector<uint64_t> mismatched;
+  const std::size_t size {blockSize()};
+  for (uint64_t i = 0; i < count; ++i) {
+    const uint64_t block {first + i};
+    const std::size_t expected {static_cast<std::size_t>(
+        std::min<uint64_t>(size, dataLength() - block * size))};
+    const std::size_t offset {static_cast<std::size_t>(i * size)};
+    if (offset + expected > length
+        || checksumBlock(algorithm(), data + offset, expected) != blockChecksum(block)) {
+      mismatched.push_back(block);
+    }
+  }
+  return mismatched;
+}
+
+BlockVerification BlockIndex::verifyRange(const uint8_t* data, uint64_t offset,
+                                          uint64_t length) const {
+  if (offset > dataLength() || length > dataLength() - offset) {
+    throw std::out_of_range {"The range exceeds the indexed data"};
+  }
+  if (length == 0) {
+    return {true, {}};
+  }
+  const uint64_t first {offset / blockSize()};
+  const uint64_t last {(offset + length - 1) / blockSize()};
+  const uint64_t start {first * blockSize()};
+  const uint64_t end {std::min<uint64_t>((last + 1) * blockSize(), dataLength())};
+  return {authenticate(first, last), checkBlocks(first, last - first + 1, data + start,
+                                                 static_cast<std::size_t>(end - start))};
+}
+
+BlockVerification BlockIndex::verifyRange(int fd, uint64_t offset, uint64_t length) const {
+  if (offset > dataLength() || length > dataLength() - offset) {
+    throw std::out_of_range {"The range exceeds the indexed data"};
+  }
+  if (length == 0) {
+    return {true, {}};
+  }
+  const std::size_t size {blockSize()};
+  const uint64_t first {offset / size};
+  const uint64_t last {(offset + length - 1) / size};
+  BlockVerification result {authenticate(first, last), {}};
+
+  std::vector<uint8_t> buffer(size * static_cast<std::size_t>(
+      std::min<uint64_t>(last - first + 1, ReadBlocks)));
+  for (uint64_t block = first; block <= last; ) {
+    const uint64_t count {std::min<uint64_t>(last - block + 1, ReadBlocks)};
+    const uint64_t start {block * size};
+    const std::size_t wanted {static_cast<std::size_t>(
+        std::min<uint64_t>(count * size, dataLength() - start))};
+    std::size_t filled {0};
+    while (filled < wanted) {
+      const ssize_t bytes {::pread(fd, buffer.data() + filled, wanted - filled,
+                                   static_cast<off_t>(start + filled))};
+      if (bytes < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::system_error {errno, std::generic_category(), "pread"};
+      }
+      if (bytes == 0) {
+        break;
+      }
+      filled += static_cast<std::size_t>(bytes);
+    }
+    const std::vector<uint64_t> mismatched {checkBlocks(block, count, buffer.data(), filled)};
+    result.Mismatched.insert(result.Mismatched.end(), mismatched.begin(), mismatched.end());
+    block += count;
+  }
+  return result;
+}
+
+} // namespace libchecksum
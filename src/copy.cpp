@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements fused copy functions
+ *
+ * This source file implements the copy functions declared in copy.h.
+ */
+
+#include <libchecksum/copy.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace libchecksum {
+
+namespace {
+
+/// Smaller copies are done with memcpy, as the destination is likely to be
+/// used right away
+constexpr std::size_t NonTemporalThreshold {4096};
+
+/// Number of bytes copied before the checksum is updated; small enough for the
+/// source to still be in the L1 cache when the checksum reads it
+constexpr std::size_t ChunkSize {4096};
+
+/// \brief Copies bytes and updates the state, both through the cache.
+template<typename State>
+void cachedCopy(State& state, uint8_t* destination, const uint8_t* source,
+                std::size_t length) {
+  if (length != 0) {
+    std::memcpy(destination, source, length);
+    state.update(source, length);
+  }
+}
+
+#if defined(__SSE2__)
+/// \brief Copies whole cache lines with non-temporal stores.
+/// \param destination 16 byte aligned destination
+/// \param source Source
+/// \param length Multiple of 64
+void streamCopy(uint8_t* destination, const uint8_t* source, std::size_t length) {
+  for (std::size_t i = 0; i < length; i += 64) {
+    const auto* in = reinterpret_cast<const __m128i*>(source + i);
+    auto* out = reinterpret_cast<__m128i*>(destination + i);
+    const __m128i A {_mm_loadu_si128(in)};
+    const __m128i B {_mm_loadu_si128(in + 1)};
+    const __m128i C {_mm_loadu_si128(in + 2)};
+    const __m128i D {_mm_loadu_si128(in + 3)};
+    _mm_stream_si128(out, A);
+    _mm_stream_si128(out + 1, B);
+    _mm_stream_si128(out + 2, C);
+    _mm_stream_si128(out + 3, D);
+  }
+}
+#endif
+
+} // namespace
+
+template<typename State>
+void copyAndUpdate(State& state, uint8_t* destination, const uint8_t* source,
+                   std::size_t length) {
+#if defined(__SSE2__)
+  if (length >= NonTemporalThreshold) {
+    const std::size_t head {(16 - reinterpret_cast<std::uintptr_t>(destination) % 16) % 16};
+    cachedCopy(state, destination, source, head);
+    destination += head;
+    source += head;
+    length -= head;
+
+    while (length >= 64) {
+      const std::size_t chunk {std::min(ChunkSize, length & ~static_cast<std::size_t>(63))};
+      streamCopy(destination, source, chunk);
+      state.update(source, chunk);
+      destination += chunk;
+      source += chunk;
+      length -= chunk;
+    }
+    // order the non-temporal stores before any later store
+    _mm_sfence();
+  }
+#endif
+  cachedCopy(state, destination, source, length);
+}
+
+template void copyAndUpdate(kernel::CRC32State&, uint8_t*, const uint8_t*, std::size_t);
+template void copyAndUpdate(kernel::CRC32CState&, uint8_t*, const uint8_t*, std::size_t);
+template void copyAndUpdate(kernel::Adler32State&, uint8_t*, const uint8_t*, std::size_t);
+template void copyAndUpdate(kernel::Sum8State&, uint8_t*, const uint8_t*, std::size_t);
+template void copyAndUpdate(kernel::Sum16State&, uint8_t*, const uint8_t*, std::size_t);
+template void copyAndUpdate(kernel::Sum32State&, uint8_t*, const uint8_t*, std::size_t);
+
+} // namespace libchecksum
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the detection of CPU features
+ *
+ * This source file implements the CPU feature detection declared in cpu.h.
+ */
+
+#include "cpu.h"
+
+#include <cstdlib>
+#include <string>
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+#include <cpuid.h>
+#endif
+
+namespace libchecksum {
+
+namespace detail {
+
+CpuFeatures DetectedFeatures {};
+
+namespace {
+
+/// \brief Returns whether a feature is listed in a comma-separated list.
+bool isListed(const std::string& list, const std::string& feature) {
+  std::size_t start {0};
+  while (start <= list.size()) {
+    std::size_t end {list.find(',', start)};
+    if (end == std::string::npos) {
+      end = list.size();
+    }
+    const std::string entry {list.substr(start, end - start)};
+    if (entry == feature || entry == "all") {
+      return true;
+    }
+    start = end + 1;
+  }
+  return false;
+}
+
+/// \brief Detects the features of the CPU when the library is loaded.
+///
+/// The priority places this constructor before the dynamic initializers of
+/// C++ objects, which may already calculate checksums.
+#ifdef __GNUC__
+__attribute__((constructor(101)))
+#endif
+void detectFeatures() {
+  CpuFeatures features {};
+#ifdef LIBCHECKSUM_X86_KERNELS
+  __builtin_cpu_init();
+  features.AVX2 = __builtin_cpu_supports("avx2");
+  features.AVX512 = __builtin_cpu_supports("avx512f");
+  features.AVX512BW = features.AVX512 && __builtin_cpu_supports("avx512bw");
+  unsigned eax {0}, ebx {0}, ecx {0}, edx {0};
+  features.SHA = __builtin_cpu_supports("sse4.1")
+                 && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) != 0
+                 && (ebx & (1u << 29)) != 0;
+#endif
+
+  const char* disabled {std::getenv("LIBCHECKSUM_DISABLE_CPU_FEATURES")};
+  if (disabled != nullptr) {
+    const std::string list {disabled};
+    features.AVX2 = features.AVX2 && !isListed(list, "avx2");
+    features.AVX512 = features.AVX512 && !isListed(list, "avx512");
+    features.AVX512BW = features.AVX512BW && features.AVX512;
+    features.SHA = features.SHA && !isListed(list, "sha");
+  }
+  DetectedFeatures = features;
+}
+
+} // namespace
+
+} // namespace detail
+
+} // namespace libchecksum
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal detection of CPU features
+ *
+ * This private header declares the detection of the instruction set
+ * extensions used for selecting SIMD kernels at runtime.
+ */
+
+#ifndef CHECKSUM_CPU_H
+#define CHECKSUM_CPU_H
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/// Defined if SIMD kernels for x86-64 are compiled in
+#define LIBCHECKSUM_X86_KERNELS
+#endif
+
+namespace libchecksum {
+
+namespace detail {
+
+/// Instruction set extensions of the CPU that kernels can use
+struct CpuFeatures {
+  bool AVX2 {false};
+  bool AVX512 {false};
+  /// AVX-512 byte and word instructions together with AVX-512F
+  bool AVX512BW {false};
+  /// SHA extensions together with SSE4.1
+  bool SHA {false};
+};
+
+/// \brief Features of the CPU.
+///
+/// The features are detected by a constructor of the library, which runs
+/// before the dynamic initialization of any C++ object, so reading them needs
+/// no guard. Until then, all features are reported as missing.
+extern CpuFeatures DetectedFeatures;
+
+/// \brief Returns the features of the CPU.
+///
+/// Features listed in the environment variable
+/// \p LIBCHECKSUM_DISABLE_CPU_FEATURES (comma-separated, e.g. "avx512,sha" or
+/// "all") are reported as missing, so the fallback kernels can be tested.
+/// \return Features of the CPU
+inline const CpuFeatures& cpuFeatures() {
+  return DetectedFeatures;
+}
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_CPU_H
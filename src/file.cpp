@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements file input
+ *
+ * This source file implements the memory-mapped file access declared in
+ * file.h.
+ */
+
+#include <libchecksum/file.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <istream>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace libchecksum {
+
+namespace {
+
+/// Closes a file descriptor when going out of scope
+class FileDescriptor final {
+
+public:
+  explicit FileDescriptor(int fd) : Fd {fd} {}
+  FileDescriptor(const FileDescriptor&) = delete;
+  FileDescriptor& operator=(const FileDescriptor&) = delete;
+  ~FileDescriptor() {
+    if (Fd >= 0) {
+      ::close(Fd);
+    }
+  }
+
+  int get() const {
+    return Fd;
+  }
+
+private:
+  int Fd;
+};
+
+[[noreturn]] void throwError(const std::string& name) {
+  throw std::system_error {errno, std::generic_category(), name};
+}
+
+/// Alignment of the buffer of the block reader, a page on common systems
+constexpr std::size_t BufferAlignment {4096};
+
+} // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+  const FileDescriptor fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd.get() < 0) {
+    throwError(path);
+  }
+  load(fd.get(), path);
+}
+
+MappedFile::MappedFile(int fd) {
+  load(fd, "file descriptor " + std::to_string(fd));
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : Data {other.Data}, Size {other.Size}, Mapped {other.Mapped},
+    Buffer {std::move(other.Buffer)} {
+  other.Data = nullptr;
+  other.Size = 0;
+  other.Mapped = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    release();
+    Data = other.Data;
+    Size = other.Size;
+    Mapped = other.Mapped;
+    Buffer = std::move(other.Buffer);
+    other.Data = nullptr;
+    other.Size = 0;
+    other.Mapped = false;
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  release();
+}
+
+void MappedFile::load(int fd, const std::string& name) {
+  struct stat info {};
+  if (::fstat(fd, &info) != 0) {
+    throwError(name);
+  }
+
+  if (S_ISREG(info.st_mode)) {
+    Size = static_cast<std::size_t>(info.st_size);
+    if (Size == 0) {
+      return;
+    }
+    void* address = ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address != MAP_FAILED) {
+      ::madvise(address, Size, MADV_SEQUENTIAL);
+      Data = static_cast<const uint8_t*>(address);
+      Mapped = true;
+      return;
+    }
+    Size = 0;
+  }
+
+  // not mappable, so read everything into the buffer
+  constexpr std::size_t ChunkSize {1 << 16};
+  std::size_t used {0};
+  for (;;) {
+    Buffer.resize(used + ChunkSize);
+    const ssize_t count = ::read(fd, Buffer.data() + used, ChunkSize);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throwError(name);
+    }
+    if (count == 0) {
+      break;
+    }
+    used += static_cast<std::size_t>(count);
+  }
+  Buffer.resize(used);
+  Data = Buffer.data();
+  Size = used;
+}
+
+void MappedFile::release() noexcept {
+  if (Mapped) {
+    ::munmap(const_cast<uint8_t*>(Data), Size);
+  }
+  Data = nullptr;
+  Size = 0;
+  Mapped = false;
+  Buffer.clear();
+}
+
+constexpr std::size_t BlockReader::DefaultBlockSize;
+
+BlockReader::BlockReader(std::size_t blockSize)
+  : BlockSize {blockSize != 0 ? blockSize : 1}, Buffer {nullptr} {
+  void* buffer {nullptr};
+  const std::size_t size {(BlockSize + BufferAlignment - 1) / BufferAlignment * BufferAlignment};
+  if (::posix_memalign(&buffer, BufferAlignment, size) != 0) {
+    throw std::bad_alloc {};
+  }
+  Buffer = static_cast<uint8_t*>(buffer);
+}
+
+BlockReader::~BlockReader() {
+  std::free(Buffer);
+}
+
+std::size_t BlockReader::readDescriptor(int fd, const Consumer& consume) {
+  // fails on pipes and sockets, which are read sequentially anyway
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  std::size_t total {0};
+  for (;;) {
+    std::size_t used {0};
+    while (used < BlockSize) {
+      const ssize_t count = ::read(fd, Buffer + used, BlockSize - used);
+      if (count < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throwError("file descriptor " + std::to_string(fd));
+      }
+      if (count == 0) {
+        break;
+      }
+      used += static_cast<std::size_t>(count);
+    }
+    if (used != 0) {
+      consume(Buffer, used);
+      total += used;
+    }
+    if (used < BlockSize) {
+      return total;
+    }
+  }
+}
+
+std::size_t BlockReader::readFile(std::FILE* file, const Consumer& consume) {
+  const int fd {::fileno(file)};
+  if (fd >= 0) {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+  }
+  std::size_t total {0};
+  for (;;) {
+    const std::size_t used {std::fread(Buffer, 1, BlockSize, file)};
+    if (used != 0) {
+      consume(Buffer, used);
+      total += used;
+    }
+    if (used < BlockSize) {
+      if (std::ferror(file) != 0) {
+        throwError("FILE stream");
+      }
+      return total;
+    }
+  }
+}
+
+std::size_t BlockReader::readStream(std::istream& input, const Consumer& consume) {
+  std::size_t total {0};
+  for (;;) {
+    input.read(reinterpret_cast<char*>(Buffer), static_cast<std::streamsize>(BlockSize));
+    const std::size_t used {static_cast<std::size_t>(input.gcount())};
+    if (used != 0) {
+      consume(Buffer, used);
+      total += used;
+    }
+    if (input.bad()) {
+      throw std::system_error {std::make_error_code(std::io_errc::stream), "input stream"};
+    }
+    if (used < BlockSize) {
+      return total;
+    }
+  }
+}
+
+} // namespace libchecksum
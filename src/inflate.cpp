@@ -0,0 +1,439 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements compressed data verification
+ *
+ * This source file implements the verification of gzip and zlib data
+ * declared in inflate.h on top of the raw inflate of zlib.
+ */
+
+#include <libchecksum/inflate.h>
+#include <libchecksum/kernels.h>
+#include "parallel.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <stdexcept>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace libchecksum {
+
+namespace {
+
+using Status = InflateResult::Status;
+
+/// Flags of the gzip header
+constexpr uint8_t FlagHeaderCrc {0x02};
+constexpr uint8_t FlagExtra {0x04};
+constexpr uint8_t FlagName {0x08};
+constexpr uint8_t FlagComment {0x10};
+constexpr uint8_t FlagsReserved {0xE0};
+
+uint32_t readLittleEndian32(const uint8_t* data) {
+  return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint32_t readBigEndian32(const uint8_t* data) {
+  return (static_cast<uint32_t>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3];
+}
+
+/// \brief Returns whether data starts like a gzip member.
+bool isGzipStart(const uint8_t* data, std::size_t length) {
+  return length >= 4 && data[0] == 0x1F && data[1] == 0x8B && data[2] == 8
+         && (data[3] & FlagsReserved) == 0;
+}
+
+/// Raw inflate of zlib, which neither parses headers nor calculates checksums
+class RawInflater {
+
+public:
+  RawInflater() {
+    const int result {inflateInit2(&Stream, -MAX_WBITS)};
+    if (result == Z_MEM_ERROR) {
+      throw std::bad_alloc {};
+    }
+    if (result != Z_OK) {
+      throw std::runtime_error {"Cannot initialize zlib"};
+    }
+  }
+
+  ~RawInflater() {
+    inflateEnd(&Stream);
+  }
+
+  RawInflater(const RawInflater&) = delete;
+  RawInflater& operator=(const RawInflater&) = delete;
+
+  /// \brief Inflates deflate data and updates a checksum state with every
+  /// window of the inflated data.
+  /// \param offset Offset of the deflate data, receives the offset after it
+  /// \param length Receives the number of inflated bytes
+  template<typename State>
+  Status inflate(const uint8_t* data, std::size_t size, std::size_t& offset, State& state,
+                 uint64_t& length, std::vector<uint8_t>& window, const InflateOutput* output,
+                 std::string& error) {
+    inflateReset(&Stream);
+    const uint8_t* const end {data + size};
+    Stream.next_in = data + offset;
+    Stream.avail_in = 0;
+    for (;;) {
+      // avail_in only has 32 bits, so large inputs are passed in pieces
+      if (Stream.avail_in == 0) {
+        Stream.avail_in = static_cast<uInt>(std::min<std::size_t>(static_cast<std::size_t>(end - Stream.next_in), UINT_MAX));
+      }
+      Stream.next_out = window.data();
+      Stream.avail_out = static_cast<uInt>(window.size());
+      const int result {::inflate(&Stream, Z_NO_FLUSH)};
+
+      const std::size_t written {window.size() - Stream.avail_out};
+      state.update(window.data(), written);
+      length += written;
+      if (output != nullptr && written != 0) {
+        (*output)(window.data(), written);
+      }
+
+      switch (result) {
+        case Z_STREAM_END:
+          offset = static_cast<std::size_t>(Stream.next_in - data);
+          return Status::Ok;
+        case Z_OK:
+        case Z_BUF_ERROR:
+          // inflate stops early only if it ran out of input or output space
+          if (Stream.next_in == end && Stream.avail_out != 0) {
+            error = "unexpected end of data";
+            return Status::Truncated;
+          }
+          break;
+        case Z_MEM_ERROR:
+          throw std::bad_alloc {};
+        default:
+          error = Stream.msg != nullptr ? Stream.msg : "invalid deflate data";
+          return Status::Corrupt;
+      }
+    }
+  }
+
+private:
+  z_stream Stream {};
+};
+
+/// \brief Skips the gzip header at an offset.
+/// \param offset Offset of the header, receives the offset after it
+Status skipGzipHeader(const uint8_t* data, std::size_t length, std::size_t& offset,
+                      std::string& error) {
+  const std::size_t start {offset};
+  if (length - offset < 10) {
+    error = "truncated gzip header";
+    return Status::Truncated;
+  }
+  if (!isGzipStart(data + offset, length - offset)) {
+    error = "not a gzip header";
+    return Status::Corrupt;
+  }
+  const uint8_t flags {data[offset + 3]};
+  offset += 10;
+
+  if ((flags & FlagExtra) != 0) {
+    if (length - offset < 2) {
+      error = "truncated gzip header";
+      return Status::Truncated;
+    }
+    const std::size_t extra {static_cast<std::size_t>(data[offset] | (data[offset + 1] << 8))};
+    offset += 2;
+    if (length - offset < extra) {
+      error = "truncated gzip header";
+      return Status::Truncated;
+    }
+    offset += extra;
+  }
+  for (const uint8_t flag : {FlagName, FlagComment}) {
+    if ((flags & flag) != 0) {
+      const void* terminator {std::memchr(data + offset, 0, length - offset)};
+      if (terminator == nullptr) {
+        error = "truncated gzip header";
+        return Status::Truncated;
+      }
+      offset = static_cast<std::size_t>(static_cast<const uint8_t*>(terminator) - data) + 1;
+    }
+  }
+  if ((flags & FlagHeaderCrc) != 0) {
+    if (length - offset < 2) {
+      error = "truncated gzip header";
+      return Status::Truncated;
+    }
+    // the header CRC is the lower half of the CRC32 of the header
+    kernel::CRC32State crc {};
+    crc.update(data + start, offset - start);
+    if ((crc.finalize() & 0xFFFF) != static_cast<uint32_t>(data[offset] | (data[offset + 1] << 8))) {
+      error = "header CRC mismatch";
+      return Status::Corrupt;
+    }
+    offset += 2;
+  }
+  return Status::Ok;
+}
+
+/// Outcome of inflating a single gzip member
+struct MemberResult {
+  Status State;
+  /// Offset after the trailer of the member
+  std::size_t End;
+  /// Number of inflated bytes
+  uint64_t Length;
+  std::string Error;
+  /// Exception thrown while inflating the member in parallel
+  std::exception_ptr Exception;
+};
+
+/// \brief Inflates and verifies the gzip member at an offset.
+MemberResult inflateGzipMember(RawInflater& inflater, const uint8_t* data, std::size_t length,
+                               std::size_t offset, std::vector<uint8_t>& window,
+                               const InflateOutput* output) {
+  MemberResult result {Status::Ok, offset, 0, {}, {}};
+  result.State = skipGzipHeader(data, length, result.End, result.Error);
+  if (result.State != Status::Ok) {
+    return result;
+  }
+  kernel::CRC32State crc {};
+  result.State = inflater.inflate(data, length, result.End, crc, result.Length, window, output,
+                                  result.Error);
+  if (result.State != Status::Ok) {
+    return result;
+  }
+
+  if (length - result.End < 8) {
+    result.State = Status::Truncated;
+    result.Error = "truncated gzip trailer";
+    return result;
+  }
+  const uint32_t expectedCrc {readLittleEndian32(data + result.End)};
+  const uint32_t expectedLength {readLittleEndian32(data + result.End + 4)};
+  result.End += 8;
+  if (crc.finalize() != expectedCrc) {
+    result.State = Status::Mismatch;
+    result.Error = "CRC32 mismatch";
+  } else if (static_cast<uint32_t>(result.Length) != expectedLength) {
+    result.State = Status::Mismatch;
+    result.Error = "length mismatch";
+  }
+  return result;
+}
+
+/// \brief Adds a member to the result of gzip data.
+/// \return True if the member is ok
+bool addMember(InflateResult& result, const MemberResult& member, std::size_t offset) {
+  result.Length += member.Length;
+  if (member.State != Status::Ok) {
+    result.State = member.State;
+    result.Error = "member at offset " + std::to_string(offset) + ": " + member.Error;
+    return false;
+  }
+  ++result.Members;
+  return true;
+}
+
+/// \brief Sets the result of gzip data that continues after a member without
+/// another member.
+InflateResult trailingData(InflateResult result, std::size_t offset) {
+  result.State = Status::Corrupt;
+  result.Error = "data after the last member at offset " + std::to_string(offset);
+  return result;
+}
+
+InflateResult inflateGzip(const uint8_t* data, std::size_t length, std::size_t windowSize,
+                          const InflateOutput* output) {
+  RawInflater inflater;
+  std::vector<uint8_t> window(windowSize);
+  InflateResult result {Status::Ok, 0, 0, {}};
+  std::size_t offset {0};
+  do {
+    if (offset != 0 && !isGzipStart(data + offset, length - offset)) {
+      return trailingData(std::move(result), offset);
+    }
+    const MemberResult member {inflateGzipMember(inflater, data, length, offset, window, output)};
+    if (!addMember(result, member, offset)) {
+      return result;
+    }
+    offset = member.End;
+  } while (offset < length);
+  return result;
+}
+
+/// \brief Returns the offset of the first gzip header candidate at or after
+/// an offset.
+/// \return Offset of the candidate, \p length if there is none
+std::size_t findGzipStart(const uint8_t* data, std::size_t length, std::size_t offset) {
+  while (offset < length) {
+    const auto* position = static_cast<const uint8_t*>(std::memchr(data + offset, 0x1F,
+                                                                   length - offset));
+    if (position == nullptr) {
+      break;
+    }
+    offset = static_cast<std::size_t>(position - data);
+    if (isGzipStart(position, length - offset)) {
+      return offset;
+    }
+    ++offset;
+  }
+  return length;
+}
+
+InflateResult verifyGzip(const uint8_t* data, std::size_t length,
+                         const InflateOptions& options, std::size_t windowSize) {
+  const unsigned threads {options.Threads == 0 ? detail::defaultThreadCount() : options.Threads};
+  if (threads == 1 || !isGzipStart(data, length)) {
+    return inflateGzip(data, length, windowSize, nullptr);
+  }
+
+  // every member starts with a gzip header, but not everything that looks
+  // like one is a member, e.g. in stored blocks of compressed data. So the
+  // members are verified in waves: the member at the current offset and the
+  // candidates following it are inflated speculatively, one per thread, and
+  // candidates inside the members verified so far are never inflated.
+  std::vector<RawInflater> inflaters(threads);
+  std::vector<std::vector<uint8_t>> windows(threads, std::vector<uint8_t>(windowSize));
+  std::vector<MemberResult> members(threads);
+  std::vector<std::size_t> starts;
+  InflateResult result {Status::Ok, 0, 0, {}};
+  std::size_t offset {0};
+  do {
+    starts.assign(1, offset);
+    while (starts.size() < threads) {
+      const std::size_t next {findGzipStart(data, length, starts.back() + 1)};
+      if (next == length) {
+        break;
+      }
+      starts.push_back(next);
+    }
+    detail::parallelFor(starts.size(), threads, [&](std::size_t index) {
+      try {
+        members[index] = inflateGzipMember(inflaters[index], data, length, starts[index],
+                                           windows[index], nullptr);
+      } catch (...) {
+        members[index] = {};
+        members[index].Exception = std::current_exception();
+      }
+    });
+
+    // the members follow each other from the start of the data
+    std::size_t index {0};
+    do {
+      const MemberResult& member {members[index]};
+      if (member.Exception) {
+        std::rethrow_exception(member.Exception);
+      }
+      if (!addMember(result, member, offset)) {
+        return result;
+      }
+      offset = member.End;
+      index = static_cast<std::size_t>(
+          std::lower_bound(starts.begin() + static_cast<std::ptrdiff_t>(index) + 1, starts.end(),
+                           offset) - starts.begin());
+    } while (offset < length && index < starts.size() && starts[index] == offset);
+    if (offset < length && !isGzipStart(data + offset, length - offset)) {
+      return trailingData(std::move(result), offset);
+    }
+  } while (offset < length);
+  return result;
+}
+
+InflateResult inflateZlib(const uint8_t* data, std::size_t length, std::size_t windowSize,
+                          const InflateOutput* output) {
+  InflateResult result {Status::Ok, 0, 0, {}};
+  if (length < 2) {
+    result.State = Status::Truncated;
+    result.Error = "truncated zlib header";
+    return result;
+  }
+  const uint8_t method {data[0]}, flags {data[1]};
+  if ((method & 0x0F) != 8 || (method >> 4) > 7 || ((method << 8) | flags) % 31 != 0) {
+    result.State = Status::Corrupt;
+    result.Error = "not a zlib header";
+    return result;
+  }
+  if ((flags & 0x20) != 0) {
+    result.State = Status::Corrupt;
+    result.Error = "preset dictionaries are not supported";
+    return result;
+  }
+
+  RawInflater inflater;
+  std::vector<uint8_t> window(windowSize);
+  kernel::Adler32State adler {};
+  std::size_t offset {2};
+  result.State = inflater.inflate(data, length, offset, adler, result.Length, window, output,
+                                  result.Error);
+  if (result.State != Status::Ok) {
+    return result;
+  }
+  if (length - offset < 4) {
+    result.State = Status::Truncated;
+    result.Error = "truncated zlib trailer";
+  } else if (adler.finalize() != readBigEndian32(data + offset)) {
+    result.State = Status::Mismatch;
+    result.Error = "Adler32 mismatch";
+  } else if (offset + 4 != length) {
+    result.State = Status::Corrupt;
+    result.Error = "data after the end of the stream at offset " + std::to_string(offset + 4);
+  } else {
+    result.Members = 1;
+  }
+  return result;
+}
+
+/// \brief Limits a window size to the range zlib supports.
+std::size_t clampWindow(std::size_t windowSize) {
+  return std::min<std::size_t>(std::max<std::size_t>(windowSize, 1), UINT_MAX);
+}
+
+} // namespace
+
+InflateResult verifyCompressed(const uint8_t* data, std::size_t length,
+                               CompressedFormat format, const InflateOptions& options) {
+  const std::size_t windowSize {clampWindow(options.WindowSize)};
+  if (format == CompressedFormat::Zlib) {
+    return inflateZlib(data, length, windowSize, nullptr);
+  }
+  return verifyGzip(data, length, options, windowSize);
+}
+
+InflateResult inflateVerified(const uint8_t* data, std::size_t length,
+                              CompressedFormat format, const InflateOutput& output,
+                              std::size_t windowSize) {
+  windowSize = clampWindow(windowSize);
+  if (format == CompressedFormat::Zlib) {
+    return inflateZlib(data, length, windowSize, &output);
+  }
+  return inflateGzip(data, length, windowSize, &output);
+}
+
+} // namespace libchecksum
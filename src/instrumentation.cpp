@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the instrumentation
+ *
+ * This source file implements the counters of the instrumentation declared in
+ * instrumentation.h.
+ */
+
+#include <libchecksum/instrumentation.h>
+#include "instrumentation_hooks.h"
+
+namespace libchecksum {
+
+#ifdef LIBCHECKSUM_INSTRUMENTATION
+
+namespace {
+
+/// Counters of a single algorithm, on their own cache lines
+struct alignas(64) AtomicCounters {
+  std::atomic<uint64_t> Calls;
+  std::atomic<uint64_t> Bytes;
+  std::atomic<uint64_t> Nanoseconds;
+  std::atomic<uint64_t> TierCalls[KernelTierCount];
+  std::atomic<uint64_t> Latency[instrumentation::LatencyBucketCount];
+};
+
+AtomicCounters Counters[AlgorithmCount] {};
+
+/// \brief Returns the histogram bucket of a latency.
+std::size_t getBucket(uint64_t nanoseconds) {
+  std::size_t bucket {0};
+  while (nanoseconds > 1 && bucket + 1 < instrumentation::LatencyBucketCount) {
+    nanoseconds >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+} // namespace
+
+namespace detail {
+
+std::atomic<bool> InstrumentationEnabled {false};
+
+void recordCall(AlgorithmId id, std::size_t bytes, KernelTier tier,
+                std::chrono::steady_clock::duration duration) {
+  const auto nanoseconds = static_cast<uint64_t>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+  AtomicCounters& counters = Counters[static_cast<std::size_t>(id)];
+  counters.Calls.fetch_add(1, std::memory_order_relaxed);
+  counters.Bytes.fetch_add(bytes, std::memory_order_relaxed);
+  counters.Nanoseconds.fetch_add(nanoseconds, std::memory_order_relaxed);
+  counters.TierCalls[static_cast<std::size_t>(tier)].fetch_add(1, std::memory_order_relaxed);
+  counters.Latency[getBucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+namespace instrumentation {
+
+bool isAvailable() {
+  return true;
+}
+
+void enable(bool enabled) {
+  detail::InstrumentationEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool isEnabled() {
+  return detail::InstrumentationEnabled.load(std::memory_order_relaxed);
+}
+
+Snapshot getSnapshot() {
+  Snapshot snapshot {};
+  for (std::size_t i = 0; i < AlgorithmCount; ++i) {
+    const AtomicCounters& counters = Counters[i];
+    AlgorithmCounters& result = snapshot.Algorithms[i];
+    result.Calls = counters.Calls.load(std::memory_order_relaxed);
+    result.Bytes = counters.Bytes.load(std::memory_order_relaxed);
+    result.Nanoseconds = counters.Nanoseconds.load(std::memory_order_relaxed);
+    for (std::size_t tier = 0; tier < KernelTierCount; ++tier) {
+      result.TierCalls[tier] = counters.TierCalls[tier].load(std::memory_order_relaxed);
+    }
+    for (std::size_t bucket = 0; bucket < LatencyBucketCount; ++bucket) {
+      result.Latency[bucket] = counters.Latency[bucket].load(std::memory_order_relaxed);
+    }
+  }
+  return snapshot;
+}
+
+void reset() {
+  for (auto& counters : Counters) {
+    counters.Calls.store(0, std::memory_order_relaxed);
+    counters.Bytes.store(0, std::memory_order_relaxed);
+    counters.Nanoseconds.store(0, std::memory_order_relaxed);
+    for (auto& tierCalls : counters.TierCalls) {
+      tierCalls.store(0, std::memory_order_relaxed);
+    }
+    for (auto& bucket : counters.Latency) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace instrumentation
+
+#else
+
+namespace instrumentation {
+
+bool isAvailable() {
+  return false;
+}
+
+void enable(bool) {}
+
+bool isEnabled() {
+  return false;
+}
+
+Snapshot getSnapshot() {
+  return Snapshot {};
+}
+
+void reset() {}
+
+} // namespace instrumentation
+
+#endif
+
+} // namespace libchecksum
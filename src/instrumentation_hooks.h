@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal hooks of the instrumentation
+ *
+ * This private header declares the hooks the algorithms use for recording
+ * their calls. Without \p LIBCHECKSUM_INSTRUMENTATION they only fire the USDT
+ * probes of probes.h, and without those as well they compile to nothing.
+ */
+
+#ifndef CHECKSUM_INSTRUMENTATION_HOOKS_H
+#define CHECKSUM_INSTRUMENTATION_HOOKS_H
+
+#include <libchecksum/instrumentation.h>
+#include "probes.h"
+
+#ifdef LIBCHECKSUM_INSTRUMENTATION
+#include <atomic>
+#include <chrono>
+#endif
+
+namespace libchecksum {
+
+namespace detail {
+
+#ifdef LIBCHECKSUM_INSTRUMENTATION
+
+/// Whether calls are recorded, read on every call
+extern std::atomic<bool> InstrumentationEnabled;
+
+/// \brief Records a finished call.
+void recordCall(AlgorithmId id, std::size_t bytes, KernelTier tier,
+                std::chrono::steady_clock::duration duration);
+
+/// Records the call of an algorithm for the lifetime of the object
+class InstrumentationScope final {
+
+public:
+  InstrumentationScope(AlgorithmId id, std::size_t bytes,
+                       CallKind kind = CallKind::Compute,
+                       KernelTier tier = KernelTier::Scalar)
+    : Probe {id, bytes, kind}, Id {id}, Bytes {bytes}, Tier {tier},
+      Enabled {InstrumentationEnabled.load(std::memory_order_relaxed)} {
+    if (Enabled) {
+      Start = std::chrono::steady_clock::now();
+    }
+  }
+
+  InstrumentationScope(const InstrumentationScope&) = delete;
+  InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+
+  ~InstrumentationScope() {
+    if (Enabled) {
+      recordCall(Id, Bytes, Tier, std::chrono::steady_clock::now() - Start);
+    }
+  }
+
+  /// \brief Sets the kernel tier the call ended up using.
+  void setTier(KernelTier tier) {
+    Tier = tier;
+  }
+
+private:
+  // constructed first and destroyed last, so the probes enclose the timing
+  ProbeScope Probe;
+  AlgorithmId Id;
+  std::size_t Bytes;
+  KernelTier Tier;
+  bool Enabled;
+  std::chrono::steady_clock::time_point Start {};
+};
+
+#else
+
+/// Only fires the probes, the instrumentation is not compiled in
+class InstrumentationScope final {
+
+public:
+  InstrumentationScope(AlgorithmId id, std::size_t bytes,
+                       CallKind kind = CallKind::Compute,
+                       KernelTier = KernelTier::Scalar)
+    : Probe {id, bytes, kind} {}
+  InstrumentationScope(const InstrumentationScope&) = delete;
+  InstrumentationScope& operator=(const InstrumentationScope&) = delete;
+
+  void setTier(KernelTier) {}
+
+private:
+  ProbeScope Probe;
+};
+
+#endif
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_INSTRUMENTATION_HOOKS_H
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the Internet checksum
+ *
+ * This source file implements the Internet checksum declared in the main
+ * header, with an AVX2 kernel selected at runtime.
+ */
+
+#include <libchecksum/checksums.h>
+#include "cpu.h"
+#include "instrumentation_hooks.h"
+#include "stream.h"
+#include "tiers.h"
+
+#include <cstring>
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace libchecksum {
+
+namespace {
+
+// The kernels sum little-endian words and swap the bytes of the folded sum,
+// which equals the sum of the big-endian words (RFC 1071, section 2 (B)).
+
+/// \brief Swaps the bytes of a folded sum of little-endian words.
+uint64_t swapFolded(uint64_t sum) {
+  const uint32_t folded {kernel::foldOnesComplement(sum)};
+  return ((folded & 0xFF) << 8) | (folded >> 8);
+}
+
+/// \brief Sums the last words of a buffer that do not fill a whole block.
+uint64_t sumTail(const uint8_t* data, std::size_t length) {
+  uint64_t sum {0};
+  for (std::size_t i = 1; i < length; i += 2) {
+    sum += data[i - 1] | (static_cast<uint32_t>(data[i]) << 8);
+  }
+  if (length % 2 != 0) {
+    sum += data[length - 1];
+  }
+  return sum;
+}
+
+/// \brief Sums the big-endian words of a buffer 8 bytes at a time.
+///
+/// The 32 bit halves of each 8 bytes are added, as a sum of 32 bit words
+/// folds to the same sum as the 16 bit words. The sum takes the carry out of
+/// 64 bits, which buffers of more than 16 GiB produce.
+uint64_t sumWordsPortable(const uint8_t* data, std::size_t length) {
+  uint64_t sum {0};
+  for (; length >= 8; data += 8, length -= 8) {
+    uint32_t words[2];
+    std::memcpy(words, data, sizeof(words));
+    sum = kernel::addEndAroundCarry(sum, static_cast<uint64_t>(words[0]) + words[1]);
+  }
+  return swapFolded(sum + sumTail(data, length));
+}
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+/// \brief Sums the big-endian words of a buffer 32 bytes at a time.
+///
+/// The words are widened into two vectors of 32 bit accumulators, which
+/// can take 65536 words each before they have to be folded.
+__attribute__((target("avx2")))
+uint64_t sumWordsAVX2(const uint8_t* data, std::size_t length) {
+  constexpr std::size_t MaxBlocks {65536};
+  const __m256i zero {_mm256_setzero_si256()};
+  uint64_t sum {0};
+  while (length >= 32) {
+    std::size_t blocks {length / 32 < MaxBlocks ? length / 32 : MaxBlocks};
+    length -= blocks * 32;
+    __m256i low {zero}, high {zero};
+    for (; blocks != 0; --blocks, data += 32) {
+      const __m256i words {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))};
+      low = _mm256_add_epi32(low, _mm256_unpacklo_epi16(words, zero));
+      high = _mm256_add_epi32(high, _mm256_unpackhi_epi16(words, zero));
+    }
+    alignas(32) uint32_t lanes[16];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), low);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes + 8), high);
+    for (const uint32_t lane : lanes) {
+      sum += lane;
+    }
+  }
+  return swapFolded(sum + sumTail(data, length));
+}
+#endif
+
+/// \brief Adds a buffer to a state with the best kernel for the CPU.
+/// \return Kernel tier used for the update
+KernelTier updateInternet(kernel::InternetChecksumState& state, const uint8_t* data,
+                          std::size_t length) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  // the word kernels assume a little-endian CPU
+  state.update(data, length);
+  return KernelTier::Scalar;
+#endif
+#ifdef LIBCHECKSUM_X86_KERNELS
+  if (detail::internetChecksumTier() == KernelTier::AVX2) {
+    state.addSum(sumWordsAVX2(data, length), length);
+    return KernelTier::AVX2;
+  }
+#endif
+  state.addSum(sumWordsPortable(data, length), length);
+  return KernelTier::Scalar;
+}
+
+/// \brief Returns the ones' complement sum of a range at an offset of the data.
+uint16_t sumRange(std::size_t offset, const uint8_t* data, std::size_t length) {
+  kernel::InternetChecksumState state {};
+  // a range at an odd offset is byte-swapped in the data
+  state.addSum(0, offset % 2);
+  updateInternet(state, data, length);
+  return static_cast<uint16_t>(~state.finalize());
+}
+
+} // namespace
+
+namespace detail {
+
+KernelTier internetChecksumTier() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return KernelTier::Scalar;
+#else
+  return cpuFeatures().AVX2 ? KernelTier::AVX2 : KernelTier::Scalar;
+#endif
+}
+
+} // namespace detail
+
+uint16_t InternetChecksum::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::InternetChecksum, length};
+  State state {};
+  scope.setTier(updateInternet(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<uint16_t>> InternetChecksum::createStream() const {
+  return detail::makeStream<State, updateInternet>(AlgorithmId::InternetChecksum);
+}
+
+uint16_t InternetChecksum::patch(uint16_t checksum, std::size_t offset,
+                                 const uint8_t* oldData, const uint8_t* newData,
+                                 std::size_t length) {
+  // HC' = ~(~HC + ~m + m') with the sums m and m' of the old and new range
+  return static_cast<uint16_t>(~kernel::foldOnesComplement(
+      uint64_t {static_cast<uint16_t>(~checksum)}
+      + static_cast<uint16_t>(~sumRange(offset, oldData, length))
+      + sumRange(offset, newData, length)));
+}
+
+} // namespace libchecksum
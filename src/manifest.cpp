@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements manifest verification
+ *
+ * This source file implements the manifest parser and verifier declared in
+ * manifest.h.
+ */
+
+#include <libchecksum/manifest.h>
+#include "parallel.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/fiemap.h>
+#include <linux/fs.h>
+#endif
+
+namespace libchecksum {
+
+namespace {
+
+bool isHexDigit(uint8_t c) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/// \brief Lowercases a hexadecimal checksum and pads it to the number of
+/// digits of its type, if the format omits leading zeroes.
+/// \return The normalized checksum, empty if it has the wrong length
+std::string normalizeHex(const std::string& hex, const detail::HexFormat& format) {
+  if (hex.size() > format.Digits || (!format.Unpadded && hex.size() != format.Digits)) {
+    return {};
+  }
+  std::string result(format.Digits - hex.size(), '0');
+  std::transform(hex.begin(), hex.end(), std::back_inserter(result), [](char c) {
+    return static_cast<char>(c >= 'A' && c <= 'F' ? c - 'A' + 'a' : c);
+  });
+  return result;
+}
+
+/// Position of a file on disk used for ordering the verification
+struct Location {
+  uint64_t Device {0};
+  uint64_t Offset {0};
+
+  bool operator<(const Location& other) const {
+    return Device != other.Device ? Device < other.Device : Offset < other.Offset;
+  }
+};
+
+/// \brief Determines the physical location of the start of a file.
+///
+/// Uses the FIEMAP ioctl where available and falls back to the inode number,
+/// which roughly follows the on-disk layout on most file systems. Files that
+/// cannot be opened are sorted to the front, so their errors are reported
+/// early.
+Location locate(const std::string& path) {
+  Location location {};
+  const int fd {::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (fd < 0) {
+    return location;
+  }
+  struct stat info {};
+  if (::fstat(fd, &info) == 0) {
+    location.Device = static_cast<uint64_t>(info.st_dev);
+    location.Offset = static_cast<uint64_t>(info.st_ino);
+  }
+#if defined(FS_IOC_FIEMAP)
+  // room for the header and a single extent, which is all we need
+  alignas(struct fiemap) unsigned char buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)] {};
+  auto* map = reinterpret_cast<struct fiemap*>(buffer);
+  map->fm_start = 0;
+  map->fm_length = FIEMAP_MAX_OFFSET;
+  map->fm_extent_count = 1;
+  if (::ioctl(fd, FS_IOC_FIEMAP, map) == 0 && map->fm_mapped_extents == 1) {
+    location.Offset = map->fm_extents[0].fe_physical;
+  }
+#endif
+  ::close(fd);
+  return location;
+}
+
+} // namespace
+
+std::vector<ManifestEntry> parseManifest(const uint8_t* data, std::size_t length,
+                                         std::size_t& malformed) {
+  std::vector<ManifestEntry> entries;
+  const uint8_t* const end {data + length};
+  std::size_t lineNumber {0};
+
+  // memchr is vectorized by the C library, so lines are found with SIMD scans
+  for (const uint8_t* line = data; line < end;) {
+    const auto* newline = static_cast<const uint8_t*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)));
+    const uint8_t* lineEnd {newline != nullptr ? newline : end};
+    ++lineNumber;
+    if (lineEnd > line && lineEnd[-1] == '\r') {
+      --lineEnd;
+    }
+
+    if (lineEnd != line) {
+      const uint8_t* separator {line};
+      while (separator < lineEnd && isHexDigit(*separator)) {
+        ++separator;
+      }
+      if (separator != line && lineEnd - separator > 2 && separator[0] == ' '
+          && (separator[1] == ' ' || separator[1] == '*')) {
+        entries.push_back({std::string(line, separator),
+                           std::string(separator + 2, lineEnd), lineNumber});
+      } else {
+        ++malformed;
+      }
+    }
+    line = newline != nullptr ? newline + 1 : end;
+  }
+  return entries;
+}
+
+namespace detail {
+
+ManifestSummary verifyManifest(const std::string& path, const HexFunction& hex,
+                               const HexFormat& format,
+                               const ManifestCallback& callback,
+                               const ManifestOptions& options) {
+  ManifestSummary summary {};
+  std::vector<ManifestEntry> entries;
+  {
+    const MappedFile manifest {path};
+    entries = parseManifest(manifest.data(), manifest.size(), summary.Malformed);
+  }
+  summary.Entries = entries.size();
+
+  std::vector<std::size_t> order(entries.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (options.OrderByLocation) {
+    std::vector<Location> locations(entries.size());
+    parallelFor(entries.size(), options.Threads, [&](std::size_t index) {
+      locations[index] = locate(entries[index].Path);
+    });
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+      return locations[a] < locations[b];
+    });
+  }
+
+  std::mutex mutex;
+  parallelFor(order.size(), options.Threads, [&](std::size_t index) {
+    const ManifestEntry& entry = entries[order[index]];
+    ManifestResult result {ManifestResult::Status::Ok, entry, "", ""};
+    try {
+      const MappedFile file {entry.Path};
+      result.Actual = hex(file.data(), file.size());
+      const std::string expected {normalizeHex(entry.Checksum, format)};
+      if (expected.empty() || normalizeHex(result.Actual, format) != expected) {
+        result.State = ManifestResult::Status::Mismatch;
+      }
+    } catch (const std::system_error& error) {
+      result.State = ManifestResult::Status::Unreadable;
+      result.Error = error.code().message();
+    } catch (const std::exception& error) {
+      // parallelFor() needs a body that does not throw
+      result.State = ManifestResult::Status::Unreadable;
+      result.Error = error.what();
+    }
+
+    std::lock_guard<std::mutex> lock {mutex};
+    switch (result.State) {
+      case ManifestResult::Status::Ok:
+        ++summary.Matched;
+        if (!options.ReportMatches) {
+          return;
+        }
+        break;
+      case ManifestResult::Status::Mismatch:
+        ++summary.Mismatched;
+        break;
+      case ManifestResult::Status::Unreadable:
+        ++summary.Unreadable;
+        break;
+    }
+    if (callback) {
+      callback(result);
+    }
+  });
+  return summary;
+}
+
+} // namespace detail
+
+} // namespace libchecksum
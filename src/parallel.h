@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal helpers for parallel execution
+ *
+ * This private header declares helpers used by the parallel parts of
+ * \p libchecksum.
+ */
+
+#ifndef CHECKSUM_PARALLEL_H
+#define CHECKSUM_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace libchecksum {
+
+namespace detail {
+
+/// \brief Returns the number of threads to use if the caller did not specify
+/// one.
+/// \return Number of hardware threads, at least 1
+inline unsigned defaultThreadCount() {
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+/// \brief Calls \p body for every index in [0, count) on up to \p threads
+/// threads.
+///
+/// Indices are handed out in increasing order, so work that is sorted by
+/// some locality criterion is processed roughly in that order. The calling
+/// thread takes part in the work. \p body must not throw.
+/// \param count Number of work items
+/// \param threads Maximum number of threads, 0 for the hardware default
+/// \param body Function processing a single work item
+inline void parallelFor(std::size_t count, unsigned threads,
+                        const std::function<void(std::size_t)>& body) {
+  if (threads == 0) {
+    threads = defaultThreadCount();
+  }
+  std::atomic<std::size_t> next {0};
+  auto worker = [&]() {
+    for (std::size_t index = next++; index < count; index = next++) {
+      body(index);
+    }
+  };
+
+  std::vector<std::thread> pool;
+  const std::size_t poolSize {std::min<std::size_t>(threads, count)};
+  for (std::size_t i = 1; i < poolSize; ++i) {
+    pool.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : pool) {
+    thread.join();
+  }
+}
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_PARALLEL_H
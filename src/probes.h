@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal USDT probes
+ *
+ * This private header declares the static user-space probes of
+ * \p libchecksum. With \p LIBCHECKSUM_USDT they are placed with the macros of
+ * <sys/sdt.h>, which compile to a single NOP per probe and can be attached to
+ * with perf, bpftrace or SystemTap. Otherwise they compile to nothing.
+ *
+ * All probes belong to the provider \p libchecksum. The first argument is the
+ * AlgorithmId of the algorithm, the second one the number of bytes:
+ *
+ * - \p compute__entry / \p compute__return: ChecksumAlgorithm::operator()
+ * - \p update__entry / \p update__return: ChecksumStream::update()
+ * - \p finalize__entry / \p finalize__return: ChecksumStream::finalize(),
+ *   without byte count
+ */
+
+#ifndef CHECKSUM_PROBES_H
+#define CHECKSUM_PROBES_H
+
+#include <libchecksum/common.h>
+
+#ifdef LIBCHECKSUM_USDT
+#include <sys/sdt.h>
+#endif
+
+namespace libchecksum {
+
+namespace detail {
+
+/// Kinds of calls that are traced
+enum class CallKind {
+  Compute,
+  Update
+};
+
+#ifdef LIBCHECKSUM_USDT
+
+/// Fires the entry probe of a call on construction and its return probe on
+/// destruction
+class ProbeScope final {
+
+public:
+  ProbeScope(AlgorithmId id, std::size_t bytes, CallKind kind)
+    : Id {static_cast<unsigned>(id)}, Bytes {bytes}, Kind {kind} {
+    if (Kind == CallKind::Compute) {
+      DTRACE_PROBE2(libchecksum, compute__entry, Id, Bytes);
+    } else {
+      DTRACE_PROBE2(libchecksum, update__entry, Id, Bytes);
+    }
+  }
+
+  ProbeScope(const ProbeScope&) = delete;
+  ProbeScope& operator=(const ProbeScope&) = delete;
+
+  ~ProbeScope() {
+    if (Kind == CallKind::Compute) {
+      DTRACE_PROBE2(libchecksum, compute__return, Id, Bytes);
+    } else {
+      DTRACE_PROBE2(libchecksum, update__return, Id, Bytes);
+    }
+  }
+
+private:
+  unsigned Id;
+  std::size_t Bytes;
+  CallKind Kind;
+};
+
+inline void probeFinalizeEntry(AlgorithmId id) {
+  DTRACE_PROBE1(libchecksum, finalize__entry, static_cast<unsigned>(id));
+}
+
+inline void probeFinalizeReturn(AlgorithmId id) {
+  DTRACE_PROBE1(libchecksum, finalize__return, static_cast<unsigned>(id));
+}
+
+#else
+
+/// Does nothing, the probes are not compiled in
+class ProbeScope final {
+
+public:
+  ProbeScope(AlgorithmId, std::size_t, CallKind) {}
+  ProbeScope(const ProbeScope&) = delete;
+  ProbeScope& operator=(const ProbeScope&) = delete;
+};
+
+inline void probeFinalizeEntry(AlgorithmId) {}
+
+inline void probeFinalizeReturn(AlgorithmId) {}
+
+#endif
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_PROBES_H
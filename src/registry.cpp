@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the algorithm registry
+ *
+ * This source file implements the registry declared in registry.h.
+ */
+
+#include <libchecksum/registry.h>
+#include "tiers.h"
+
+#include <cctype>
+
+namespace libchecksum {
+
+namespace {
+
+/// Detects whether a state combines the states of consecutive pieces
+template<typename State, typename = void>
+struct HasCombine : std::false_type {};
+
+template<typename State>
+struct HasCombine<State, typename util::VoidType<decltype(std::declval<State&>().combine(
+    std::declval<const State&>(), std::size_t {}))>::Type> : std::true_type {};
+
+/// Detects whether a state slides a window over the data
+template<typename State, typename = void>
+struct HasRoll : std::false_type {};
+
+template<typename State>
+struct HasRoll<State, typename util::VoidType<decltype(std::declval<State&>().roll(
+    uint8_t {}, uint8_t {}, std::size_t {}))>::Type> : std::true_type {};
+
+template<typename T>
+constexpr std::size_t bitsOf(T) {
+  return 8 * sizeof(T);
+}
+
+template<std::size_t N>
+constexpr std::size_t bitsOf(Digest<N>) {
+  return 8 * N;
+}
+
+/// \brief Returns the widest kernel tier an algorithm uses for large inputs.
+///
+/// The tiers come from the functions with which the algorithms choose their
+/// kernels; algorithms without SIMD kernels always run the scalar ones.
+KernelTier selectTier(AlgorithmId id) {
+  switch (id) {
+    case AlgorithmId::BSDSum:
+      return detail::bsdSumTier();
+    case AlgorithmId::InternetChecksum:
+      return detail::internetChecksumTier();
+    case AlgorithmId::XXH3:
+    case AlgorithmId::XXH128:
+      return detail::xxh3Tier();
+    case AlgorithmId::SHA256:
+      return detail::sha256Tier();
+    case AlgorithmId::BLAKE3:
+      return detail::blake3Tier();
+    case AlgorithmId::Adler32:
+    case AlgorithmId::Fletcher16:
+    case AlgorithmId::Fletcher32:
+    case AlgorithmId::Sum8:
+    case AlgorithmId::Sum16:
+    case AlgorithmId::Sum32:
+    case AlgorithmId::XOR8:
+    case AlgorithmId::SYSV:
+    case AlgorithmId::Cksum:
+    case AlgorithmId::CRC32:
+    case AlgorithmId::CRC32C:
+    case AlgorithmId::CRC32BZIP2:
+      break;
+  }
+  return KernelTier::Scalar;
+}
+
+/// Describes the algorithm a visitor is called with
+struct Describe {
+  AlgorithmId Id;
+  const char* Name;
+
+  template<typename Algorithm>
+  AlgorithmInfo operator()(const Algorithm&) const {
+    using State = typename Algorithm::State;
+    return {Id, Name, bitsOf(typename State::ResultType {}), HasCombine<State>::value,
+            std::is_constructible<Algorithm, unsigned>::value, true, HasRoll<State>::value,
+            selectTier(Id)};
+  }
+};
+
+/// Names of the registry, indexed by AlgorithmId
+constexpr const char* Names[AlgorithmCount] = {
+  "adler32", "fletcher16", "fletcher32", "sum8", "sum16", "sum32", "bsdsum",
+  "xor8", "sysv", "cksum", "crc32", "crc32c",
+  "internetchecksum", "xxh3", "xxh128", "sha256", "blake3", "crc32bzip2"
+};
+
+/// Additional names of algorithms
+const struct {
+  const char* Name;
+  AlgorithmId Id;
+} Aliases[] = {
+  {"bsd", AlgorithmId::BSDSum},
+  {"internet", AlgorithmId::InternetChecksum}
+};
+
+std::vector<AlgorithmInfo> describeAll() {
+  std::vector<AlgorithmInfo> algorithms;
+  for (std::size_t i = 0; i < AlgorithmCount; ++i) {
+    const auto id = static_cast<AlgorithmId>(i);
+    algorithms.push_back(registry::visit(id, Describe {id, Names[i]}));
+  }
+  return algorithms;
+}
+
+/// \brief Lowercases a name and strips its dashes and underscores.
+std::string normalize(const std::string& name) {
+  std::string result;
+  for (const char c : name) {
+    if (c != '-' && c != '_') {
+      result.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    }
+  }
+  return result;
+}
+
+/// Stream wrapping the stream of a typed algorithm
+template<typename T>
+class TypedStream final : public AnyChecksumStream {
+
+public:
+  explicit TypedStream(std::unique_ptr<ChecksumStream<T>> stream) : Stream {std::move(stream)} {}
+
+  void update(const uint8_t* data, std::size_t length) override {
+    Stream->update(data, length);
+  }
+
+  std::string getHex() const override {
+    return Stream->getHex();
+  }
+
+  void reset() override {
+    Stream->reset();
+  }
+
+private:
+  std::unique_ptr<ChecksumStream<T>> Stream;
+};
+
+/// Algorithm wrapping a typed algorithm
+template<typename Algorithm>
+class TypedAlgorithm final : public AnyChecksumAlgorithm {
+
+public:
+  TypedAlgorithm(const Algorithm& algorithm, const AlgorithmInfo& info)
+    : Wrapped {algorithm}, Info {info} {}
+
+  const AlgorithmInfo& getInfo() const override {
+    return Info;
+  }
+
+  std::string getHex(const uint8_t* data, std::size_t length) const override {
+    return Wrapped.getHex(data, length);
+  }
+
+  std::unique_ptr<AnyChecksumStream> createStream() const override {
+    using T = typename Algorithm::State::ResultType;
+    return std::unique_ptr<AnyChecksumStream> {new TypedStream<T> {Wrapped.createStream()}};
+  }
+
+private:
+  Algorithm Wrapped;
+  const AlgorithmInfo& Info;
+};
+
+/// Wraps the algorithm a visitor is called with
+struct Wrap {
+  const AlgorithmInfo& Info;
+
+  template<typename Algorithm>
+  std::unique_ptr<AnyChecksumAlgorithm> operator()(const Algorithm& algorithm) const {
+    return std::unique_ptr<AnyChecksumAlgorithm> {new TypedAlgorithm<Algorithm> {algorithm, Info}};
+  }
+};
+
+const AlgorithmInfo& findOrThrow(const std::string& name) {
+  const AlgorithmInfo* info {registry::find(name)};
+  if (info == nullptr) {
+    throw std::invalid_argument {"Unknown algorithm '" + name + "'"};
+  }
+  return *info;
+}
+
+} // namespace
+
+namespace registry {
+
+const std::vector<AlgorithmInfo>& getAlgorithms() {
+  // the CPU features are detected before any static object is initialized,
+  // so the kernel tiers can be determined once
+  static const std::vector<AlgorithmInfo> algorithms {describeAll()};
+  return algorithms;
+}
+
+const AlgorithmInfo& getInfo(AlgorithmId id) {
+  return getAlgorithms().at(static_cast<std::size_t>(id));
+}
+
+const AlgorithmInfo* find(const std::string& name) {
+  const std::string key {normalize(name)};
+  for (const auto& info : getAlgorithms()) {
+    if (key == info.Name) {
+      return &info;
+    }
+  }
+  for (const auto& alias : Aliases) {
+    if (key == alias.Name) {
+      return &getInfo(alias.Id);
+    }
+  }
+  return nullptr;
+}
+
+std::unique_ptr<AnyChecksumAlgorithm> create(const std::string& name) {
+  const AlgorithmInfo& info {findOrThrow(name)};
+  return visit(info.Id, Wrap {info});
+}
+
+std::unique_ptr<AnyChecksumAlgorithm> create(const std::string& name, unsigned threads) {
+  const AlgorithmInfo& info {findOrThrow(name)};
+  return visit(info.Id, threads, Wrap {info});
+}
+
+} // namespace registry
+
+} // namespace libchecksum
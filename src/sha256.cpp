@@ -0,0 +1,325 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the SHA-256 hash
+ *
+ * This source file implements the SHA-256 hash declared in hash.h. Blocks are
+ * compressed with the SHA extensions if the CPU has them, and batches of
+ * buffers are hashed eight at a time with AVX2 otherwise.
+ */
+
+#include <libchecksum/hash.h>
+#include "cpu.h"
+#include "instrumentation_hooks.h"
+#include "simd.h"
+#include "stream.h"
+#include "tiers.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace libchecksum {
+
+namespace {
+
+using kernel::sha::BlockSize;
+using kernel::sha::Constants;
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+/// \brief Compresses blocks with the SHA extensions.
+///
+/// The instructions keep the state in the order ABEF and CDGH and process
+/// four message words per step, two rounds per instruction.
+__attribute__((target("sha,sse4.1")))
+void compressSHA(uint32_t (&state)[8], const uint8_t* data, std::size_t count) {
+  const __m128i byteSwap {_mm_set_epi64x(0x0c0d0e0f08090a0b, 0x0405060700010203)};
+  __m128i dcba {_mm_loadu_si128(reinterpret_cast<const __m128i*>(state))};
+  __m128i hgfe {_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + 4))};
+  const __m128i cdab {_mm_shuffle_epi32(dcba, 0xB1)};
+  const __m128i efgh {_mm_shuffle_epi32(hgfe, 0x1B)};
+  __m128i abef {_mm_alignr_epi8(cdab, efgh, 8)};
+  __m128i cdgh {_mm_blend_epi16(efgh, cdab, 0xF0)};
+
+  for (; count != 0; --count, data += BlockSize) {
+    const __m128i savedAbef {abef};
+    const __m128i savedCdgh {cdgh};
+    __m128i words[4];
+    for (std::size_t group = 0; group < 16; ++group) {
+      __m128i& current = words[group % 4];
+      if (group < 4) {
+        current = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + group), byteSwap);
+      } else {
+        // words[group % 4] still holds the words of group - 4
+        const __m128i& previous = words[(group + 3) % 4];
+        const __m128i shifted {_mm_alignr_epi8(previous, words[(group + 2) % 4], 4)};
+        current = _mm_sha256msg2_epu32(
+            _mm_add_epi32(_mm_sha256msg1_epu32(current, words[(group + 1) % 4]), shifted),
+            previous);
+      }
+      __m128i input {_mm_add_epi32(
+          current, _mm_loadu_si128(reinterpret_cast<const __m128i*>(Constants<>::K) + group))};
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, input);
+      input = _mm_shuffle_epi32(input, 0x0E);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, input);
+    }
+    abef = _mm_add_epi32(abef, savedAbef);
+    cdgh = _mm_add_epi32(cdgh, savedCdgh);
+  }
+
+  const __m128i feba {_mm_shuffle_epi32(abef, 0x1B)};
+  const __m128i dchg {_mm_shuffle_epi32(cdgh, 0xB1)};
+  dcba = _mm_blend_epi16(feba, dchg, 0xF0);
+  hgfe = _mm_alignr_epi8(dchg, feba, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), dcba);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4), hgfe);
+}
+
+/// Number of messages hashed at once by the AVX2 kernel
+constexpr std::size_t Lanes {8};
+
+__attribute__((target("avx2")))
+inline __m256i rotr(__m256i value, int bits) {
+  return _mm256_or_si256(_mm256_srli_epi32(value, bits), _mm256_slli_epi32(value, 32 - bits));
+}
+
+/// \brief Compresses one block of each of 8 messages, one message per lane.
+/// \param state Words A to H of the states of all lanes
+/// \param blocks Blocks of the lanes
+__attribute__((target("avx2")))
+void compress8AVX2(__m256i (&state)[8], const uint8_t* const (&blocks)[Lanes]) {
+  const __m256i byteSwap {_mm256_set_epi8(
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3,
+      12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3)};
+  __m256i w[16];
+  for (std::size_t half = 0; half < 2; ++half) {
+    __m256i rows[8];
+    for (std::size_t lane = 0; lane < Lanes; ++lane) {
+      rows[lane] = _mm256_shuffle_epi8(_mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(blocks[lane]) + half), byteSwap);
+    }
+    detail::transpose8x8(rows);
+    std::copy(rows, rows + 8, w + 8 * half);
+  }
+
+  __m256i a {state[0]}, b {state[1]}, c {state[2]}, d {state[3]};
+  __m256i e {state[4]}, f {state[5]}, g {state[6]}, h {state[7]};
+  for (std::size_t t = 0; t < 64; ++t) {
+    if (t >= 16) {
+      const __m256i w15 {w[(t - 15) % 16]};
+      const __m256i w2 {w[(t - 2) % 16]};
+      const __m256i s0 {_mm256_xor_si256(_mm256_xor_si256(rotr(w15, 7), rotr(w15, 18)),
+                                         _mm256_srli_epi32(w15, 3))};
+      const __m256i s1 {_mm256_xor_si256(_mm256_xor_si256(rotr(w2, 17), rotr(w2, 19)),
+                                         _mm256_srli_epi32(w2, 10))};
+      w[t % 16] = _mm256_add_epi32(_mm256_add_epi32(w[t % 16], s0),
+                                   _mm256_add_epi32(w[(t - 7) % 16], s1));
+    }
+    const __m256i sum1 {_mm256_xor_si256(_mm256_xor_si256(rotr(e, 6), rotr(e, 11)), rotr(e, 25))};
+    const __m256i choose {_mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g))};
+    const __m256i t1 {_mm256_add_epi32(
+        _mm256_add_epi32(_mm256_add_epi32(h, sum1), _mm256_add_epi32(choose, w[t % 16])),
+        _mm256_set1_epi32(static_cast<int>(Constants<>::K[t])))};
+    const __m256i sum0 {_mm256_xor_si256(_mm256_xor_si256(rotr(a, 2), rotr(a, 13)), rotr(a, 22))};
+    const __m256i majority {_mm256_or_si256(_mm256_and_si256(a, b),
+                                            _mm256_and_si256(c, _mm256_or_si256(a, b)))};
+    h = g;
+    g = f;
+    f = e;
+    e = _mm256_add_epi32(d, t1);
+    d = c;
+    c = b;
+    b = a;
+    a = _mm256_add_epi32(t1, _mm256_add_epi32(sum0, majority));
+  }
+  const __m256i result[8] {a, b, c, d, e, f, g, h};
+  for (std::size_t i = 0; i < 8; ++i) {
+    state[i] = _mm256_add_epi32(state[i], result[i]);
+  }
+}
+
+/// Stands in for the blocks of unused lanes
+alignas(64) const uint8_t UnusedBlock[BlockSize] {};
+
+/// Message hashed in one lane of the AVX2 kernel
+struct Lane {
+  const uint8_t* Data {nullptr};
+  /// Number of whole blocks read from Data
+  std::size_t Blocks {0};
+  /// Number of padded blocks in Tail
+  std::size_t TailBlocks {0};
+  uint8_t Tail[2 * BlockSize] {};
+};
+
+/// \brief Hashes up to 8 messages at once, one message per lane.
+__attribute__((target("avx2")))
+void hash8AVX2(const uint8_t* const* data, const std::size_t* lengths, std::size_t count,
+               Digest256* results) {
+  Lane lanes[Lanes];
+  std::size_t maxBlocks {0};
+  for (std::size_t i = 0; i < count; ++i) {
+    Lane& lane = lanes[i];
+    lane.Data = data[i];
+    lane.Blocks = lengths[i] / BlockSize;
+    const std::size_t rest {lengths[i] % BlockSize};
+    if (rest != 0) {
+      std::memcpy(lane.Tail, data[i] + lane.Blocks * BlockSize, rest);
+    }
+    lane.Tail[rest] = 0x80;
+    lane.TailBlocks = rest + 9 > BlockSize ? 2 : 1;
+    const uint64_t bits {static_cast<uint64_t>(lengths[i]) * 8};
+    for (std::size_t byte = 0; byte < 8; ++byte) {
+      lane.Tail[lane.TailBlocks * BlockSize - 1 - byte] = static_cast<uint8_t>(bits >> (8 * byte));
+    }
+    maxBlocks = std::max(maxBlocks, lane.Blocks + lane.TailBlocks);
+  }
+
+  __m256i state[8];
+  for (std::size_t i = 0; i < 8; ++i) {
+    state[i] = _mm256_set1_epi32(static_cast<int>(Constants<>::Initial[i]));
+  }
+  for (std::size_t block = 0; block < maxBlocks; ++block) {
+    const uint8_t* blocks[Lanes];
+    alignas(32) int32_t finished[Lanes];
+    for (std::size_t i = 0; i < Lanes; ++i) {
+      const Lane& lane = lanes[i];
+      finished[i] = i >= count || block >= lane.Blocks + lane.TailBlocks ? -1 : 0;
+      if (finished[i] != 0) {
+        blocks[i] = UnusedBlock;
+      } else if (block < lane.Blocks) {
+        blocks[i] = lane.Data + block * BlockSize;
+      } else {
+        blocks[i] = lane.Tail + (block - lane.Blocks) * BlockSize;
+      }
+    }
+    __m256i previous[8];
+    std::copy(state, state + 8, previous);
+    compress8AVX2(state, blocks);
+    // finished lanes keep their state
+    const __m256i mask {_mm256_load_si256(reinterpret_cast<const __m256i*>(finished))};
+    for (std::size_t i = 0; i < 8; ++i) {
+      state[i] = _mm256_blendv_epi8(state[i], previous[i], mask);
+    }
+  }
+
+  alignas(32) uint32_t words[8][Lanes];
+  for (std::size_t i = 0; i < 8; ++i) {
+    _mm256_store_si256(reinterpret_cast<__m256i*>(words[i]), state[i]);
+  }
+  for (std::size_t lane = 0; lane < count; ++lane) {
+    for (std::size_t i = 0; i < 32; ++i) {
+      results[lane].Bytes[i] = static_cast<uint8_t>(words[i / 4][lane] >> (24 - 8 * (i % 4)));
+    }
+  }
+}
+#endif
+
+/// Compresses blocks with the SHA extensions if the CPU has them
+struct FastCompress {
+  template<typename Byte>
+  static void compress(uint32_t (&state)[8], const Byte* data, std::size_t count) {
+#ifdef LIBCHECKSUM_X86_KERNELS
+    if (detail::cpuFeatures().SHA) {
+      compressSHA(state, reinterpret_cast<const uint8_t*>(data), count);
+      return;
+    }
+#endif
+    kernel::sha::ScalarCompress::compress(state, data, count);
+  }
+};
+
+using FastState = kernel::BasicSHA256State<FastCompress>;
+
+/// \brief Updates a state with the fastest compression of the CPU.
+/// \return Kernel tier used for the update
+KernelTier updateFast(FastState& state, const uint8_t* data, std::size_t length) {
+  state.update(data, length);
+  return detail::sha256Tier();
+}
+
+} // namespace
+
+namespace detail {
+
+KernelTier sha256Tier() {
+  return cpuFeatures().SHA ? KernelTier::SHA : KernelTier::Scalar;
+}
+
+} // namespace detail
+
+Digest256 SHA256::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::SHA256, length};
+  FastState state {};
+  scope.setTier(updateFast(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<Digest256>> SHA256::createStream() const {
+  return detail::makeStream<FastState, updateFast>(AlgorithmId::SHA256);
+}
+
+void SHA256::computeBatch(const uint8_t* const* data, const std::size_t* lengths,
+                          std::size_t count, Digest256* results) const {
+#ifdef LIBCHECKSUM_X86_KERNELS
+  // a single message per core is faster with the SHA extensions
+  if (count > 1 && !detail::cpuFeatures().SHA && detail::cpuFeatures().AVX2) {
+    detail::InstrumentationScope scope {AlgorithmId::SHA256,
+        std::accumulate(lengths, lengths + count, std::size_t {0}), detail::CallKind::Compute,
+        KernelTier::AVX2};
+    // messages of similar length share the lanes, so fewer lanes idle; the
+    // messages are sorted in windows, which needs no allocation
+    constexpr std::size_t Window {8 * Lanes};
+    for (std::size_t start = 0; start < count; start += Window) {
+      const std::size_t size {std::min(Window, count - start)};
+      std::size_t order[Window];
+      std::iota(order, order + size, start);
+      std::sort(order, order + size, [lengths](std::size_t lhs, std::size_t rhs) {
+        return lengths[lhs] < lengths[rhs];
+      });
+      for (std::size_t first = 0; first < size; first += Lanes) {
+        const std::size_t lanes {std::min(Lanes, size - first)};
+        const uint8_t* laneData[Lanes];
+        std::size_t laneLengths[Lanes];
+        Digest256 laneResults[Lanes];
+        for (std::size_t i = 0; i < lanes; ++i) {
+          laneData[i] = data[order[first + i]];
+          laneLengths[i] = lengths[order[first + i]];
+        }
+        hash8AVX2(laneData, laneLengths, lanes, laneResults);
+        for (std::size_t i = 0; i < lanes; ++i) {
+          results[order[first + i]] = laneResults[i];
+        }
+      }
+    }
+    return;
+  }
+#endif
+  ChecksumAlgorithm::computeBatch(data, lengths, count, results);
+}
+
+} // namespace libchecksum
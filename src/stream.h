@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal implementation of checksum streams
+ *
+ * This private header implements ChecksumStream on top of the kernel state
+ * types of kernels.h.
+ */
+
+#ifndef CHECKSUM_STREAM_H
+#define CHECKSUM_STREAM_H
+
+#include <libchecksum/common.h>
+#include "instrumentation_hooks.h"
+
+namespace libchecksum {
+
+namespace detail {
+
+/// \brief Default update function of KernelStream, which calls the portable
+/// kernel.
+/// \return Kernel tier used for the update
+template<typename State>
+KernelTier updateKernel(State& state, const uint8_t* data, std::size_t length) {
+  state.update(data, length);
+  return KernelTier::Scalar;
+}
+
+/// \brief Stream feeding data into a kernel state.
+/// \tparam State Kernel state type of the algorithm
+/// \tparam Update Function updating the state, e.g. with a SIMD kernel
+template<typename State,
+    KernelTier (*Update)(State&, const uint8_t*, std::size_t) = updateKernel<State>>
+class KernelStream final : public ChecksumStream<typename State::ResultType> {
+
+public:
+  using ResultType = typename State::ResultType;
+  using ChecksumStream<ResultType>::update;
+
+  explicit KernelStream(AlgorithmId id) : Id {id} {}
+
+  void update(const uint8_t* data, std::size_t length) override {
+    InstrumentationScope scope {Id, length, CallKind::Update};
+    scope.setTier(Update(Current, data, length));
+  }
+
+  ResultType finalize() const override {
+    probeFinalizeEntry(Id);
+    const ResultType result {Current.finalize()};
+    probeFinalizeReturn(Id);
+    return result;
+  }
+
+  void reset() override {
+    Current = State {};
+  }
+
+private:
+  AlgorithmId Id;
+  State Current {};
+};
+
+/// \brief Creates a stream for the given kernel state type.
+/// \tparam State Kernel state type of the algorithm
+/// \tparam Update Function updating the state
+/// \param id Identifier of the algorithm
+/// \return New stream in its initial state
+template<typename State,
+    KernelTier (*Update)(State&, const uint8_t*, std::size_t) = updateKernel<State>>
+std::unique_ptr<ChecksumStream<typename State::ResultType>> makeStream(AlgorithmId id) {
+  return std::make_unique<KernelStream<State, Update>>(id);
+}
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_STREAM_H
@@ -30,85 +30,329 @@
  */
 
 #include <libchecksum/checksums.h>
+#include "cpu.h"
+#include "instrumentation_hooks.h"
+#include "parallel.h"
+#include "stream.h"
+#include "tiers.h"
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+#include <immintrin.h>
+#endif
 
 namespace libchecksum {
 
-uint32_t Adler32::operator()(const std::vector<uint8_t>& input) const {
-  uint32_t s1 {1}, s2 {0};
-  for (const auto& element : input) {
-    s1 = (s1 + element) % 65521;
-    s2 = (s2 + s1) % 65521;
+namespace {
+
+/// Smallest piece of a large input that is summed on a thread of its own
+constexpr std::size_t MinPieceLength {1 << 20};
+
+/// \brief Calculates the checksum of a buffer, split into pieces that are
+/// summed on up to \p threads threads if it is large enough.
+///
+/// The states of the pieces are combined in order, so the checksum equals
+/// the one of a single pass.
+template<typename State>
+typename State::ResultType computeParallel(const uint8_t* data, std::size_t length,
+                                           unsigned threads) {
+  State state {};
+  if (threads == 1 || length < 2 * MinPieceLength) {
+    state.update(data, length);
+    return state.finalize();
+  }
+  const std::size_t pieces {std::min<std::size_t>(
+      threads == 0 ? detail::defaultThreadCount() : threads, length / MinPieceLength)};
+  const std::size_t pieceLength {length / pieces};
+  std::vector<State> states(pieces);
+  detail::parallelFor(pieces, threads, [&](std::size_t index) {
+    const std::size_t offset {index * pieceLength};
+    states[index].update(data + offset, index + 1 == pieces ? length - offset : pieceLength);
+  });
+  state = states[0];
+  for (std::size_t i = 1; i < pieces; ++i) {
+    state.combine(states[i], i + 1 == pieces ? length - i * pieceLength : pieceLength);
   }
-  return (s2 << 16) | s1;
+  return state.finalize();
 }
 
-uint16_t Fletcher16::operator()(const std::vector<uint8_t>& input) const {
-  uint16_t s1 {0}, s2 {0};
-  for (const auto& element : input) {
-    s1 = static_cast<uint16_t>((s1 + element) % 255);
-    s2 = static_cast<uint16_t>((s2 + s1) % 255);
-  }
-  return static_cast<uint16_t>((s2 << 8) | s1);
+// The BSD sum rotates the checksum right by one bit before adding a byte. A
+// rotation right is a multiplication by 2^-1 modulo 65535, so as long as no
+// addition carries out of 16 bits, the checksum after byte j of a block that
+// starts with the checksum c is 2^-j * (c + sum of 2^(i+1) * b_i for i < j).
+// The block kernels add these per-position contributions with prefix sums in
+// ones' complement arithmetic and rotate each prefix back by its position.
+// A carry leaves a checksum not greater than the added byte, so if every
+// intermediate checksum is greater than its byte, the block had no carry and
+// its checksum is the last prefix, as 16 rotations cancel out. Otherwise the
+// block is summed byte by byte from the exact checksum before it.
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+/// \brief Adds two vectors of 16 bit words in ones' complement arithmetic.
+__attribute__((target("avx2")))
+inline __m256i addOnesComplement(__m256i a, __m256i b) {
+  const __m256i sum {_mm256_add_epi16(a, b)};
+  // the saturated sum differs from the sum exactly in the lanes that carried
+  const __m256i noCarry {_mm256_cmpeq_epi16(sum, _mm256_adds_epu16(a, b))};
+  return _mm256_add_epi16(sum, _mm256_sub_epi16(noCarry, _mm256_set1_epi32(-1)));
 }
 
-uint32_t Fletcher32::operator()(const std::vector<uint8_t>& input) const {
-  uint32_t s1 {0}, s2 {0};
-  for (const auto& element : input) {
-    s1 = (s1 + element) % 65535;
-    s2 = (s2 + s1) % 65535;
-  }
-  return (s2 << 16) | s1;
+/// \brief Rotates 16 bit words left by multiplying them with powers of two.
+__attribute__((target("avx2")))
+inline __m256i rotateLeft(__m256i words, __m256i powers) {
+  return _mm256_or_si256(_mm256_mullo_epi16(words, powers), _mm256_mulhi_epu16(words, powers));
 }
 
-uint8_t Sum8::operator()(const std::vector<uint8_t>& input) const {
-  uint8_t checksum {0};
-  for (const auto& byte : input) {
-    checksum = static_cast<uint8_t>((checksum + byte) & 0xFF);
+/// \brief Continues the BSD sum over blocks of 16 bytes with AVX2.
+/// \param checksum Checksum of the data before the blocks
+/// \param data Pointer to the blocks
+/// \param blocks Number of blocks
+/// \return Checksum after the blocks
+__attribute__((target("avx2")))
+uint16_t sumBlocksAVX2(uint16_t checksum, const uint8_t* data, std::size_t blocks) {
+  // byte i contributes 2^(i+1), prefix i is rotated left by 15 - i
+  const __m256i contributionPowers {_mm256_setr_epi16(
+      2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, -32768, 1)};
+  const __m256i prefixPowers {_mm256_setr_epi16(
+      -32768, 16384, 8192, 4096, 2048, 1024, 512, 256, 128, 64, 32, 16, 8, 4, 2, 1)};
+  const __m256i lastWord {_mm256_set1_epi16(0x0F0E)};
+  const __m256i allOnes {_mm256_set1_epi32(-1)};
+  for (; blocks != 0; --blocks, data += 16) {
+    const __m128i bytes {_mm_loadu_si128(reinterpret_cast<const __m128i*>(data))};
+    const __m256i words {_mm256_cvtepu8_epi16(bytes)};
+    __m256i prefix {rotateLeft(words, contributionPowers)};
+    prefix = addOnesComplement(prefix, _mm256_slli_si256(prefix, 2));
+    prefix = addOnesComplement(prefix, _mm256_slli_si256(prefix, 4));
+    prefix = addOnesComplement(prefix, _mm256_slli_si256(prefix, 8));
+    // add the last prefix of the low half to every word of the high half
+    prefix = addOnesComplement(prefix, _mm256_shuffle_epi8(
+        _mm256_permute2x128_si256(prefix, prefix, 0x08), lastWord));
+    const __m256i sums {rotateLeft(addOnesComplement(prefix, _mm256_set1_epi16(
+        static_cast<short>(checksum))), prefixPowers)};
+    // sums <= bytes, or a ones' complement zero, may hide a carry
+    const __m256i carries {_mm256_or_si256(
+        _mm256_cmpeq_epi16(_mm256_max_epu16(sums, words), words),
+        _mm256_cmpeq_epi16(sums, allOnes))};
+    if (_mm256_testz_si256(carries, carries) != 0) {
+      const uint32_t sum {checksum + static_cast<uint32_t>(_mm256_extract_epi16(prefix, 15))};
+      checksum = static_cast<uint16_t>((sum & 0xFFFF) + (sum >> 16));
+    } else if (_mm_testz_si128(bytes, bytes) == 0) {
+      kernel::BSDSumState state {checksum};
+      state.update(data, 16);
+      checksum = state.finalize();
+    }
   }
   return checksum;
 }
 
-uint16_t Sum16::operator()(const std::vector<uint8_t>& input) const {
-  uint16_t checksum {0};
-  for (const auto& byte : input) {
-    checksum = static_cast<uint16_t>((checksum + byte) & 0xFFFF);
-  }
-  return checksum;
+// the AVX-512 intrinsics of GCC trip its own uninitialized warnings, as they
+// pass _mm512_undefined_epi32() as the unused source of masked instructions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+/// \brief Adds two vectors of 16 bit words in ones' complement arithmetic.
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i addOnesComplement(__m512i a, __m512i b) {
+  const __m512i sum {_mm512_add_epi16(a, b)};
+  // the carry out of each word is the majority of the top bits of a, b and ~sum
+  const __m512i carries {_mm512_ternarylogic_epi32(a, b, sum, 0xD4)};
+  return _mm512_add_epi16(sum, _mm512_srli_epi16(carries, 15));
 }
 
-uint32_t Sum32::operator()(const std::vector<uint8_t>& input) const {
-  uint32_t checksum {0};
-  for (const auto& byte : input) {
-    checksum = (checksum + byte) & 0xFFFFFF;
-  }
-  return checksum;
+/// \brief Rotates 16 bit words left by a number of bits per word.
+__attribute__((target("avx512f,avx512bw")))
+inline __m512i rotateLeft(__m512i words, __m512i counts) {
+  return _mm512_or_si512(_mm512_sllv_epi16(words, counts),
+                         _mm512_srlv_epi16(words, _mm512_sub_epi16(_mm512_set1_epi16(16), counts)));
 }
 
-uint16_t BSDSum::operator()(const std::vector<uint8_t>& input) const {
-  uint16_t checksum {0};
-  for (const auto& byte : input) {
-    checksum = static_cast<uint16_t>((checksum >> 1) + ((checksum & 1) << 15));
-    checksum += byte;
-    checksum &= 0xFFFF;
+
+
+/// \brief Continues the BSD sum over blocks of 32 bytes with AVX-512.
+/// \param checksum Checksum of the data before the blocks
+/// \param data Pointer to the blocks
+/// \param blocks Number of blocks
+/// \return Checksum after the blocks
+__attribute__((target("avx512f,avx512bw")))
+uint16_t sumBlocksAVX512(uint16_t checksum, const uint8_t* data, std::size_t blocks) {
+  alignas(64) static const uint16_t Lanes[32] {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31
+  };
+  const __m512i lanes {_mm512_load_si512(Lanes)};
+  const __m512i fifteen {_mm512_set1_epi16(15)};
+  // byte i contributes 2^(i+1), prefix i is rotated left by 15 - i
+  const __m512i contributionCounts {_mm512_and_si512(
+      _mm512_add_epi16(lanes, _mm512_set1_epi16(1)), fifteen)};
+  const __m512i prefixCounts {_mm512_and_si512(_mm512_sub_epi16(fifteen, lanes), fifteen)};
+  const __m512i previous {_mm512_sub_epi16(lanes, _mm512_set1_epi16(1))};
+  const __m512i zero {_mm512_setzero_si512()};
+  const __m512i allOnes {_mm512_set1_epi32(-1)};
+  for (; blocks != 0; --blocks, data += 32) {
+    const __m256i bytes {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data))};
+    const __m512i words {_mm512_cvtepu8_epi16(bytes)};
+    __m512i prefix {rotateLeft(words, contributionCounts)};
+    // shift the words up by 1, 2, 4, 8 and 16 lanes
+    prefix = addOnesComplement(prefix, _mm512_maskz_permutexvar_epi16(~1u, previous, prefix));
+    prefix = addOnesComplement(prefix, _mm512_alignr_epi32(prefix, zero, 15));
+    prefix = addOnesComplement(prefix, _mm512_alignr_epi64(prefix, zero, 7));
+    prefix = addOnesComplement(prefix, _mm512_alignr_epi64(prefix, zero, 6));
+    prefix = addOnesComplement(prefix, _mm512_alignr_epi64(prefix, zero, 4));
+    const __m512i sums {rotateLeft(addOnesComplement(prefix, _mm512_set1_epi16(
+        static_cast<short>(checksum))), prefixCounts)};
+    // sums <= bytes, or a ones' complement zero, may hide a carry
+    const __mmask32 carries {static_cast<__mmask32>(_mm512_cmple_epu16_mask(sums, words)
+                                                    | _mm512_cmpeq_epi16_mask(sums, allOnes))};
+    if (carries == 0) {
+      const uint32_t sum {checksum + static_cast<uint32_t>(
+          _mm_extract_epi16(_mm512_extracti32x4_epi32(prefix, 3), 7))};
+      checksum = static_cast<uint16_t>((sum & 0xFFFF) + (sum >> 16));
+    } else if (_mm256_testz_si256(bytes, bytes) == 0) {
+      kernel::BSDSumState state {checksum};
+      state.update(data, 32);
+      checksum = state.finalize();
+    }
   }
   return checksum;
 }
+#pragma GCC diagnostic pop
+#endif
 
-uint8_t XOR8::operator()(const std::vector<uint8_t>& input) const {
-  uint8_t checksum {0};
-  for (const auto& byte : input) {
-    checksum ^= byte & 0xFF;
+/// \brief Adds a buffer to a state with the best kernel for the CPU.
+/// \return Kernel tier used for the update
+KernelTier updateBSDSum(kernel::BSDSumState& state, const uint8_t* data, std::size_t length) {
+  const KernelTier tier {detail::bsdSumTier()};
+#ifdef LIBCHECKSUM_X86_KERNELS
+  if (tier == KernelTier::AVX512) {
+    state = kernel::BSDSumState {sumBlocksAVX512(state.finalize(), data, length / 32)};
+    state.update(data + length - length % 32, length % 32);
+    return tier;
   }
-  return checksum;
+  if (tier == KernelTier::AVX2) {
+    state = kernel::BSDSumState {sumBlocksAVX2(state.finalize(), data, length / 16)};
+    state.update(data + length - length % 16, length % 16);
+    return tier;
+  }
+#endif
+  state.update(data, length);
+  return tier;
 }
 
-uint32_t SYSV::operator()(const std::vector<uint8_t>& input) const {
-  uint32_t s {0}, r {0};
-  for (const auto& byte : input) {
-    s += byte;
+} // namespace
+
+namespace detail {
+
+KernelTier bsdSumTier() {
+#ifdef LIBCHECKSUM_X86_KERNELS
+  if (cpuFeatures().AVX512BW) {
+    return KernelTier::AVX512;
   }
-  r = (s & 0xFFFF) + ((s & 0xFFFFFFFF) >> 16);
-  return (r & 0xFFFF) + (r >> 16);
+  if (cpuFeatures().AVX2) {
+    return KernelTier::AVX2;
+  }
+#endif
+  return KernelTier::Scalar;
+}
+
+} // namespace detail
+
+Adler32::Adler32(unsigned threads) : Threads {threads} {}
+
+uint32_t Adler32::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Adler32, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint32_t>> Adler32::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Adler32);
+}
+
+Fletcher16::Fletcher16(unsigned threads) : Threads {threads} {}
+
+uint16_t Fletcher16::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Fletcher16, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint16_t>> Fletcher16::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Fletcher16);
+}
+
+Fletcher32::Fletcher32(unsigned threads) : Threads {threads} {}
+
+uint32_t Fletcher32::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Fletcher32, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint32_t>> Fletcher32::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Fletcher32);
+}
+
+Sum8::Sum8(unsigned threads) : Threads {threads} {}
+
+uint8_t Sum8::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Sum8, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint8_t>> Sum8::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Sum8);
+}
+
+Sum16::Sum16(unsigned threads) : Threads {threads} {}
+
+uint16_t Sum16::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Sum16, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint16_t>> Sum16::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Sum16);
+}
+
+Sum32::Sum32(unsigned threads) : Threads {threads} {}
+
+uint32_t Sum32::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::Sum32, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint32_t>> Sum32::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::Sum32);
+}
+
+uint16_t BSDSum::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::BSDSum, length};
+  State state {};
+  scope.setTier(updateBSDSum(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<uint16_t>> BSDSum::createStream() const {
+  return detail::makeStream<State, updateBSDSum>(AlgorithmId::BSDSum);
+}
+
+XOR8::XOR8(unsigned threads) : Threads {threads} {}
+
+uint8_t XOR8::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::XOR8, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint8_t>> XOR8::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::XOR8);
+}
+
+SYSV::SYSV(unsigned threads) : Threads {threads} {}
+
+uint32_t SYSV::operator()(const uint8_t* data, std::size_t length) const {
+  const detail::InstrumentationScope scope {AlgorithmId::SYSV, length};
+  return computeParallel<State>(data, length, Threads);
+}
+
+std::unique_ptr<ChecksumStream<uint32_t>> SYSV::createStream() const {
+  return detail::makeStream<State>(AlgorithmId::SYSV);
 }
 
 }
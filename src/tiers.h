@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Internal kernel tiers of the algorithms with SIMD kernels
+ *
+ * This private header declares the functions with which the algorithms
+ * choose their SIMD kernels, so the registry reports the same tiers as the
+ * kernels use.
+ */
+
+#ifndef CHECKSUM_TIERS_H
+#define CHECKSUM_TIERS_H
+
+#include <libchecksum/common.h>
+
+namespace libchecksum {
+
+namespace detail {
+
+/// \brief Returns the kernel tier of BSDSum on this CPU.
+KernelTier bsdSumTier();
+
+/// \brief Returns the kernel tier of InternetChecksum on this CPU.
+KernelTier internetChecksumTier();
+
+/// \brief Returns the kernel tier of XXH3 and XXH128 on this CPU.
+KernelTier xxh3Tier();
+
+/// \brief Returns the kernel tier of SHA256 on this CPU.
+KernelTier sha256Tier();
+
+/// \brief Returns the kernel tier of BLAKE3 for inputs of more than one
+/// chunk on this CPU.
+KernelTier blake3Tier();
+
+} // namespace detail
+
+} // namespace libchecksum
+
+#endif //CHECKSUM_TIERS_H
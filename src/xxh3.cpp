@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Implements the XXH3 hash
+ *
+ * This source file implements the XXH3 hashes declared in hash.h, with SIMD
+ * kernels for the stripe accumulation selected at runtime.
+ */
+
+#include <libchecksum/hash.h>
+#include "cpu.h"
+#include "instrumentation_hooks.h"
+#include "stream.h"
+#include "tiers.h"
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace libchecksum {
+
+namespace {
+
+using kernel::xxh::Prime32_1;
+using kernel::xxh::StripeLength;
+
+#ifdef LIBCHECKSUM_X86_KERNELS
+// The vector kernels follow the scalar kernel lane by lane: every 64 bit lane
+// adds the input of its neighbor lane and the product of the low and high half
+// of the input xor the secret.
+
+void accumulateSSE2(uint64_t (&acc)[8], const uint8_t* data, const uint8_t* secret,
+                    std::size_t count) {
+  __m128i lanes[4];
+  for (std::size_t i = 0; i < 4; ++i) {
+    lanes[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i);
+  }
+  for (; count != 0; --count, data += StripeLength, secret += 8) {
+    for (std::size_t i = 0; i < 4; ++i) {
+      const __m128i value {_mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i)};
+      const __m128i key {_mm_xor_si128(
+          value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i))};
+      const __m128i product {_mm_mul_epu32(key, _mm_srli_epi64(key, 32))};
+      const __m128i swapped {_mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2))};
+      lanes[i] = _mm_add_epi64(lanes[i], _mm_add_epi64(product, swapped));
+    }
+  }
+  for (std::size_t i = 0; i < 4; ++i) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, lanes[i]);
+  }
+}
+
+void scrambleSSE2(uint64_t (&acc)[8], const uint8_t* secret) {
+  const __m128i prime {_mm_set1_epi32(static_cast<int>(Prime32_1))};
+  for (std::size_t i = 0; i < 4; ++i) {
+    __m128i lane {_mm_loadu_si128(reinterpret_cast<const __m128i*>(acc) + i)};
+    lane = _mm_xor_si128(lane, _mm_srli_epi64(lane, 47));
+    lane = _mm_xor_si128(lane, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+    const __m128i low {_mm_mul_epu32(lane, prime)};
+    const __m128i high {_mm_mul_epu32(_mm_srli_epi64(lane, 32), prime)};
+    lane = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(acc) + i, lane);
+  }
+}
+
+__attribute__((target("avx2")))
+void accumulateAVX2(uint64_t (&acc)[8], const uint8_t* data, const uint8_t* secret,
+                    std::size_t count) {
+  __m256i lanes[2];
+  for (std::size_t i = 0; i < 2; ++i) {
+    lanes[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i);
+  }
+  for (; count != 0; --count, data += StripeLength, secret += 8) {
+    for (std::size_t i = 0; i < 2; ++i) {
+      const __m256i value {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data) + i)};
+      const __m256i key {_mm256_xor_si256(
+          value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i))};
+      const __m256i product {_mm256_mul_epu32(key, _mm256_srli_epi64(key, 32))};
+      const __m256i swapped {_mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2))};
+      lanes[i] = _mm256_add_epi64(lanes[i], _mm256_add_epi64(product, swapped));
+    }
+  }
+  for (std::size_t i = 0; i < 2; ++i) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, lanes[i]);
+  }
+}
+
+__attribute__((target("avx2")))
+void scrambleAVX2(uint64_t (&acc)[8], const uint8_t* secret) {
+  const __m256i prime {_mm256_set1_epi32(static_cast<int>(Prime32_1))};
+  for (std::size_t i = 0; i < 2; ++i) {
+    __m256i lane {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc) + i)};
+    lane = _mm256_xor_si256(lane, _mm256_srli_epi64(lane, 47));
+    lane = _mm256_xor_si256(lane,
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+    const __m256i low {_mm256_mul_epu32(lane, prime)};
+    const __m256i high {_mm256_mul_epu32(_mm256_srli_epi64(lane, 32), prime)};
+    lane = _mm256_add_epi64(low, _mm256_slli_epi64(high, 32));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc) + i, lane);
+  }
+}
+
+// the AVX-512 intrinsics of GCC trip its own uninitialized warnings, as they
+// pass _mm512_undefined_epi32() as the unused source of masked instructions
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+void accumulateAVX512(uint64_t (&acc)[8], const uint8_t* data, const uint8_t* secret,
+                      std::size_t count) {
+  __m512i lanes {_mm512_loadu_si512(acc)};
+  for (; count != 0; --count, data += StripeLength, secret += 8) {
+    const __m512i value {_mm512_loadu_si512(data)};
+    const __m512i key {_mm512_xor_si512(value, _mm512_loadu_si512(secret))};
+    const __m512i product {_mm512_mul_epu32(key, _mm512_srli_epi64(key, 32))};
+    const __m512i swapped {_mm512_shuffle_epi32(value, static_cast<_MM_PERM_ENUM>(
+        _MM_SHUFFLE(1, 0, 3, 2)))};
+    lanes = _mm512_add_epi64(lanes, _mm512_add_epi64(product, swapped));
+  }
+  _mm512_storeu_si512(acc, lanes);
+}
+
+__attribute__((target("avx512f")))
+void scrambleAVX512(uint64_t (&acc)[8], const uint8_t* secret) {
+  const __m512i prime {_mm512_set1_epi32(static_cast<int>(Prime32_1))};
+  __m512i lane {_mm512_loadu_si512(acc)};
+  lane = _mm512_xor_si512(lane, _mm512_srli_epi64(lane, 47));
+  lane = _mm512_xor_si512(lane, _mm512_loadu_si512(secret));
+  const __m512i low {_mm512_mul_epu32(lane, prime)};
+  const __m512i high {_mm512_mul_epu32(_mm512_srli_epi64(lane, 32), prime)};
+  _mm512_storeu_si512(acc, _mm512_add_epi64(low, _mm512_slli_epi64(high, 32)));
+}
+
+#pragma GCC diagnostic pop
+#endif
+
+/// Accumulates stripes with the widest vectors the CPU supports
+struct SimdStripes {
+  template<typename Byte>
+  static void accumulate(uint64_t (&acc)[8], const Byte* data, const uint8_t* secret,
+                         std::size_t count) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+#ifdef LIBCHECKSUM_X86_KERNELS
+    const KernelTier tier {detail::xxh3Tier()};
+    if (tier == KernelTier::AVX512) {
+      accumulateAVX512(acc, bytes, secret, count);
+      return;
+    }
+    if (tier == KernelTier::AVX2) {
+      accumulateAVX2(acc, bytes, secret, count);
+      return;
+    }
+    if (tier == KernelTier::SSE) {
+      accumulateSSE2(acc, bytes, secret, count);
+      return;
+    }
+#endif
+    kernel::xxh::ScalarStripes::accumulate(acc, bytes, secret, count);
+  }
+
+  static void scramble(uint64_t (&acc)[8], const uint8_t* secret) {
+#ifdef LIBCHECKSUM_X86_KERNELS
+    const KernelTier tier {detail::xxh3Tier()};
+    if (tier == KernelTier::AVX512) {
+      scrambleAVX512(acc, secret);
+      return;
+    }
+    if (tier == KernelTier::AVX2) {
+      scrambleAVX2(acc, secret);
+      return;
+    }
+    if (tier == KernelTier::SSE) {
+      scrambleSSE2(acc, secret);
+      return;
+    }
+#endif
+    kernel::xxh::ScalarStripes::scramble(acc, secret);
+  }
+};
+
+template<bool Wide>
+using SimdState = kernel::BasicXXH3State<SimdStripes, Wide>;
+
+/// \brief Updates a state with the SIMD kernels.
+/// \return Kernel tier used for the update
+template<bool Wide>
+KernelTier updateSimd(SimdState<Wide>& state, const uint8_t* data, std::size_t length) {
+  state.update(data, length);
+  return detail::xxh3Tier();
+}
+
+} // namespace
+
+namespace detail {
+
+KernelTier xxh3Tier() {
+#ifdef LIBCHECKSUM_X86_KERNELS
+  if (cpuFeatures().AVX512) {
+    return KernelTier::AVX512;
+  }
+  if (cpuFeatures().AVX2) {
+    return KernelTier::AVX2;
+  }
+  return KernelTier::SSE;
+#else
+  return KernelTier::Scalar;
+#endif
+}
+
+} // namespace detail
+
+uint64_t XXH3::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::XXH3, length};
+  if (length <= kernel::xxh::MidSizeMax) {
+    // short inputs do not need the buffer of the state
+    return kernel::xxh::hashShort(data, length);
+  }
+  SimdState<false> state {};
+  scope.setTier(updateSimd(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<uint64_t>> XXH3::createStream() const {
+  return detail::makeStream<SimdState<false>, updateSimd<false>>(AlgorithmId::XXH3);
+}
+
+Digest128 XXH128::operator()(const uint8_t* data, std::size_t length) const {
+  detail::InstrumentationScope scope {AlgorithmId::XXH128, length};
+  if (length <= kernel::xxh::MidSizeMax) {
+    return kernel::xxh::hashShort128(data, length);
+  }
+  SimdState<true> state {};
+  scope.setTier(updateSimd(state, data, length));
+  return state.finalize();
+}
+
+std::unique_ptr<ChecksumStream<Digest128>> XXH128::createStream() const {
+  return detail::makeStream<SimdState<true>, updateSimd<true>>(AlgorithmId::XXH128);
+}
+
+} // namespace libchecksum
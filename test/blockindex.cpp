@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of block indexes
+ *
+ * Source file containing tests for the block index of \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/blockindex.h>
+#include <libchecksum/crc.h>
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace libchecksum;
+
+TEST_CASE("BlockIndex") {
+  // 6000 blocks of 512 bytes give 6 leaves, so the tree has an odd level
+  constexpr std::size_t BlockSize {512};
+  std::vector<uint8_t> data {makeData(6000 * BlockSize - 100, 31337)};
+  const BlockIndex index {BlockIndex::create(data.data(), data.size(), AlgorithmId::CRC32C,
+                                             BlockSize)};
+
+  SECTION("create") {
+    REQUIRE(index.algorithm() == AlgorithmId::CRC32C);
+    REQUIRE(index.blockSize() == BlockSize);
+    REQUIRE(index.dataLength() == data.size());
+    REQUIRE(index.blockCount() == 6000);
+    REQUIRE(index.blockChecksum(0) == CRC32C {}(data.data(), BlockSize));
+    REQUIRE(index.blockChecksum(5999) == CRC32C {}(data.data() + 5999 * BlockSize, BlockSize - 100));
+    REQUIRE_THROWS_AS(index.blockChecksum(6000), std::out_of_range);
+    REQUIRE(index.verifyIndex());
+
+    const BlockIndex serial {BlockIndex::create(data.data(), data.size(), AlgorithmId::CRC32C,
+                                                BlockSize, 1)};
+    REQUIRE(serial.root() == index.root());
+    const BlockIndex crc32 {BlockIndex::create(data.data(), data.size(), AlgorithmId::CRC32,
+                                               BlockSize)};
+    REQUIRE(crc32.blockChecksum(1) == CRC32 {}(data.data() + BlockSize, BlockSize));
+    REQUIRE(crc32.root() != index.root());
+    REQUIRE(crc32.verifyIndex());
+
+    const BlockIndex empty {BlockIndex::create(nullptr, 0)};
+    REQUIRE(empty.blockCount() == 0);
+    REQUIRE(empty.verifyIndex());
+    REQUIRE(empty.verifyRange(nullptr, 0, 0).ok());
+
+    REQUIRE_THROWS_AS(BlockIndex::create(data.data(), data.size(), AlgorithmId::Adler32),
+                      std::invalid_argument);
+    REQUIRE_THROWS_AS(BlockIndex::create(data.data(), data.size(), AlgorithmId::CRC32, 0),
+                      std::invalid_argument);
+  }
+
+  SECTION("ranges") {
+    REQUIRE(index.verifyRange(data.data(), 0, data.size()).ok());
+    REQUIRE(index.verifyRange(data.data(), 1000, 1).ok());
+    REQUIRE(index.verifyRange(data.data(), data.size() - 1, 1).ok());
+    REQUIRE_THROWS_AS(index.verifyRange(data.data(), data.size(), 1), std::out_of_range);
+
+    // only the covering blocks are checked
+    data[2000 * BlockSize + 7] ^= 1;
+    REQUIRE(index.verifyRange(data.data(), 0, 2000 * BlockSize).ok());
+    const BlockVerification result {index.verifyRange(data.data(), 1999 * BlockSize + 1,
+                                                      BlockSize + 10)};
+    REQUIRE(result.Authentic);
+    REQUIRE(result.Mismatched == std::vector<uint64_t> {2000});
+    REQUIRE_FALSE(result.ok());
+  }
+
+  SECTION("corrupt index") {
+    std::vector<uint8_t> serialized {index.data(), index.data() + index.size()};
+    // checksum of block 1500, which belongs to the second leaf
+    serialized[64 + 4 * 1500] ^= 1;
+    BlockIndex corrupt {BlockIndex::parse(serialized.data(), serialized.size())};
+    REQUIRE_FALSE(corrupt.verifyIndex());
+    REQUIRE(corrupt.verifyRange(data.data(), 0, 1024 * BlockSize).ok());
+    const BlockVerification result {corrupt.verifyRange(data.data(), 1500 * BlockSize, 1)};
+    REQUIRE_FALSE(result.Authentic);
+    REQUIRE(result.Mismatched == std::vector<uint64_t> {1500});
+
+    // a sibling on the path of the first leaf
+    serialized[64 + 4 * 1500] ^= 1;
+    serialized[64 + 4 * 6000 + 32] ^= 1;
+    corrupt = BlockIndex::parse(serialized.data(), serialized.size());
+    REQUIRE_FALSE(corrupt.verifyIndex());
+    REQUIRE_FALSE(corrupt.verifyRange(data.data(), 0, 1).Authentic);
+    REQUIRE(corrupt.verifyRange(data.data(), 1024 * BlockSize, 1).Authentic);
+
+    serialized[64 + 4 * 6000 + 32] ^= 1;
+    serialized[40] ^= 1;
+    REQUIRE_FALSE(BlockIndex::parse(serialized.data(), serialized.size()).verifyIndex());
+    serialized[40] ^= 1;
+    REQUIRE(BlockIndex::parse(serialized.data(), serialized.size()).verifyIndex());
+
+    REQUIRE_THROWS_AS(BlockIndex::parse(serialized.data(), serialized.size() - 1),
+                      std::runtime_error);
+    REQUIRE_THROWS_AS(BlockIndex::parse(serialized.data(), 63), std::runtime_error);
+    serialized[0] = 'X';
+    REQUIRE_THROWS_AS(BlockIndex::parse(serialized.data(), serialized.size()),
+                      std::runtime_error);
+  }
+
+  SECTION("files") {
+    {
+      std::ofstream file {"blockindex.bin", std::ios::binary};
+      file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+    index.save("blockindex.idx");
+    const BlockIndex opened {BlockIndex::open("blockindex.idx")};
+    REQUIRE(opened.size() == index.size());
+    REQUIRE(opened.root() == index.root());
+    REQUIRE(opened.verifyIndex());
+
+    const int fd {::open("blockindex.bin", O_RDONLY)};
+    REQUIRE(fd >= 0);
+    REQUIRE(opened.verifyRange(fd, 0, data.size()).ok());
+    REQUIRE(opened.verifyRange(fd, 3000 * BlockSize + 5, 4096).ok());
+    ::close(fd);
+
+    // blocks missing at the end of the file do not match
+    REQUIRE(::truncate("blockindex.bin", static_cast<off_t>(data.size() - 1)) == 0);
+    const int truncated {::open("blockindex.bin", O_RDONLY)};
+    REQUIRE(truncated >= 0);
+    REQUIRE(opened.verifyRange(truncated, 5990 * BlockSize, 10).ok());
+    REQUIRE(opened.verifyRange(truncated, 5990 * BlockSize, 10 * BlockSize - 100).Mismatched
+            == std::vector<uint64_t> {5999});
+    ::close(truncated);
+
+    std::remove("blockindex.bin");
+    std::remove("blockindex.idx");
+    REQUIRE_THROWS_AS(BlockIndex::open("blockindex.idx"), std::system_error);
+  }
+}
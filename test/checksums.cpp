@@ -30,6 +30,7 @@
  */
 
 #include "catch.hpp"
+#include "testdata.h"
 #include <libchecksum/checksums.h>
 
 using namespace libchecksum;
@@ -269,6 +270,26 @@ TEST_CASE("BSDSum") {
     REQUIRE(sum(TestVector[7]) == 32875);
     REQUIRE(sum(TestVector[8]) == 0);
   }
+
+  SECTION("blocks") {
+    // runs of 0xFF and small bytes force carries and ones' complement zeros into
+    // the block kernels, which must fall back to the byte loop exactly
+    std::vector<uint8_t> data {makeData(4096, 1)};
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      const uint8_t byte {data[i]};
+      data[i] = i / 512 % 4 == 0 ? byte : i / 512 % 4 == 1 ? (byte & 1) * 0xFF
+                : i / 512 % 4 == 2 ? 0xFF : byte % 3;
+    }
+    for (std::size_t offset = 0; offset < 64; offset += 5) {
+      for (std::size_t length = 0; length < data.size() - offset; length += 37) {
+        REQUIRE(sum(data.data() + offset, length) == kernel::bsdSum(data.data() + offset, length));
+      }
+    }
+    const auto stream = sum.createStream();
+    stream->update(data.data(), 1001);
+    stream->update(data.data() + 1001, data.size() - 1001);
+    REQUIRE(stream->finalize() == kernel::bsdSum(data.data(), data.size()));
+  }
 }
 
 TEST_CASE("XOR8") {
@@ -334,3 +355,95 @@ TEST_CASE("SYSV") {
     REQUIRE(sum(TestVector[8]) == 0);
   }
 }
+
+TEST_CASE("InternetChecksum") {
+  InternetChecksum internet;
+
+  SECTION("string") {
+    const std::string str {"Test String Internet"};
+    const std::string expectedHex {"3d1b"};
+    const uint16_t expected {15643};
+    REQUIRE(internet.getHex(str) == expectedHex);
+    REQUIRE(internet(str) == expected);
+  }
+
+  SECTION("bytes") {
+    const std::vector<uint8_t> vec {1, 2, 3, 4, 42, 81, 34, 12, 76, 34, 23};  // 010203042A51220C4C2217
+    const std::string expectedHex {"4c7a"};
+    const uint16_t expected {19578};
+    REQUIRE(internet.getHex(vec) == expectedHex);
+    REQUIRE(internet(vec) == expected);
+  }
+
+  SECTION("testvector") {
+    REQUIRE(internet(TestVector[0]) == 35687);
+    REQUIRE(internet(TestVector[1]) == 23960);
+    REQUIRE(internet(TestVector[2]) == 59931);
+    REQUIRE(internet(TestVector[3]) == 27827);
+    REQUIRE(internet(TestVector[4]) == 14894);
+    REQUIRE(internet(TestVector[5]) == 18663);
+    REQUIRE(internet(TestVector[6]) == 6323);
+    REQUIRE(internet(TestVector[7]) == 42177);
+    REQUIRE(internet(TestVector[8]) == 65535);
+  }
+
+  SECTION("header") {
+    // IPv4 header with the checksum field set to zero
+    std::vector<uint8_t> header {0x45, 0x00, 0x00, 0x73, 0x00, 0x00, 0x40, 0x00, 0x40, 0x11,
+                                 0x00, 0x00, 0xc0, 0xa8, 0x00, 0x01, 0xc0, 0xa8, 0x00, 0xc7};
+    const uint16_t checksum {internet(header)};
+    REQUIRE(checksum == 0xb861);
+    header[10] = static_cast<uint8_t>(checksum >> 8);
+    header[11] = static_cast<uint8_t>(checksum);
+    REQUIRE(internet(header) == 0);
+  }
+
+  SECTION("patch") {
+    std::vector<uint8_t> data(1001);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+      data[i] = static_cast<uint8_t>(i * 7 + 3);
+    }
+    uint16_t checksum {internet(data)};
+
+    // 16 bit field, e.g. a port
+    const uint16_t oldPort {static_cast<uint16_t>((data[20] << 8) | data[21])};
+    data[20] = 0xff;
+    data[21] = 0xfe;
+    checksum = InternetChecksum::patch16(checksum, oldPort, 0xfffe);
+    REQUIRE(checksum == internet(data));
+
+    // 32 bit field, e.g. an address
+    const uint32_t oldAddress {(static_cast<uint32_t>(data[100]) << 24) | (data[101] << 16)
+                               | (data[102] << 8) | data[103]};
+    data[100] = 0;
+    data[101] = 0;
+    data[102] = 0;
+    data[103] = 0;
+    checksum = InternetChecksum::patch32(checksum, oldAddress, 0);
+    REQUIRE(checksum == internet(data));
+
+    // ranges at even and odd offsets, including the trailing odd byte
+    for (const std::size_t offset : {0, 1, 501, 990}) {
+      const std::vector<uint8_t> old(data.begin() + offset, data.begin() + offset + 11);
+      for (std::size_t i = 0; i < old.size(); ++i) {
+        data[offset + i] = static_cast<uint8_t>(old[i] ^ (0x5a + i));
+      }
+      checksum = InternetChecksum::patch(checksum, offset, old.data(), data.data() + offset,
+                                         old.size());
+      REQUIRE(checksum == internet(data));
+    }
+  }
+
+  SECTION("sums beyond 64 bits") {
+    // the word sums of buffers of more than 16 GiB overflow 64 bits
+    const uint64_t values[] {0, 1, 0xFFFF, 0x1FFFFFFFE, UINT64_MAX / 2, UINT64_MAX - 1, UINT64_MAX};
+    for (const uint64_t a : values) {
+      for (const uint64_t b : values) {
+        const uint64_t expected {uint64_t {kernel::foldOnesComplement(a)}
+                                 + kernel::foldOnesComplement(b)};
+        REQUIRE(kernel::foldOnesComplement(kernel::addEndAroundCarry(a, b))
+                == kernel::foldOnesComplement(expected));
+      }
+    }
+  }
+}
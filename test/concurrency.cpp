@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of concurrent use
+ *
+ * Source file containing stress tests for algorithm instances shared by
+ * several threads. Build with \p ENABLE_TSAN to check them for data races.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+
+#include <atomic>
+#include <thread>
+
+using namespace libchecksum;
+
+namespace {
+
+constexpr std::size_t ThreadCount {8};
+constexpr std::size_t Iterations {20};
+
+/// \brief Returns the inputs hashed by the stress test.
+std::vector<std::vector<uint8_t>> makeInputs() {
+  std::vector<std::vector<uint8_t>> inputs;
+  uint32_t seed {7};
+  for (const std::size_t length : {0, 1, 3, 64, 1000, 4103, 70000}) {
+    inputs.push_back(makeData(length, seed++));
+  }
+  return inputs;
+}
+
+/// \brief Calculates checksums with a single algorithm instance on several
+/// threads at once and compares them with the results of a single thread.
+/// \return Number of wrong results
+template<typename T>
+std::size_t countConcurrentErrors(const ChecksumAlgorithm<T>& algorithm) {
+  const std::vector<std::vector<uint8_t>> inputs {makeInputs()};
+  std::vector<T> expected;
+  for (const auto& input : inputs) {
+    expected.push_back(algorithm(input));
+  }
+
+  std::atomic<std::size_t> errors {0};
+  std::atomic<bool> start {false};
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < ThreadCount; ++thread) {
+    threads.emplace_back([&, thread]() {
+      while (!start.load()) {
+        std::this_thread::yield();
+      }
+      const auto stream = algorithm.createStream();
+      for (std::size_t iteration = 0; iteration < Iterations; ++iteration) {
+        // every thread walks through the inputs in a different order
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+          const std::size_t index {(i + thread) % inputs.size()};
+          if (algorithm(inputs[index]) != expected[index]) {
+            ++errors;
+          }
+          stream->reset();
+          stream->update(inputs[index]);
+          if (stream->finalize() != expected[index]) {
+            ++errors;
+          }
+        }
+      }
+    });
+  }
+  start = true;
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return errors;
+}
+
+} // namespace
+
+TEST_CASE("concurrency") {
+  REQUIRE(countConcurrentErrors(Adler32 {}) == 0);
+  REQUIRE(countConcurrentErrors(Fletcher16 {}) == 0);
+  REQUIRE(countConcurrentErrors(Fletcher32 {}) == 0);
+  REQUIRE(countConcurrentErrors(Sum8 {}) == 0);
+  REQUIRE(countConcurrentErrors(Sum16 {}) == 0);
+  REQUIRE(countConcurrentErrors(Sum32 {}) == 0);
+  REQUIRE(countConcurrentErrors(BSDSum {}) == 0);
+  REQUIRE(countConcurrentErrors(XOR8 {}) == 0);
+  REQUIRE(countConcurrentErrors(SYSV {}) == 0);
+  REQUIRE(countConcurrentErrors(Cksum {}) == 0);
+  REQUIRE(countConcurrentErrors(CRC32 {}) == 0);
+  REQUIRE(countConcurrentErrors(CRC32C {}) == 0);
+  REQUIRE(countConcurrentErrors(CRC32BZIP2 {}) == 0);
+  REQUIRE(countConcurrentErrors(InternetChecksum {}) == 0);
+  REQUIRE(countConcurrentErrors(XXH3 {}) == 0);
+  REQUIRE(countConcurrentErrors(XXH128 {}) == 0);
+  REQUIRE(countConcurrentErrors(SHA256 {}) == 0);
+  REQUIRE(countConcurrentErrors(BLAKE3 {}) == 0);
+}
+
+TEST_CASE("concurrentBatchesAndSubtrees") {
+  // inputs large enough for the subtrees of BLAKE3 on nested threads
+  std::vector<uint8_t> large(3 * 1024 * 1024);
+  for (std::size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<uint8_t>(i * 31 + i / 4096);
+  }
+  const BLAKE3 blake3 {2};
+  const SHA256 sha256;
+  const Digest256 expected {blake3(large)};
+  const std::vector<std::string> messages {"", "a", "abc", std::string(100, 'x'), std::string(999, 'y')};
+  const std::vector<Digest256> expectedBatch {sha256.computeBatch(messages)};
+
+  std::atomic<std::size_t> errors {0};
+  std::vector<std::thread> threads;
+  for (std::size_t thread = 0; thread < 4; ++thread) {
+    threads.emplace_back([&]() {
+      for (std::size_t iteration = 0; iteration < 4; ++iteration) {
+        if (blake3(large) != expected || sha256.computeBatch(messages) != expectedBatch) {
+          ++errors;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(errors == 0);
+}
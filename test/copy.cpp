@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the fused copy functions
+ *
+ * Source file containing tests for the fused copy and checksum functions in
+ * \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/checksums.h>
+#include <libchecksum/copy.h>
+#include <libchecksum/crc.h>
+
+using namespace libchecksum;
+
+namespace {
+
+/// \brief Checks that a fused copy copies the bytes and calculates the same
+/// checksum as the algorithm for misaligned buffers of different sizes.
+template<typename Algorithm>
+void checkCopy(const std::vector<uint8_t>& data) {
+  const Algorithm algorithm {};
+  std::vector<uint8_t> copy(data.size() + 16);
+  for (const std::size_t length : {0, 1, 63, 4095, 4096, 4097, 20000}) {
+    for (std::size_t offset = 0; offset < 3; ++offset) {
+      std::fill(copy.begin(), copy.end(), 0);
+      const uint8_t* source {data.data() + offset};
+      uint8_t* destination {copy.data() + 2 * offset + 1};
+      REQUIRE(copyWithChecksum<Algorithm>(destination, source, length)
+              == algorithm(source, length));
+      REQUIRE(std::equal(source, source + length, destination));
+      REQUIRE(destination[length] == 0);
+    }
+  }
+
+  // checksums continue across several copies
+  typename Algorithm::State state {};
+  copyAndUpdate(state, copy.data(), data.data(), 5000);
+  copyAndUpdate(state, copy.data() + 5000, data.data() + 5000, data.size() - 5000);
+  REQUIRE(state.finalize() == algorithm(data));
+  REQUIRE(std::equal(data.begin(), data.end(), copy.begin()));
+}
+
+} // namespace
+
+TEST_CASE("copy") {
+  const std::vector<uint8_t> data {makeData(20003, 1)};
+
+  checkCopy<CRC32>(data);
+  checkCopy<CRC32C>(data);
+  checkCopy<Adler32>(data);
+  checkCopy<Sum8>(data);
+  checkCopy<Sum16>(data);
+  checkCopy<Sum32>(data);
+}
@@ -31,8 +31,11 @@
 
 
 #include "catch.hpp"
+#include "testdata.h"
 #include <libchecksum/crc.h>
 
+#include <stdexcept>
+
 using namespace libchecksum;
 
 // a vector of random test strings
@@ -120,3 +123,155 @@ TEST_CASE("CRC32") {
     REQUIRE(crc(TestVector[8]) == 0);
   }
 }
+
+TEST_CASE("CRC32C") {
+  CRC32C crc;
+
+  SECTION("generator") {
+    REQUIRE(crc.getGeneratorPolynomial() == 0x82f63b78);
+  }
+
+  SECTION("string") {
+    const std::string str {"abcdef"};
+    const std::string expectedHex {"53bceff1"};
+    const uint32_t expected {1404891121};
+    REQUIRE(crc.getHex(str) == expectedHex);
+    REQUIRE(crc(str) == expected);
+    REQUIRE(crc(std::string {"123456789"}) == 0xe3069283);
+  }
+
+  SECTION("bytes") {
+    const std::vector<uint8_t> vec {1, 2, 3, 4, 42, 81, 34, 12, 76, 34, 23};  // 010203042A51220C4C2217
+    const std::string expectedHex {"f463b00"};
+    const uint32_t expected {256260864};
+    REQUIRE(crc.getHex(vec) == expectedHex);
+    REQUIRE(crc(vec) == expected);
+  }
+
+  SECTION("testvector") {
+    REQUIRE(crc(TestVector[0]) == 2479759992);
+    REQUIRE(crc(TestVector[1]) == 2716655505);
+    REQUIRE(crc(TestVector[2]) == 1960204559);
+    REQUIRE(crc(TestVector[3]) == 3582651187);
+    REQUIRE(crc(TestVector[4]) == 1335994520);
+    REQUIRE(crc(TestVector[5]) == 3810601275);
+    REQUIRE(crc(TestVector[6]) == 2534788572);
+    REQUIRE(crc(TestVector[7]) == 81518048);
+    REQUIRE(crc(TestVector[8]) == 0);
+  }
+}
+
+TEST_CASE("CRC32BZIP2") {
+  CRC32BZIP2 crc;
+
+  SECTION("generator") {
+    REQUIRE(crc.getGeneratorPolynomial() == 0x04C11DB7);
+  }
+
+  SECTION("string") {
+    const std::string str {"abcdef"};
+    const std::string expectedHex {"a0f54fb9"};
+    const uint32_t expected {2700431289};
+    REQUIRE(crc.getHex(str) == expectedHex);
+    REQUIRE(crc(str) == expected);
+    REQUIRE(crc(std::string {"123456789"}) == 0xfc891918);
+  }
+
+  SECTION("testvector") {
+    REQUIRE(crc(TestVector[0]) == 1720239050);
+    REQUIRE(crc(TestVector[8]) == 0);
+  }
+}
+
+namespace {
+
+/// \brief Calculates a 32 bit CRC bit by bit, as reference for the tables.
+uint32_t bitwiseCrc(uint32_t crc, const std::vector<uint8_t>& data, uint32_t polynomial,
+                    bool reflected) {
+  for (const uint8_t byte : data) {
+    crc ^= reflected ? byte : static_cast<uint32_t>(byte) << 24;
+    for (int bit = 0; bit < 8; ++bit) {
+      if (reflected) {
+        crc = (crc & 1) != 0 ? (crc >> 1) ^ polynomial : crc >> 1;
+      } else {
+        crc = (crc & 0x80000000) != 0 ? (crc << 1) ^ polynomial : crc << 1;
+      }
+    }
+  }
+  return crc;
+}
+
+} // namespace
+
+TEST_CASE("CRC tables") {
+  SECTION("slicing") {
+    std::vector<uint8_t> data;
+    for (std::size_t length = 0; length < 40; ++length) {
+      REQUIRE(kernel::updateReflectedCrc<kernel::CRC32State::Tables>(0xFFFFFFFF, data.data(),
+                                                                     data.size())
+              == bitwiseCrc(0xFFFFFFFF, data, 0xEDB88320, true));
+      REQUIRE(kernel::updateReflectedCrc<kernel::CRC32CState::Tables>(0x12345678, data.data(),
+                                                                      data.size())
+              == bitwiseCrc(0x12345678, data, 0x82F63B78, true));
+      REQUIRE(kernel::updateCrc<kernel::CksumState::Tables>(0xFFFFFFFF, data.data(), data.size())
+              == bitwiseCrc(0xFFFFFFFF, data, 0x04C11DB7, false));
+      data.push_back(static_cast<uint8_t>(length * 151 + 7));
+    }
+  }
+
+  SECTION("footprint") {
+    const Cksum cksum;
+    const CRC32 crc32;
+    const CRC32BZIP2 bzip2;
+    REQUIRE(crc32.getTableFootprint().Size == 8 * 256 * sizeof(uint32_t));
+    REQUIRE(reinterpret_cast<uintptr_t>(crc32.getTableFootprint().Address) % 64 == 0);
+    // Cksum and CRC-32/BZIP2 share the tables of their polynomial
+    REQUIRE(cksum.getTableFootprint().Address == bzip2.getTableFootprint().Address);
+    REQUIRE(util::combinedFootprint({cksum.getTableFootprint(), bzip2.getTableFootprint(),
+                                     crc32.getTableFootprint()}) == 2 * 8192);
+  }
+}
+
+namespace {
+
+/// \brief Checks that patching ranges of the data gives the checksum of the
+/// changed data.
+template<typename Algorithm>
+void checkPatch(std::vector<uint8_t> data) {
+  const Algorithm algorithm {};
+  uint32_t checksum {algorithm(data)};
+  uint32_t seed {99};
+  const std::size_t ranges[][2] = {
+    {0, 0}, {0, 1}, {17, 4096}, {data.size() - 1, 1}, {data.size() - 300, 300},
+    {12345, 1}, {0, data.size()}, {data.size(), 0}
+  };
+  for (const auto& range : ranges) {
+    const std::vector<uint8_t> patched {makeData(range[1], seed++)};
+    checksum = Algorithm::patch(checksum, data.size(), range[0], data.data() + range[0],
+                                patched.data(), patched.size());
+    std::copy(patched.begin(), patched.end(), data.begin() + range[0]);
+    REQUIRE(checksum == algorithm(data));
+  }
+  REQUIRE_THROWS_AS(Algorithm::patch(checksum, data.size(), data.size(), data.data(),
+                                     data.data(), 1), std::out_of_range);
+  REQUIRE_THROWS_AS(Algorithm::patch(checksum, data.size(), data.size() + 1, data.data(),
+                                     data.data(), 0), std::out_of_range);
+}
+
+} // namespace
+
+TEST_CASE("CRC patch") {
+  // long enough that the shifts use many of the powers
+  const std::vector<uint8_t> data {makeData((3 << 20) + 77, 7)};
+  checkPatch<Cksum>(data);
+  checkPatch<CRC32>(data);
+  checkPatch<CRC32C>(data);
+  checkPatch<CRC32BZIP2>(data);
+
+  // the kernels work at compile time as well
+  constexpr uint8_t oldData[] = {1, 2, 3, 4, 5, 6};
+  constexpr uint8_t newData[] = {1, 2, 9, 4, 5, 6};
+  static_assert(kernel::CRC32State::patch(kernel::compute<kernel::CRC32State>(oldData, 6), 6, 2,
+                                          oldData + 2, newData + 2, 1)
+                == kernel::compute<kernel::CRC32State>(newData, 6), "CRC32 patch");
+}
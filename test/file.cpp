@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the file input of \p libchecksum
+ *
+ * Source file containg tests for checksums of files in \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/file.h>
+
+#include <cstdio>
+#include <sstream>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace libchecksum;
+
+TEST_CASE("MappedFile") {
+
+  SECTION("regular") {
+    const MappedFile file {"testfile.txt"};
+    REQUIRE(file.isMapped());
+    REQUIRE(file.size() == 96);
+    REQUIRE(std::string(reinterpret_cast<const char*>(file.data()), 4) == "This");
+  }
+
+  SECTION("move") {
+    MappedFile file {"testfile.txt"};
+    const MappedFile other {std::move(file)};
+    REQUIRE(file.size() == 0);
+    REQUIRE(other.size() == 96);
+  }
+
+  SECTION("missing") {
+    REQUIRE_THROWS_AS(MappedFile {"does-not-exist.txt"}, std::system_error);
+  }
+}
+
+TEST_CASE("checksumFile") {
+  REQUIRE(checksumFile(Cksum {}, "testfile.txt") == 1514647855);
+  REQUIRE(checksumFile(CRC32 {}, "testfile.txt") == 2075869825);
+  REQUIRE(checksumFile(Adler32 {}, "testfile.txt") == 1994924694);
+  REQUIRE(checksumFile(BSDSum {}, "testfile.txt") == 54238);
+  REQUIRE(checksumFile(SYSV {}, "testfile.txt") == 8853);
+}
+
+TEST_CASE("BlockReader") {
+  const Cksum cksum;
+
+  SECTION("file descriptor") {
+    // block sizes smaller than, equal to and larger than the file
+    const std::size_t blockSizes[] {7, 96, BlockReader::DefaultBlockSize};
+    for (const std::size_t blockSize : blockSizes) {
+      BlockReader reader {blockSize};
+      const int fd {::open("testfile.txt", O_RDONLY)};
+      REQUIRE(fd >= 0);
+      const auto stream = cksum.createStream();
+      REQUIRE(reader.read(fd, *stream) == 96);
+      REQUIRE(stream->finalize() == 1514647855);
+      ::close(fd);
+    }
+  }
+
+  SECTION("pipe") {
+    std::string data(300000, 'x');
+    for (std::size_t i = 0; i < data.size(); i += 13) {
+      data[i] = static_cast<char>(i);
+    }
+    int fds[2];
+    REQUIRE(::pipe(fds) == 0);
+    bool written {true};
+    std::thread writer {[&]() {
+      // short writes split the data at arbitrary points
+      for (std::size_t position = 0; position < data.size(); position += 1000) {
+        const std::size_t length {std::min<std::size_t>(1000, data.size() - position)};
+        written = written && ::write(fds[1], data.data() + position, length)
+                             == static_cast<ssize_t>(length);
+      }
+      ::close(fds[1]);
+    }};
+    BlockReader reader {};
+    const uint32_t crc {reader.checksum(CRC32 {}, fds[0])};
+    writer.join();
+    ::close(fds[0]);
+    REQUIRE(written);
+    REQUIRE(crc == CRC32 {}(data));
+  }
+
+  SECTION("FILE stream") {
+    BlockReader reader {10};
+    std::FILE* file {std::fopen("testfile.txt", "rb")};
+    REQUIRE(file != nullptr);
+    REQUIRE(reader.checksum(Adler32 {}, file) == 1994924694);
+    std::fclose(file);
+  }
+
+  SECTION("istream") {
+    const std::string data(100000, '\xff');
+    std::istringstream input {data};
+    BlockReader reader {4096};
+    REQUIRE(reader.checksum(BSDSum {}, input) == BSDSum {}(data));
+    std::istringstream empty {};
+    REQUIRE(reader.checksum(BSDSum {}, empty) == BSDSum {}(""));
+  }
+
+  SECTION("error") {
+    BlockReader reader {};
+    const auto stream = cksum.createStream();
+    REQUIRE_THROWS_AS(reader.read(-1, *stream), std::system_error);
+  }
+}
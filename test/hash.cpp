@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the hash functions
+ *
+ * Source file containing tests for the hash functions in \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/file.h>
+#include <libchecksum/hash.h>
+
+#include <unordered_set>
+#include <utility>
+
+using namespace libchecksum;
+
+static_assert(kernel::xxh3("", 0) == 0x2d06800538d394c2, "XXH3 is not constexpr");
+static_assert(kernel::sha256("", 0).Bytes[0] == 0xe3 && kernel::sha256("", 0).Bytes[31] == 0x55,
+              "SHA-256 is not constexpr");
+static_assert(kernel::blake3("", 0).Bytes[0] == 0xaf && kernel::blake3("", 0).Bytes[31] == 0x62,
+              "BLAKE3 is not constexpr");
+
+TEST_CASE("XXH3") {
+  XXH3 xxh3;
+
+  SECTION("string") {
+    const std::string str {"abcdef"};
+    const std::string expectedHex {"da87bd32d3c47db6"};
+    const uint64_t expected {0xda87bd32d3c47db6};
+    REQUIRE(xxh3.getHex(str) == expectedHex);
+    REQUIRE(xxh3(str) == expected);
+    REQUIRE(xxh3(std::string {"5\"&l&7s:|In`'#kZiXA@[ee^^(kZ]Qp@"}) == 4075527671367982051);
+  }
+
+  SECTION("lengths") {
+    // values of XXH3_64bits() of the xxHash library, covering all size classes
+    const std::vector<std::pair<std::size_t, uint64_t>> expected {
+      {0, 0x2d06800538d394c2},
+      {1, 0xe5e62017e96f839c},
+      {2, 0xe99f8ba75698ec0f},
+      {3, 0xd3bcc83c6f14e70f},
+      {4, 0xc7f159f34b126cb4},
+      {5, 0x0276f65070331568},
+      {8, 0x0f25a2a1cc43dda2},
+      {9, 0x1e3be9699baa50cf},
+      {16, 0x9ec324145cea1dcb},
+      {17, 0x48f3651d7436310a},
+      {32, 0x3ecd923442085a0d},
+      {33, 0x0afebb54eff3a3b5},
+      {64, 0x7abe508541644d25},
+      {65, 0xda2a9fa52b7fadf5},
+      {96, 0x014dbb30ecd7c670},
+      {97, 0x7b0a9dae42e89ff6},
+      {128, 0x5d813d42c0005ea8},
+      {129, 0xc61639b552225575},
+      {200, 0xaea1c4e1114bf7db},
+      {240, 0x7d85b8d4f8b10c82},
+      {241, 0x5c56141c894cd97e},
+      {255, 0xa88268bb584966d3},
+      {256, 0xcdb34974678d6687},
+      {257, 0xb5c3cd9c180a14b7},
+      {320, 0xfe6e6426ff966b51},
+      {511, 0x29a124fe3138f1ee},
+      {1024, 0x0551dea22e104ea8},
+      {1025, 0xdbe2ed3c377d9922},
+      {1088, 0x98ce47a58d705d59},
+      {2048, 0x0e137a69a82b62c0},
+      {4999, 0x5d0dc4cd666a283c},
+    };
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const auto& entry : expected) {
+      REQUIRE(xxh3(data.data(), entry.first) == entry.second);
+      REQUIRE(kernel::xxh3(data.data(), entry.first) == entry.second);
+    }
+  }
+
+  SECTION("stream") {
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const std::size_t chunk : {1, 63, 64, 255, 256, 257, 1000}) {
+      const auto stream = xxh3.createStream();
+      for (std::size_t position = 0; position < data.size(); position += chunk) {
+        stream->update(data.data() + position, std::min(chunk, data.size() - position));
+        REQUIRE(stream->finalize() == xxh3(data.data(), std::min(position + chunk, data.size())));
+      }
+    }
+  }
+
+  SECTION("file") {
+    REQUIRE(checksumFile(xxh3, "testfile.txt") == xxh3(MappedFile {"testfile.txt"}.data(), 96));
+  }
+}
+
+TEST_CASE("XXH128") {
+  XXH128 xxh128;
+
+  SECTION("string") {
+    const std::string str {"abcdef"};
+    const std::string expectedHex {"389197a55db2b2e4da35a6714d34f8a2"};
+    REQUIRE(xxh128.getHex(str) == expectedHex);
+    REQUIRE(xxh128(str) == makeDigest128(0x389197a55db2b2e4, 0xda35a6714d34f8a2));
+    REQUIRE(xxh128.getHex(std::string {"5\"&l&7s:|In`'#kZiXA@[ee^^(kZ]Qp@"})
+            == "bfe85b5668df85f540edbe6f9aab8e6d");
+  }
+
+  SECTION("lengths") {
+    // canonical values of XXH3_128bits() of the xxHash library
+    const std::vector<std::pair<std::size_t, std::string>> expected {
+      {0, "99aa06d3014798d86001c324468d497f"},
+      {1, "9a0f174ae92e6df2e5e62017e96f839c"},
+      {2, "13a82070861b3b8ce99f8ba75698ec0f"},
+      {3, "da47c2149249db69d3bcc83c6f14e70f"},
+      {4, "504303785d7b5ac9e267cf807951fe26"},
+      {5, "04211bd3bee518fd01829ab282a4a4e8"},
+      {8, "e4f1bc54c38ed231ec0b5b60d4670d0e"},
+      {9, "046e6473695659653b1764b161f03ecd"},
+      {16, "82d56864b86d46550c85c3b7b344cfaf"},
+      {17, "e07226299d418421ee80c12e2eaa110d"},
+      {32, "064ad1b44ce81ec6f852b8182febef65"},
+      {33, "79222b34b5dc6369b28082a9aad3b9d5"},
+      {64, "960fca3c66b39991f2a2091b45bbd9cf"},
+      {65, "4b9f9e58c4d9eeff841f3ad04f518ac7"},
+      {96, "1bf14e85181e761ee9b8a9102806d5c0"},
+      {97, "98434fe44be46805b0673de5ad089029"},
+      {128, "4a4e39fcfa4515aa08d61631b87e5395"},
+      {129, "5d41bb88ee7f7e4511b15591bb767e79"},
+      {160, "601f389dcff5cb81e72a6d6e8527b950"},
+      {200, "fbe7b91005c8f97b4a8a2a56bda735cd"},
+      {240, "f92b835add69c25d4627a2b0d94e7351"},
+      {241, "80610486edf872df5c56141c894cd97e"},
+      {255, "aac792b69b475a8da88268bb584966d3"},
+      {256, "242daf7771ae05e6cdb34974678d6687"},
+      {257, "b6ad0f63ee2254b8b5c3cd9c180a14b7"},
+      {511, "de99f1757e98f99629a124fe3138f1ee"},
+      {1024, "dcc4b2941cb5e5e40551dea22e104ea8"},
+      {1025, "2e457d89ed1973d3dbe2ed3c377d9922"},
+      {4999, "1a08cc975d1bb71f5d0dc4cd666a283c"},
+    };
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const auto& entry : expected) {
+      REQUIRE(xxh128.getHex(data.data(), entry.first) == entry.second);
+      REQUIRE(kernel::xxh128(data.data(), entry.first) == xxh128(data.data(), entry.first));
+    }
+  }
+
+  SECTION("stream") {
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    const auto stream = xxh128.createStream();
+    for (std::size_t position = 0; position < data.size(); position += 300) {
+      stream->update(data.data() + position, std::min<std::size_t>(300, data.size() - position));
+    }
+    REQUIRE(stream->finalize() == xxh128(data));
+    REQUIRE(stream->getHex() == "1a08cc975d1bb71f5d0dc4cd666a283c");
+  }
+
+  SECTION("file") {
+    REQUIRE(checksumFile(xxh128, "testfile.txt") == xxh128(MappedFile {"testfile.txt"}.data(), 96));
+  }
+}
+
+TEST_CASE("SHA256") {
+  SHA256 sha256;
+
+  SECTION("string") {
+    REQUIRE(sha256.getHex(std::string {}) ==
+            "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    REQUIRE(sha256.getHex(std::string {"abc"}) ==
+            "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    REQUIRE(sha256.getHex(std::string {"abcdef"}) ==
+            "bef57ec7f53a6d40beb640a780a639c83bc29ac8a9816f1fc6c5c6dcd93c4721");
+  }
+
+  SECTION("lengths") {
+    // values of hashlib.sha256() of Python, covering all padding cases
+    const std::vector<std::pair<std::size_t, std::string>> expected {
+      {0, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+      {1, "49994461d6b46390f014c8c5275a8591ef8764760afe2739cee23f6fbe285778"},
+      {55, "48cab344faa43822576f85e6fcd6fb28568b116a195a0c2325d380a274ac550a"},
+      {56, "351adbeea5fe581b009b5325e79324c388cce5db1e5c778b14fcc3daa481068a"},
+      {63, "da65329f4cc1b9deaba09a8a3c09957b5ab1ff5c692ad557921b362430ef4d4a"},
+      {64, "a17eb65f63398a17ca56f962a00ebc8306dc2c7fc0bb07c39840fd71b6f8e72e"},
+      {65, "a542d59d459e46ed567503aa8cc301d96ed922af7a49349c01f0f7e22fecd318"},
+      {119, "2dd0a848fc8c333d337b200d7e35bd8add0da86cb3792ef7eace11ba55cc0caf"},
+      {120, "45d05ea895c7b755c79084dba8f0f5ceb04cc7506c14446e415161808e244cab"},
+      {128, "5758fe3e49f86851c51c17d0c3c36e84843222327a720d01722763b8684cc575"},
+      {1000, "86feb6339f5ec6939cc9e488bad525b04f8f5d09ad32db431327077432051a09"},
+      {4999, "2ef83010355e4b5b506fa7b3d5317d18a2d2cdf24382d2366fc147a0508d7cf1"},
+    };
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const auto& entry : expected) {
+      REQUIRE(sha256.getHex(data.data(), entry.first) == entry.second);
+      REQUIRE(kernel::sha256(data.data(), entry.first) == sha256(data.data(), entry.first));
+    }
+  }
+
+  SECTION("stream") {
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const std::size_t chunk : {1, 55, 64, 65, 1000}) {
+      const auto stream = sha256.createStream();
+      for (std::size_t position = 0; position < data.size(); position += chunk) {
+        stream->update(data.data() + position, std::min(chunk, data.size() - position));
+      }
+      REQUIRE(stream->getHex() ==
+              "2ef83010355e4b5b506fa7b3d5317d18a2d2cdf24382d2366fc147a0508d7cf1");
+    }
+  }
+
+  SECTION("batch") {
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const std::size_t count : {0, 1, 7, 8, 9, 21, 100}) {
+      std::vector<const uint8_t*> inputs;
+      std::vector<std::size_t> lengths;
+      for (std::size_t i = 0; i < count; ++i) {
+        // mixed lengths, so lanes finish at different blocks
+        lengths.push_back((i * 379) % 1200);
+        inputs.push_back(data.data() + i * 13);
+      }
+      std::vector<Digest256> results(count);
+      sha256.computeBatch(inputs.data(), lengths.data(), count, results.data());
+      for (std::size_t i = 0; i < count; ++i) {
+        REQUIRE(results[i] == sha256(inputs[i], lengths[i]));
+      }
+    }
+    const std::vector<Digest256> strings {sha256.computeBatch({"", "abc", "abcdef"})};
+    REQUIRE(strings.size() == 3);
+    REQUIRE(strings[1] == sha256(std::string {"abc"}));
+    REQUIRE(strings[2] == sha256(std::string {"abcdef"}));
+  }
+
+  SECTION("file") {
+    REQUIRE(checksumFile(sha256, "testfile.txt") ==
+            sha256(MappedFile {"testfile.txt"}.data(), 96));
+  }
+}
+
+TEST_CASE("BLAKE3") {
+  BLAKE3 blake3;
+
+  SECTION("string") {
+    REQUIRE(blake3.getHex(std::string {}) ==
+            "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262");
+    REQUIRE(blake3.getHex(std::string {"abc"}) ==
+            "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85");
+    REQUIRE(blake3.getHex(std::string {"abcdef"}) ==
+            "b34b56076712fd7fb9c067245a6c85e16174b3ef2e35df7b56b7f164e5c36446");
+  }
+
+  SECTION("lengths") {
+    // values of the blake3 module of Python, covering block and chunk boundaries
+    const std::vector<std::pair<std::size_t, std::string>> expected {
+      {0, "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262"},
+      {1, "8200d362dc960e431f2a9e606984b5ff0314407399391ba50bf2d216f6e37915"},
+      {64, "fa0adfcb4700492e2ae713d195138011b4148c193eb1824076dbfbb1a70ed1db"},
+      {65, "9c3c0c0bb8abbf8d6b6c6e6abd9125db6e396a4793a8b4f083f1c2477960560d"},
+      {1023, "322e4a15b757bd247d092fab0b0d905df672c76fb90bd7d51428d962eac89c1c"},
+      {1024, "c35306fd76d4ab7e6d49f7595e823d2fd7736adbb066bdd5b231363202af15b9"},
+      {1025, "ed68084d3dbd33917d62342deaff764895db80189dbea0cfdbaddeb1bc0ff501"},
+      {2048, "69c20e36933220db9211580ad6b2ada6a323164d9120d4f30dfb2afd1fa1b29f"},
+      {2049, "2fa8ce685d73ae1d35f2727353a233df4d11d8f31a2ac093bb3af1b15f176748"},
+      {3072, "862fd6b0831dfbdfd40239f75dd47f4447fc6281a8a5631152e8c67816c5201a"},
+      {4999, "6297f69c573c4395f78f3c690f08eae09dcd9cfbad4e0c56b8d2e393b53a21ad"},
+    };
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const auto& entry : expected) {
+      REQUIRE(blake3.getHex(data.data(), entry.first) == entry.second);
+      REQUIRE(kernel::blake3(data.data(), entry.first) == blake3(data.data(), entry.first));
+    }
+  }
+
+  SECTION("threads") {
+    // several subtrees hashed on separate threads
+    const std::vector<uint8_t> data {makeData(5 * 1024 * 1024 + 123, 1)};
+    const std::string expected {"5d64b03ae960d2f52b6c06c8299c87d55254a98fdcfd0e59c3798326bf80f8ce"};
+    REQUIRE(BLAKE3 {1}.getHex(data) == expected);
+    REQUIRE(BLAKE3 {4}.getHex(data) == expected);
+    REQUIRE(blake3.getHex(data) == expected);
+  }
+
+  SECTION("stream") {
+    const std::vector<uint8_t> data {makeData(4999, 1)};
+    for (const std::size_t chunk : {1, 63, 64, 1024, 1025, 3000}) {
+      const auto stream = blake3.createStream();
+      for (std::size_t position = 0; position < data.size(); position += chunk) {
+        stream->update(data.data() + position, std::min(chunk, data.size() - position));
+      }
+      REQUIRE(stream->getHex() ==
+              "6297f69c573c4395f78f3c690f08eae09dcd9cfbad4e0c56b8d2e393b53a21ad");
+    }
+  }
+
+  SECTION("file") {
+    REQUIRE(checksumFile(blake3, "testfile.txt") ==
+            blake3(MappedFile {"testfile.txt"}.data(), 96));
+  }
+}
+
+TEST_CASE("Digest") {
+  const Digest128 first {makeDigest128(0x0001020304050607, 0x08090a0b0c0d0e0f)};
+  Digest128 second {first};
+  REQUIRE(first == second);
+  REQUIRE(util::toHexString(first) == "000102030405060708090a0b0c0d0e0f");
+
+  second.Bytes[15] = 0x10;
+  REQUIRE(first != second);
+  REQUIRE(first < second);
+  REQUIRE_FALSE(second < first);
+
+  const std::unordered_set<Digest128> keys {first, second, first};
+  REQUIRE(keys.size() == 2);
+}
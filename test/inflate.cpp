@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of compressed data verification
+ *
+ * Source file containing tests for the verification of gzip and zlib data
+ * of \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/inflate.h>
+
+#include <zlib.h>
+
+using namespace libchecksum;
+
+namespace {
+
+using Status = InflateResult::Status;
+
+/// \brief Compresses data with zlib.
+/// \param windowBits Window bits of deflateInit2, 31 for gzip and 15 for zlib
+/// \param level Compression level
+/// \param header Optional gzip header
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data, int windowBits, int level = 6,
+                              gz_header* header = nullptr) {
+  z_stream stream {};
+  REQUIRE(deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+  if (header != nullptr) {
+    REQUIRE(deflateSetHeader(&stream, header) == Z_OK);
+  }
+  std::vector<uint8_t> result(deflateBound(&stream, static_cast<uLong>(data.size())) + 64);
+  stream.next_in = const_cast<Bytef*>(data.data());
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = result.data();
+  stream.avail_out = static_cast<uInt>(result.size());
+  REQUIRE(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+  result.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result;
+}
+
+/// \brief Returns runs of random bytes, which compress a little, but not to
+/// nothing.
+std::vector<uint8_t> makeCompressibleData(std::size_t length, uint32_t seed) {
+  std::vector<uint8_t> data {makeData(length, seed)};
+  for (std::size_t i = 0; i < length; ++i) {
+    if (i % 64 >= 40) {
+      data[i] = static_cast<uint8_t>(i / 64);
+    }
+  }
+  return data;
+}
+
+InflateResult verify(const std::vector<uint8_t>& data, CompressedFormat format,
+                     unsigned threads = 0) {
+  InflateOptions options {};
+  options.Threads = threads;
+  return verifyCompressed(data.data(), data.size(), format, options);
+}
+
+} // namespace
+
+TEST_CASE("inflate") {
+  const std::vector<uint8_t> original {makeCompressibleData(300000, 1)};
+
+  SECTION("zlib") {
+    std::vector<uint8_t> compressed {compress(original, 15)};
+    InflateResult result {verify(compressed, CompressedFormat::Zlib)};
+    REQUIRE(result.State == Status::Ok);
+    REQUIRE(result.Members == 1);
+    REQUIRE(result.Length == original.size());
+    REQUIRE(result.Error.empty());
+
+    std::vector<uint8_t> output;
+    result = inflateVerified(compressed.data(), compressed.size(), CompressedFormat::Zlib,
+        [&](const uint8_t* data, std::size_t length) {
+          REQUIRE(length <= 1000);
+          output.insert(output.end(), data, data + length);
+        }, 1000);
+    REQUIRE(result.State == Status::Ok);
+    REQUIRE(output == original);
+
+    REQUIRE(verify(compressed, CompressedFormat::Gzip).State == Status::Corrupt);
+    REQUIRE(verify({}, CompressedFormat::Zlib).State == Status::Truncated);
+
+    compressed.back() ^= 1;
+    result = verify(compressed, CompressedFormat::Zlib);
+    REQUIRE(result.State == Status::Mismatch);
+    REQUIRE(result.Error == "Adler32 mismatch");
+    compressed.back() ^= 1;
+
+    compressed.push_back(0);
+    REQUIRE(verify(compressed, CompressedFormat::Zlib).State == Status::Corrupt);
+    compressed.resize(compressed.size() - 3);
+    REQUIRE(verify(compressed, CompressedFormat::Zlib).State == Status::Truncated);
+    compressed.resize(compressed.size() / 2);
+    result = verify(compressed, CompressedFormat::Zlib);
+    REQUIRE(result.State == Status::Truncated);
+    REQUIRE(result.Length < original.size());
+
+    compressed[0] = 0x79;
+    REQUIRE(verify(compressed, CompressedFormat::Zlib).State == Status::Corrupt);
+  }
+
+  SECTION("gzip members") {
+    // members of different sizes, an empty one, one with every optional
+    // header field and a stored one containing something that looks like a
+    // gzip header
+    std::vector<uint8_t> fake {makeCompressibleData(5000, 2)};
+    const uint8_t header[] = {0x1F, 0x8B, 0x08, 0x00, 0, 0, 0, 0, 0, 3};
+    std::copy(std::begin(header), std::end(header), fake.begin() + 1000);
+    char name[] = "name.txt";
+    char comment[] = "comment";
+    uint8_t extra[] = {'A', 'B', 2, 0, 'x', 'y'};
+    gz_header fields {};
+    fields.name = reinterpret_cast<Bytef*>(name);
+    fields.comment = reinterpret_cast<Bytef*>(comment);
+    fields.extra = extra;
+    fields.extra_len = sizeof(extra);
+    fields.hcrc = 1;
+    const std::vector<std::vector<uint8_t>> members {
+      compress(original, 31), compress({}, 31),
+      compress(makeCompressibleData(70000, 3), 31, 9, &fields), compress(fake, 31, 0),
+      compress(makeCompressibleData(1, 4), 31), compress(makeCompressibleData(100000, 5), 31, 1)
+    };
+    std::vector<uint8_t> compressed;
+    std::vector<std::size_t> offsets;
+    for (const auto& member : members) {
+      offsets.push_back(compressed.size());
+      compressed.insert(compressed.end(), member.begin(), member.end());
+    }
+    const uint64_t length {300000 + 70000 + 5000 + 1 + 100000};
+
+    for (const unsigned threads : {1u, 4u}) {
+      const InflateResult result {verify(compressed, CompressedFormat::Gzip, threads)};
+      REQUIRE(result.State == Status::Ok);
+      REQUIRE(result.Members == members.size());
+      REQUIRE(result.Length == length);
+    }
+
+    std::vector<uint8_t> output;
+    const InflateResult result {inflateVerified(compressed.data(), compressed.size(),
+        CompressedFormat::Gzip, [&](const uint8_t* data, std::size_t size) {
+          output.insert(output.end(), data, data + size);
+        })};
+    REQUIRE(result.State == Status::Ok);
+    REQUIRE(output.size() == length);
+    REQUIRE(std::equal(original.begin(), original.end(), output.begin()));
+
+    for (const unsigned threads : {1u, 4u}) {
+      // CRC32 of the third member
+      std::vector<uint8_t> corrupt {compressed};
+      corrupt[offsets[3] - 8] ^= 0x40;
+      InflateResult failed {verify(corrupt, CompressedFormat::Gzip, threads)};
+      REQUIRE(failed.State == Status::Mismatch);
+      REQUIRE(failed.Members == 2);
+      REQUIRE(failed.Error == "member at offset " + std::to_string(offsets[2]) + ": CRC32 mismatch");
+
+      // length of the first member
+      corrupt = compressed;
+      corrupt[offsets[1] - 1] ^= 1;
+      failed = verify(corrupt, CompressedFormat::Gzip, threads);
+      REQUIRE(failed.State == Status::Mismatch);
+      REQUIRE(failed.Members == 0);
+
+      // header CRC of the third member
+      corrupt = compressed;
+      corrupt[offsets[2] + 12] ^= 1;
+      REQUIRE(verify(corrupt, CompressedFormat::Gzip, threads).State == Status::Corrupt);
+
+      corrupt = compressed;
+      corrupt.resize(compressed.size() - 5);
+      failed = verify(corrupt, CompressedFormat::Gzip, threads);
+      REQUIRE(failed.State == Status::Truncated);
+      REQUIRE(failed.Members == members.size() - 1);
+
+      corrupt = compressed;
+      corrupt.push_back(0);
+      failed = verify(corrupt, CompressedFormat::Gzip, threads);
+      REQUIRE(failed.State == Status::Corrupt);
+      REQUIRE(failed.Members == members.size());
+    }
+  }
+
+  SECTION("gzip magic in stored blocks") {
+    // every 4 bytes of the stored member look like the start of a member
+    std::vector<uint8_t> magic(1 << 20);
+    for (std::size_t i = 0; i < magic.size(); i += 4) {
+      const uint8_t header[] {0x1F, 0x8B, 0x08, 0x00};
+      std::copy(header, header + 4, magic.begin() + static_cast<std::ptrdiff_t>(i));
+    }
+    std::vector<uint8_t> compressed {compress(magic, 31, 0)};
+    const std::vector<uint8_t> last {compress(magic, 31, 0)};
+    compressed.insert(compressed.end(), last.begin(), last.end());
+
+    for (const unsigned threads : {1u, 4u}) {
+      InflateResult result {verify(compressed, CompressedFormat::Gzip, threads)};
+      REQUIRE(result.State == Status::Ok);
+      REQUIRE(result.Members == 2);
+      REQUIRE(result.Length == 2 * magic.size());
+
+      compressed.push_back(0x1F);
+      result = verify(compressed, CompressedFormat::Gzip, threads);
+      REQUIRE(result.State == Status::Corrupt);
+      REQUIRE(result.Members == 2);
+      compressed.pop_back();
+    }
+  }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the instrumentation
+ *
+ * Source file containg tests for the instrumentation of \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/instrumentation.h>
+
+using namespace libchecksum;
+
+TEST_CASE("instrumentation") {
+  const std::vector<uint8_t> data(1000, 42);
+
+  if (!instrumentation::isAvailable()) {
+    instrumentation::enable(true);
+    REQUIRE_FALSE(instrumentation::isEnabled());
+    CRC32 {}(data);
+    REQUIRE(instrumentation::getSnapshot()[AlgorithmId::CRC32].Calls == 0);
+    return;
+  }
+
+  instrumentation::reset();
+  instrumentation::enable(true);
+  REQUIRE(instrumentation::isEnabled());
+  CRC32 {}(data);
+  CRC32 {}(data.data(), 10);
+  const auto stream = Adler32 {}.createStream();
+  stream->update(data);
+  instrumentation::enable(false);
+  CRC32 {}(data);
+
+  const auto snapshot = instrumentation::getSnapshot();
+  const auto& crc = snapshot[AlgorithmId::CRC32];
+  REQUIRE(crc.Calls == 2);
+  REQUIRE(crc.Bytes == 1010);
+  REQUIRE(crc.TierCalls[static_cast<std::size_t>(KernelTier::Scalar)] == 2);
+  uint64_t histogramCalls {0};
+  for (const auto bucket : crc.Latency) {
+    histogramCalls += bucket;
+  }
+  REQUIRE(histogramCalls == 2);
+  REQUIRE(snapshot[AlgorithmId::Adler32].Calls == 1);
+  REQUIRE(snapshot[AlgorithmId::Adler32].Bytes == 1000);
+  REQUIRE(snapshot[AlgorithmId::Cksum].Calls == 0);
+
+  instrumentation::reset();
+  REQUIRE(instrumentation::getSnapshot()[AlgorithmId::CRC32].Calls == 0);
+}
+
+TEST_CASE("algorithmNames") {
+  REQUIRE(std::string {getAlgorithmName(AlgorithmId::Adler32)} == "Adler32");
+  REQUIRE(std::string {getAlgorithmName(AlgorithmId::CRC32)} == "CRC32");
+  REQUIRE(std::string {getKernelTierName(KernelTier::AVX2)} == "AVX2");
+}
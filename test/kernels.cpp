@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the kernels and interfaces
+ *
+ * Source file containg tests for the header-only kernels, the static interface
+ * and the streams of \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+#include <libchecksum/kernels.h>
+
+using namespace libchecksum;
+
+// the kernels must be usable in constant expressions
+static_assert(kernel::crc32("abcdef", 6) == 0x4b8e39ef, "CRC32 is not constexpr");
+static_assert(kernel::cksum("abcdef", 6) == 0x2e152bb1, "Cksum is not constexpr");
+static_assert(kernel::fletcher16("abcdef", 6) == 0x2057, "Fletcher16 is not constexpr");
+static_assert(kernel::adler32("", 0) == 1, "Adler32 is not constexpr");
+static_assert(kernel::internetChecksum("\x00\x01\xf2\x03\xf4\xf5\xf6\xf7", 8) == 0x220d,
+              "Internet checksum is not constexpr");
+
+namespace {
+
+/// \brief Checks that a kernel agrees with the library class for all
+/// prefixes of a buffer and for incremental updates.
+template<typename State, typename Algorithm>
+void compareWithLibrary(const std::vector<uint8_t>& data) {
+  const Algorithm algorithm {};
+  for (std::size_t length = 0; length <= data.size(); length += 97) {
+    REQUIRE(kernel::compute<State>(data.data(), length) == algorithm(data.data(), length));
+  }
+
+  State state {};
+  std::size_t position {0};
+  for (std::size_t chunk = 1; position < data.size(); chunk = chunk * 3 + 1) {
+    const std::size_t length {std::min(chunk, data.size() - position)};
+    state.update(data.data() + position, length);
+    position += length;
+  }
+  REQUIRE(state.finalize() == algorithm(data));
+}
+
+} // namespace
+
+TEST_CASE("kernels") {
+  const std::vector<uint8_t> data {makeData(20000, 12345)};
+
+  compareWithLibrary<kernel::Adler32State, Adler32>(data);
+  compareWithLibrary<kernel::Fletcher16State, Fletcher16>(data);
+  compareWithLibrary<kernel::Fletcher32State, Fletcher32>(data);
+  compareWithLibrary<kernel::Sum8State, Sum8>(data);
+  compareWithLibrary<kernel::Sum16State, Sum16>(data);
+  compareWithLibrary<kernel::Sum32State, Sum32>(data);
+  compareWithLibrary<kernel::BSDSumState, BSDSum>(data);
+  compareWithLibrary<kernel::XOR8State, XOR8>(data);
+  compareWithLibrary<kernel::SYSVState, SYSV>(data);
+  compareWithLibrary<kernel::CksumState, Cksum>(data);
+  compareWithLibrary<kernel::CRC32State, CRC32>(data);
+  compareWithLibrary<kernel::CRC32CState, CRC32C>(data);
+  compareWithLibrary<kernel::CRC32BZIP2State, CRC32BZIP2>(data);
+  compareWithLibrary<kernel::InternetChecksumState, InternetChecksum>(data);
+  compareWithLibrary<kernel::XXH3State, XXH3>(data);
+  compareWithLibrary<kernel::XXH128State, XXH128>(data);
+  compareWithLibrary<kernel::SHA256State, SHA256>(data);
+  compareWithLibrary<kernel::BLAKE3State, BLAKE3>(data);
+
+  // the deferred reduction must not overflow on the largest byte values
+  const std::vector<uint8_t> ones(3 * kernel::MaxDeferredBytes + 1, 0xFF);
+  REQUIRE(kernel::adler32(ones.data(), ones.size()) == 0xfd50d3b0);
+  REQUIRE(kernel::fletcher32(ones.data(), ones.size()) == 0x639cd02f);
+}
+
+namespace {
+
+/// \brief Checks that combining the states of two parts of a buffer gives
+/// the state of the whole buffer, and that splitting a large buffer across
+/// threads gives the checksum of a single pass.
+template<typename State, typename Algorithm>
+void checkCombine(const std::vector<uint8_t>& data, const std::vector<uint8_t>& large) {
+  for (std::size_t split = 0; split <= data.size(); split += 997) {
+    State first {}, second {};
+    first.update(data.data(), split);
+    second.update(data.data() + split, data.size() - split);
+    first.combine(second, data.size() - split);
+    REQUIRE(first.finalize() == kernel::compute<State>(data.data(), data.size()));
+  }
+  for (const unsigned threads : {0u, 2u, 3u, 7u}) {
+    REQUIRE(Algorithm {threads}(large) == kernel::compute<State>(large.data(), large.size()));
+  }
+}
+
+} // namespace
+
+TEST_CASE("combine") {
+  std::vector<uint8_t> data {makeData(10000, 54321)};
+  data.resize(20000, 0xFF);
+  const std::vector<uint8_t> large {makeData((5 << 20) + 123, 4321)};
+
+  checkCombine<kernel::Adler32State, Adler32>(data, large);
+  checkCombine<kernel::Fletcher16State, Fletcher16>(data, large);
+  checkCombine<kernel::Fletcher32State, Fletcher32>(data, large);
+  checkCombine<kernel::Sum8State, Sum8>(data, large);
+  checkCombine<kernel::Sum16State, Sum16>(data, large);
+  checkCombine<kernel::Sum32State, Sum32>(data, large);
+  checkCombine<kernel::XOR8State, XOR8>(data, large);
+  checkCombine<kernel::SYSVState, SYSV>(data, large);
+}
+
+namespace {
+
+/// \brief Checks that sliding a window over the data gives the checksums of
+/// the windows.
+template<typename State>
+void checkRoll(const std::vector<uint8_t>& data, std::size_t window) {
+  State state {};
+  state.update(data.data(), window);
+  for (std::size_t start = 1; start + window <= data.size(); ++start) {
+    state.roll(data[start - 1], data[start + window - 1], window);
+    REQUIRE(state.finalize() == kernel::compute<State>(data.data() + start, window));
+  }
+}
+
+} // namespace
+
+TEST_CASE("roll") {
+  std::vector<uint8_t> data {makeData(1500, 12345)};
+  data.resize(3000, 0xFF);
+
+  for (const std::size_t window : {1u, 16u, 255u, 1024u}) {
+    checkRoll<kernel::Adler32State>(data, window);
+    checkRoll<kernel::Fletcher16State>(data, window);
+    checkRoll<kernel::Fletcher32State>(data, window);
+    checkRoll<kernel::Sum8State>(data, window);
+    checkRoll<kernel::Sum16State>(data, window);
+    checkRoll<kernel::Sum32State>(data, window);
+    checkRoll<kernel::XOR8State>(data, window);
+    checkRoll<kernel::SYSVState>(data, window);
+  }
+}
+
+namespace {
+
+/// Generic code using the static interface of an algorithm
+template<typename Algorithm>
+typename Algorithm::State::ResultType staticChecksum(const std::string& input) {
+  static_assert(IsStaticChecksumAlgorithm<Algorithm>::value, "Not a static algorithm");
+  auto state = Algorithm::createState();
+  state.update(input.data(), input.size());
+  REQUIRE(state.finalize() == Algorithm::compute(input));
+  return state.finalize();
+}
+
+/// \brief Checks that streams give the same results as the one-shot
+/// interface, no matter how the input is split.
+template<typename T>
+void checkStream(const ChecksumAlgorithm<T>& algorithm, const std::string& input) {
+  const auto stream = algorithm.createStream();
+  REQUIRE(stream->finalize() == algorithm(""));
+  for (std::size_t split = 0; split <= input.size(); ++split) {
+    stream->reset();
+    stream->update(input.substr(0, split));
+    stream->update(input.substr(split));
+    REQUIRE(stream->finalize() == algorithm(input));
+    REQUIRE(stream->getHex() == algorithm.getHex(input));
+  }
+}
+
+} // namespace
+
+static_assert(!IsStaticChecksumAlgorithm<ChecksumAlgorithm<uint32_t>>::value,
+              "The virtual base must not model the static interface");
+
+TEST_CASE("staticInterface") {
+  const std::string input {"5\"&l&7s:|In`'#kZiXA@[ee^^(kZ]Qp@"};
+  REQUIRE(staticChecksum<Adler32>(input) == 2612464132);
+  REQUIRE(staticChecksum<Fletcher16>(input) == Fletcher16 {}(input));
+  REQUIRE(staticChecksum<Fletcher32>(input) == Fletcher32 {}(input));
+  REQUIRE(staticChecksum<Sum8>(input) == Sum8 {}(input));
+  REQUIRE(staticChecksum<Sum16>(input) == Sum16 {}(input));
+  REQUIRE(staticChecksum<Sum32>(input) == Sum32 {}(input));
+  REQUIRE(staticChecksum<BSDSum>(input) == BSDSum {}(input));
+  REQUIRE(staticChecksum<XOR8>(input) == XOR8 {}(input));
+  REQUIRE(staticChecksum<SYSV>(input) == SYSV {}(input));
+  REQUIRE(staticChecksum<Cksum>(input) == 1503098415);
+  REQUIRE(staticChecksum<CRC32>(input) == 558027374);
+  REQUIRE(staticChecksum<CRC32C>(input) == 2479759992);
+  REQUIRE(staticChecksum<CRC32BZIP2>(input) == 1720239050);
+  REQUIRE(staticChecksum<InternetChecksum>(input) == 35687);
+  REQUIRE(staticChecksum<XXH3>(input) == 4075527671367982051);
+  REQUIRE(staticChecksum<SHA256>(input) == SHA256 {}(input));
+  REQUIRE(staticChecksum<BLAKE3>(input) == BLAKE3 {}(input));
+}
+
+TEST_CASE("streams") {
+  const std::string input {"qRbgfzdgDgkqF_-lC9TXl"};
+  checkStream(Adler32 {}, input);
+  checkStream(Fletcher16 {}, input);
+  checkStream(Fletcher32 {}, input);
+  checkStream(Sum8 {}, input);
+  checkStream(Sum16 {}, input);
+  checkStream(Sum32 {}, input);
+  checkStream(BSDSum {}, input);
+  checkStream(XOR8 {}, input);
+  checkStream(SYSV {}, input);
+  checkStream(Cksum {}, input);
+  checkStream(CRC32 {}, input);
+  checkStream(CRC32C {}, input);
+  checkStream(CRC32BZIP2 {}, input);
+  checkStream(InternetChecksum {}, input);
+  checkStream(XXH3 {}, input);
+  checkStream(XXH128 {}, input);
+  checkStream(SHA256 {}, input);
+  checkStream(BLAKE3 {}, input);
+}
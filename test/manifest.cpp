@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the manifest verification
+ *
+ * Source file containg tests for the manifest verification in \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+#include <libchecksum/manifest.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+using namespace libchecksum;
+
+TEST_CASE("parseManifest") {
+  const std::string manifest {
+    "7bbb4281  testfile.txt\n"
+    "\n"
+    "00ABCDEF *name with  spaces\r\n"
+    "not a checksum line\n"
+    "1234 missing-second-space\n"
+    "ffff  last"
+  };
+  std::size_t malformed {0};
+  const auto entries = parseManifest(reinterpret_cast<const uint8_t*>(manifest.data()),
+                                     manifest.size(), malformed);
+  REQUIRE(malformed == 2);
+  REQUIRE(entries.size() == 3);
+  REQUIRE(entries[0].Checksum == "7bbb4281");
+  REQUIRE(entries[0].Path == "testfile.txt");
+  REQUIRE(entries[0].Line == 1);
+  REQUIRE(entries[1].Checksum == "00ABCDEF");
+  REQUIRE(entries[1].Path == "name with  spaces");
+  REQUIRE(entries[1].Line == 3);
+  REQUIRE(entries[2].Path == "last");
+  REQUIRE(entries[2].Line == 6);
+}
+
+TEST_CASE("verifyManifest") {
+  {
+    std::ofstream manifest {"manifest.txt"};
+    manifest << "7BBB4281  testfile.txt\n"
+             << "7bbb4281 *testfile.txt\n"
+             << "07bbb4281  testfile.txt\n"
+             << "12345678  testfile.txt\n"
+             << "12345678  does-not-exist.txt\n"
+             << "garbage\n";
+  }
+
+  for (const bool ordered : {true, false}) {
+    ManifestOptions options;
+    options.OrderByLocation = ordered;
+    options.Threads = 3;
+    // the callback runs on worker threads, so only collect results there
+    std::vector<std::size_t> mismatches, unreadable;
+    std::string actual, error;
+    const auto summary = verifyManifest(CRC32 {}, "manifest.txt", [&](const ManifestResult& result) {
+      if (result.State == ManifestResult::Status::Mismatch) {
+        mismatches.push_back(result.Entry.Line);
+        actual = result.Actual;
+      } else if (result.State == ManifestResult::Status::Unreadable) {
+        unreadable.push_back(result.Entry.Line);
+        error = result.Error;
+      }
+    }, options);
+
+    REQUIRE(summary.Entries == 5);
+    REQUIRE(summary.Matched == 2);
+    REQUIRE(summary.Mismatched == 2);
+    REQUIRE(summary.Unreadable == 1);
+    REQUIRE(summary.Malformed == 1);
+    std::sort(mismatches.begin(), mismatches.end());
+    REQUIRE(mismatches == (std::vector<std::size_t> {3, 4}));
+    REQUIRE(unreadable == std::vector<std::size_t> {5});
+    REQUIRE(actual == "7bbb4281");
+    REQUIRE_FALSE(error.empty());
+  }
+  std::remove("manifest.txt");
+
+  REQUIRE_THROWS_AS(verifyManifest(CRC32 {}, "does-not-exist.txt", nullptr), std::system_error);
+}
+
+TEST_CASE("verifyManifest of fixed-width digests") {
+  std::string hex {SHA256 {}.getHex(MappedFile {"testfile.txt"}.data(), 96)};
+  std::transform(hex.begin(), hex.end(), hex.begin(), ::toupper);
+  {
+    // digests must have all of their digits, unlike integral checksums
+    std::ofstream manifest {"manifest.txt"};
+    manifest << hex << "  testfile.txt\n"
+             << hex.substr(1) << "  testfile.txt\n"
+             << "0" << hex << "  testfile.txt\n"
+             << "0  testfile.txt\n";
+  }
+  std::vector<std::size_t> mismatches;
+  ManifestOptions options;
+  options.Threads = 1;
+  const auto summary = verifyManifest(SHA256 {}, "manifest.txt", [&](const ManifestResult& result) {
+    if (result.State == ManifestResult::Status::Mismatch) {
+      mismatches.push_back(result.Entry.Line);
+    }
+  }, options);
+  std::remove("manifest.txt");
+  std::sort(mismatches.begin(), mismatches.end());
+  REQUIRE(summary.Matched == 1);
+  REQUIRE(mismatches == (std::vector<std::size_t> {2, 3, 4}));
+}
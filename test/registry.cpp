@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the algorithm registry
+ *
+ * Source file containing tests for the algorithm registry of \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/instrumentation.h>
+#include <libchecksum/registry.h>
+
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace libchecksum;
+
+TEST_CASE("registry") {
+  const auto& algorithms = registry::getAlgorithms();
+  REQUIRE(algorithms.size() == AlgorithmCount);
+
+  SECTION("names") {
+    for (std::size_t i = 0; i < AlgorithmCount; ++i) {
+      const auto id = static_cast<AlgorithmId>(i);
+      REQUIRE(algorithms[i].Id == id);
+      REQUIRE(&registry::getInfo(id) == &algorithms[i]);
+      REQUIRE(registry::find(getAlgorithmName(id)) == &algorithms[i]);
+      REQUIRE(registry::find(algorithms[i].Name) == &algorithms[i]);
+    }
+    REQUIRE(registry::find("CRC-32C")->Id == AlgorithmId::CRC32C);
+    REQUIRE(registry::find("crc32_bzip2")->Id == AlgorithmId::CRC32BZIP2);
+    REQUIRE(registry::find("bsd")->Id == AlgorithmId::BSDSum);
+    REQUIRE(registry::find("internet")->Id == AlgorithmId::InternetChecksum);
+    REQUIRE(registry::find("crc64") == nullptr);
+    REQUIRE(registry::find("") == nullptr);
+    REQUIRE_THROWS_AS(registry::create("crc64"), std::invalid_argument);
+  }
+
+  SECTION("capabilities") {
+    const auto& adler = registry::getInfo(AlgorithmId::Adler32);
+    REQUIRE(adler.OutputBits == 32);
+    REQUIRE(adler.Combinable);
+    REQUIRE(adler.Parallel);
+    REQUIRE(adler.Rolling);
+    const auto& crc = registry::getInfo(AlgorithmId::CRC32);
+    REQUIRE(crc.OutputBits == 32);
+    REQUIRE_FALSE(crc.Combinable);
+    REQUIRE_FALSE(crc.Parallel);
+    REQUIRE_FALSE(crc.Rolling);
+    const auto& blake = registry::getInfo(AlgorithmId::BLAKE3);
+    REQUIRE(blake.OutputBits == 256);
+    REQUIRE_FALSE(blake.Combinable);
+    REQUIRE(blake.Parallel);
+    REQUIRE(registry::getInfo(AlgorithmId::Sum8).OutputBits == 8);
+    REQUIRE(registry::getInfo(AlgorithmId::Fletcher16).OutputBits == 16);
+    REQUIRE(registry::getInfo(AlgorithmId::XXH3).OutputBits == 64);
+    REQUIRE(registry::getInfo(AlgorithmId::XXH128).OutputBits == 128);
+    for (const auto& info : algorithms) {
+      REQUIRE(info.Streamable);
+      // parts of combinable checksums can be calculated by several threads
+      REQUIRE((!info.Combinable || info.Parallel));
+    }
+  }
+
+  SECTION("instances") {
+    const std::vector<uint8_t> data {makeData((3 << 20) + 17, 4711)};
+    const std::string input {"The quick brown fox jumps over the lazy dog"};
+
+    for (const auto& info : algorithms) {
+      const auto algorithm = registry::create(info.Name);
+      REQUIRE(&algorithm->getInfo() == &info);
+      const std::string expected {registry::visit(info.Id, [&](const auto& typed) {
+        return typed.getHex(input);
+      })};
+      REQUIRE(algorithm->getHex(input) == expected);
+
+      const auto stream = algorithm->createStream();
+      stream->update(input.substr(0, 10));
+      stream->update(input.substr(10));
+      REQUIRE(stream->getHex() == expected);
+      stream->reset();
+      REQUIRE(stream->getHex() == algorithm->getHex(""));
+
+      const std::string large {algorithm->getHex(data.data(), data.size())};
+      REQUIRE(registry::create(info.Name, 3)->getHex(data.data(), data.size()) == large);
+      REQUIRE(registry::visit(info.Id, 3, [&](const auto& typed) {
+        return typed.getHex(data.data(), data.size());
+      }) == large);
+    }
+  }
+
+  SECTION("tiers") {
+    const char* disabled {std::getenv("LIBCHECKSUM_DISABLE_CPU_FEATURES")};
+    if (disabled != nullptr && std::string {disabled} == "all") {
+      for (const auto& info : algorithms) {
+        REQUIRE((info.Tier == KernelTier::Scalar || info.Tier == KernelTier::SSE));
+      }
+    }
+    if (!instrumentation::isAvailable()) {
+      return;
+    }
+
+    // the tier of the registry is the one the kernels record for large inputs
+    const std::vector<uint8_t> data(1 << 16, 42);
+    instrumentation::reset();
+    instrumentation::enable(true);
+    for (const auto& info : algorithms) {
+      registry::create(info.Name)->getHex(data.data(), data.size());
+    }
+    instrumentation::enable(false);
+    const auto snapshot = instrumentation::getSnapshot();
+    for (const auto& info : algorithms) {
+      REQUIRE(snapshot[info.Id].TierCalls[static_cast<std::size_t>(info.Tier)] == 1);
+    }
+    instrumentation::reset();
+  }
+}
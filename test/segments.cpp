@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Test source file for tests of the non-contiguous inputs
+ *
+ * Source file containing tests for the scatter-gather and strided input
+ * functions in \p libchecksum.
+ */
+
+#include "catch.hpp"
+#include "testdata.h"
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/hash.h>
+#include <libchecksum/segments.h>
+
+using namespace libchecksum;
+
+namespace {
+
+/// \brief Checks that scattered segments and padded rows give the checksum
+/// of the contiguous data.
+template<typename Algorithm>
+void checkSegments(const std::vector<uint8_t>& data) {
+  const Algorithm algorithm {};
+
+  // split the data into segments of growing length, some of them empty,
+  // and place every segment behind a gap in a separate buffer
+  std::vector<uint8_t> scattered(2 * data.size());
+  std::vector<iovec> segments;
+  std::size_t position {0}, offset {0};
+  for (std::size_t length = 0; position < data.size(); length = length * 2 + 1) {
+    const std::size_t segment {std::min(length % 1000, data.size() - position)};
+    std::copy(data.begin() + position, data.begin() + position + segment,
+              scattered.begin() + offset);
+    segments.push_back({scattered.data() + offset, segment});
+    position += segment;
+    offset += segment + length % 3;
+  }
+  REQUIRE(checksumSegments(algorithm, segments.data(), segments.size()) == algorithm(data));
+  REQUIRE(checksumSegments(algorithm, segments.data(), 0) == algorithm(""));
+
+  // adjacent segments are a single contiguous run
+  const iovec halves[] {{const_cast<uint8_t*>(data.data()), data.size() / 2},
+                        {const_cast<uint8_t*>(data.data()) + data.size() / 2,
+                         data.size() - data.size() / 2}};
+  REQUIRE(checksumSegments(algorithm, halves, 2) == algorithm(data));
+
+  // rows of 37 bytes, padded to a pitch of 64 bytes with garbage
+  constexpr std::size_t rowLength {37}, pitch {64};
+  const std::size_t rows {data.size() / rowLength};
+  std::vector<uint8_t> frame(rows * pitch, 0xA5);
+  for (std::size_t row = 0; row < rows; ++row) {
+    std::copy(data.begin() + row * rowLength, data.begin() + (row + 1) * rowLength,
+              frame.begin() + row * pitch);
+  }
+  const uint8_t* packed {data.data()};
+  REQUIRE(checksumStrided(algorithm, {frame.data(), rowLength, pitch, rows})
+          == algorithm(packed, rows * rowLength));
+  REQUIRE(checksumStrided(algorithm, {frame.data(), rowLength, pitch, 1})
+          == algorithm(packed, rowLength));
+  REQUIRE(checksumStrided(algorithm, {packed, rowLength, rowLength, rows})
+          == algorithm(packed, rows * rowLength));
+}
+
+} // namespace
+
+TEST_CASE("segments") {
+  const std::vector<uint8_t> data {makeData(10000, 4711)};
+
+  checkSegments<Adler32>(data);
+  checkSegments<Fletcher16>(data);
+  checkSegments<Sum32>(data);
+  checkSegments<BSDSum>(data);
+  checkSegments<SYSV>(data);
+  checkSegments<CRC32>(data);
+  checkSegments<CRC32C>(data);
+  checkSegments<InternetChecksum>(data);
+  checkSegments<XXH3>(data);
+  checkSegments<SHA256>(data);
+  checkSegments<BLAKE3>(data);
+}
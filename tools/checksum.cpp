@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2018 Kevin Kirchner
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @author      Kevin Kirchner
+ * @date        2018
+ * @copyright   MIT License
+ * @brief       Command line tool for \p libchecksum
+ *
+ * A command line tool printing checksums of files in the formats of GNU
+ * \p cksum, BSD \p sum and SYSV \p sum. Files are processed in parallel, but
+ * the output is always printed in the order of the arguments.
+ */
+
+#include <libchecksum/checksums.h>
+#include <libchecksum/crc.h>
+#include <libchecksum/file.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cinttypes>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <system_error>
+#include <thread>
+
+#include <getopt.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace libchecksum;
+
+namespace {
+
+/// Output formats supported by the tool
+enum class Format {
+  Cksum,
+  BSD,
+  SYSV
+};
+
+/// Result of processing a single file
+struct Result {
+  bool Ready {false};
+  bool Ok {false};
+  std::string Output {};
+  std::string Error {};
+};
+
+/// \brief Calls \p work for every index in [0, count) on up to \p jobs threads
+/// and passes the results to \p emit in index order. \p work must not throw.
+void runParallel(std::size_t count, unsigned jobs,
+                 const std::function<void(std::size_t, Result&)>& work,
+                 const std::function<void(const Result&)>& emit) {
+  std::vector<Result> results(count);
+  std::atomic<std::size_t> next {0};
+  std::mutex mutex;
+  std::condition_variable ready;
+
+  auto worker = [&]() {
+    for (std::size_t index = next++; index < count; index = next++) {
+      Result result;
+      work(index, result);
+      std::lock_guard<std::mutex> lock {mutex};
+      results[index] = std::move(result);
+      results[index].Ready = true;
+      ready.notify_all();
+    }
+  };
+
+  const auto threadCount = std::min<std::size_t>(std::max(jobs, 1u), count);
+  std::vector<std::thread> threads;
+  if (threadCount > 1) {
+    // the calling thread only emits, so all threadCount workers compute
+    for (std::size_t i = 0; i < threadCount; ++i) {
+      threads.emplace_back(worker);
+    }
+    for (std::size_t index = 0; index < count; ++index) {
+      std::unique_lock<std::mutex> lock {mutex};
+      ready.wait(lock, [&]() { return results[index].Ready; });
+      const Result result {std::move(results[index])};
+      lock.unlock();
+      emit(result);
+    }
+  } else {
+    worker();
+    for (const auto& result : results) {
+      emit(result);
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+/// \brief Returns the size in units of \p blockSize, rounded up.
+uintmax_t blocks(std::size_t size, std::size_t blockSize) {
+  return (size + blockSize - 1) / blockSize;
+}
+
+/// Checksum and size of a file as printed by the tool
+struct Fields {
+  uint32_t Sum;
+  uintmax_t Size;
+};
+
+/// \brief Calculates the checksum and size fields of a file.
+/// \param format Output format
+/// \param file Contents of the file
+Fields computeFields(Format format, const MappedFile& file) {
+  switch (format) {
+    case Format::BSD:
+      return {BSDSum {}(file.data(), file.size()), blocks(file.size(), 1024)};
+    case Format::SYSV:
+      return {SYSV {}(file.data(), file.size()), blocks(file.size(), 512)};
+    case Format::Cksum:
+      break;
+  }
+  return {Cksum {}(file.data(), file.size()), file.size()};
+}
+
+/// \brief Calculates the checksum and size fields of a file descriptor that
+/// is read in blocks.
+template<typename Algorithm>
+Fields readFields(int fd, std::size_t blockSize) {
+  BlockReader reader {};
+  const auto stream = Algorithm {}.createStream();
+  const std::size_t size {reader.read(fd, *stream)};
+  return {stream->finalize(), blocks(size, blockSize)};
+}
+
+/// \brief Calculates the checksum and size fields of a file that cannot be
+/// mapped, like a pipe, in constant memory.
+/// \param format Output format
+/// \param fd Open file descriptor
+Fields computeFields(Format format, int fd) {
+  switch (format) {
+    case Format::BSD:
+      return readFields<BSDSum>(fd, 1024);
+    case Format::SYSV:
+      return readFields<SYSV>(fd, 512);
+    case Format::Cksum:
+      break;
+  }
+  return readFields<Cksum>(fd, 1);
+}
+
+/// \brief Calculates the fields of a file argument, treating "-" as
+/// standard input.
+Fields computeInputFields(Format format, const std::string& name) {
+  if (name != "-") {
+    return computeFields(format, MappedFile {name});
+  }
+  struct stat info {};
+  if (::fstat(STDIN_FILENO, &info) == 0 && S_ISREG(info.st_mode)) {
+    return computeFields(format, MappedFile {STDIN_FILENO});
+  }
+  return computeFields(format, STDIN_FILENO);
+}
+
+/// \brief Formats the checksum line of a file.
+/// \param format Output format
+/// \param fields Checksum and size of the file
+/// \param name Name to print, empty for none
+std::string formatLine(Format format, const Fields& fields, const std::string& name) {
+  char line[64];
+  std::snprintf(line, sizeof(line), format == Format::BSD ? "%05u %5ju" : "%u %ju",
+                static_cast<unsigned>(fields.Sum), fields.Size);
+  return name.empty() ? std::string {line} : std::string {line} + " " + name;
+}
+
+/// \brief Prints the checksums of all files.
+bool printChecksums(Format format, const std::vector<std::string>& files,
+                    bool implicitStdin, unsigned jobs) {
+  bool ok {true};
+  runParallel(files.size(), jobs, [&](std::size_t index, Result& result) {
+    const std::string& name = files[index];
+    try {
+      result.Output = formatLine(format, computeInputFields(format, name),
+                                 implicitStdin ? "" : name);
+      result.Ok = true;
+    } catch (const std::system_error& error) {
+      result.Error = name + ": " + error.code().message();
+    } catch (const std::exception& error) {
+      result.Error = name + ": " + error.what();
+    }
+  }, [&](const Result& result) {
+    if (result.Ok) {
+      std::cout << result.Output << '\n';
+    } else {
+      std::cerr << "checksum: " << result.Error << '\n';
+      ok = false;
+    }
+  });
+  return ok;
+}
+
+/// Entry of a checksum manifest
+struct ManifestEntry {
+  Fields Expected;
+  std::string Name;
+};
+
+/// \brief Parses a manifest line of the form "checksum size name".
+/// \return True if the line has the expected format
+bool parseLine(const std::string& line, ManifestEntry& entry) {
+  const char* position = line.c_str();
+  uintmax_t values[2];
+  for (auto& value : values) {
+    while (*position == ' ') {
+      ++position;
+    }
+    if (*position < '0' || *position > '9') {
+      return false;
+    }
+    char* end;
+    errno = 0;
+    value = std::strtoumax(position, &end, 10);
+    if (errno != 0 || *end != ' ') {
+      return false;
+    }
+    position = end;
+  }
+  if (values[0] > UINT32_MAX || *++position == '\0') {
+    return false;
+  }
+  entry.Expected = {static_cast<uint32_t>(values[0]), values[1]};
+  entry.Name = position;
+  return true;
+}
+
+/// \brief Verifies the checksums listed in the given manifests.
+bool checkManifests(Format format, const std::vector<std::string>& manifests,
+                    unsigned jobs) {
+  std::vector<ManifestEntry> entries;
+  std::size_t malformed {0};
+  bool ok {true};
+  for (const auto& manifest : manifests) {
+    std::ifstream fileStream;
+    if (manifest != "-") {
+      fileStream.open(manifest);
+      if (!fileStream) {
+        std::cerr << "checksum: " << manifest << ": "
+                  << std::generic_category().message(errno) << '\n';
+        ok = false;
+        continue;
+      }
+    }
+    std::istream& input = manifest == "-" ? std::cin : fileStream;
+    std::string line;
+    while (std::getline(input, line)) {
+      ManifestEntry entry {};
+      if (parseLine(line, entry)) {
+        entries.push_back(std::move(entry));
+      } else if (!line.empty()) {
+        ++malformed;
+      }
+    }
+  }
+
+  std::size_t failed {0};
+  runParallel(entries.size(), jobs, [&](std::size_t index, Result& result) {
+    const ManifestEntry& entry = entries[index];
+    try {
+      const Fields actual = computeFields(format, MappedFile {entry.Name});
+      result.Ok = actual.Sum == entry.Expected.Sum
+                  && actual.Size == entry.Expected.Size;
+      result.Output = entry.Name + (result.Ok ? ": OK" : ": FAILED");
+    } catch (const std::system_error& error) {
+      result.Error = entry.Name + ": " + error.code().message();
+      result.Output = entry.Name + ": FAILED open or read";
+    } catch (const std::exception& error) {
+      result.Error = entry.Name + ": " + error.what();
+      result.Output = entry.Name + ": FAILED open or read";
+    }
+  }, [&](const Result& result) {
+    if (!result.Error.empty()) {
+      std::cerr << "checksum: " << result.Error << '\n';
+    }
+    std::cout << result.Output << '\n';
+    if (!result.Ok) {
+      ++failed;
+    }
+  });
+
+  if (malformed != 0) {
+    std::cerr << "checksum: WARNING: " << malformed
+              << " line(s) are improperly formatted\n";
+  }
+  if (failed != 0) {
+    std::cerr << "checksum: WARNING: " << failed << " of " << entries.size()
+              << " computed checksum(s) did NOT match\n";
+  }
+  return ok && failed == 0 && malformed == 0;
+}
+
+void printUsage() {
+  std::cout <<
+    "Usage: checksum [OPTION]... [FILE]...\n"
+    "Print the checksum and size of each FILE. With no FILE, or when FILE\n"
+    "is -, read standard input.\n"
+    "\n"
+    "  -a, --algorithm=NAME  output format: cksum (default), bsd or sysv\n"
+    "  -r                    use the BSD sum format, same as -a bsd\n"
+    "  -s, --sysv            use the SYSV sum format, same as -a sysv\n"
+    "  -c, --check           read checksums from the FILEs and verify them\n"
+    "  -j, --jobs=N          process up to N files in parallel\n"
+    "  -h, --help            display this help and exit\n"
+    "      --version         output version information and exit\n";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  Format format {Format::Cksum};
+  bool check {false};
+  unsigned jobs {std::max(std::thread::hardware_concurrency(), 1u)};
+
+  const option options[] = {
+    {"algorithm", required_argument, nullptr, 'a'},
+    {"sysv", no_argument, nullptr, 's'},
+    {"check", no_argument, nullptr, 'c'},
+    {"jobs", required_argument, nullptr, 'j'},
+    {"help", no_argument, nullptr, 'h'},
+    {"version", no_argument, nullptr, 'V'},
+    {nullptr, 0, nullptr, 0}
+  };
+
+  int option;
+  while ((option = getopt_long(argc, argv, "a:rscj:h", options, nullptr)) != -1) {
+    switch (option) {
+      case 'a': {
+        const std::string name {optarg};
+        if (name == "cksum") {
+          format = Format::Cksum;
+        } else if (name == "bsd") {
+          format = Format::BSD;
+        } else if (name == "sysv") {
+          format = Format::SYSV;
+        } else {
+          std::cerr << "checksum: unknown algorithm '" << name << "'\n";
+          return EXIT_FAILURE;
+        }
+        break;
+      }
+      case 'r':
+        format = Format::BSD;
+        break;
+      case 's':
+        format = Format::SYSV;
+        break;
+      case 'c':
+        check = true;
+        break;
+      case 'j': {
+        char* end;
+        errno = 0;
+        const long value = std::strtol(optarg, &end, 10);
+        if (end == optarg || *end != '\0' || errno != 0 || value < 1 || value > UINT_MAX) {
+          std::cerr << "checksum: invalid number of jobs '" << optarg << "'\n";
+          return EXIT_FAILURE;
+        }
+        jobs = static_cast<unsigned>(value);
+        break;
+      }
+      case 'h':
+        printUsage();
+        return EXIT_SUCCESS;
+      case 'V':
+        std::cout << "checksum (libchecksum) " << getVersionString() << '\n';
+        return EXIT_SUCCESS;
+      default:
+        std::cerr << "Try 'checksum --help' for more information.\n";
+        return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<std::string> files {argv + optind, argv + argc};
+  const bool implicitStdin {files.empty()};
+  if (implicitStdin) {
+    files.emplace_back("-");
+  }
+  if (!check) {
+    // the entries of manifests are only known while checking them, where
+    // runParallel() caps the threads at their number
+    jobs = static_cast<unsigned>(std::min<std::size_t>(jobs, files.size()));
+  }
+
+  const bool ok = check ? checkManifests(format, files, jobs)
+                        : printChecksums(format, files, implicitStdin, jobs);
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}